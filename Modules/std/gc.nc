@@ -8,5 +8,30 @@ class NamespaceGC
 
 	double	MarkTime();
 	double	CollectTime();
+
+	// Memory reserved by heap pages and large blocks and the fraction of it that is not used by live objects
+	int		ReservedMemory();
+	double	HeapFragmentation();
+
+	// Per size class statistics, index is in [0, SizeClassCount())
+	int		SizeClassCount();
+	int		SizeClassSize(int index);
+	int		SizeClassUsedMemory(int index);
+	int		SizeClassReservedMemory(int index);
+
+	// Heap profiling records the allocation site and type of every object, live memory is updated by each collection
+	void	SetHeapProfiling(bool enabled);
+	char[]	HeapProfileBySite();
+	char[]	HeapProfileByType();
+
+	// Deferred finalization only queues finalizers during collection, RunFinalizers runs up to maxCount of them (all if maxCount is negative) and returns how many were run
+	void	SetDeferredFinalization(bool enabled);
+	int		PendingFinalizers();
+	int		RunFinalizers(int maxCount);
+
+	// Collection is triggered when memory usage reaches the threshold, threshold is multiplied by the growth factor when memory that survived a collection exceeds the target utilization of it
+	void	SetCollectionPolicy(int initialThreshold, double growthFactor, double targetUtilization, double maxPauseTime);
+	// Collects memory if something was allocated after the last collection and the estimated pause fits the policy pause budget
+	bool	CollectIfCheap();
 }
 NamespaceGC GC;
@@ -61,12 +61,20 @@ void list:pop_back()
 	if(!last)
 		assert(0, "list::pop_back list is empty");
 	last = last.prev;
+	if(last)
+		last.next = nullptr;
+	else
+		first = nullptr;
 }
 void list:pop_front()
 {
 	if(!first)
-		assert(0, "list::pop_back list is empty");
+		assert(0, "list::pop_front list is empty");
 	first = first.next;
+	if(first)
+		first.prev = nullptr;
+	else
+		last = nullptr;
 }
 void list:insert(list_node<T> ref it, T elem)
 {
@@ -80,11 +88,13 @@ void list:insert(list_node<T> ref it, T elem)
 	it.next.parent = this;
 	if(next)
 		next.prev = it.next;
+	if(it == last)
+		last = it.next;
 }
 void list:erase(list_node<T> ref it)
 {
 	if(it.parent != this)
-		assert(0, "list::insert iterator is from a different list");
+		assert(0, "list::erase iterator is from a different list");
 	auto prev = it.prev, next = it.next;
 	if(prev)
 		prev.next = next;
@@ -74,3 +74,8 @@ unsigned char* FindRegVmRegKillInfo(ByteCode *code)
 {
 	return (unsigned char*)((char*)(code) + code->regVmOffsetToRegKillInfo);
 }
+
+unsigned* FindRegVmRelocations(ByteCode *code)
+{
+	return (unsigned*)((char*)(code) + code->regVmOffsetToRelocations);
+}
@@ -238,6 +238,7 @@ struct ExternSourceInfo
 struct ByteCode
 {
 	unsigned int	size;	// Overall size
+	unsigned int	version;	// NULLC_BYTECODE_VERSION
 
 	unsigned int	typeCount;
 
@@ -271,6 +272,9 @@ struct ByteCode
 	unsigned int	regVmRegKillInfoCount;
 	unsigned int	regVmOffsetToRegKillInfo;
 
+	unsigned int	regVmRelocationCount;	// instructions that have to be adjusted when module is linked
+	unsigned int	regVmOffsetToRelocations;
+
 	unsigned int	symbolLength;
 	unsigned int	offsetToSymbols;
 
@@ -318,6 +322,8 @@ struct ByteCode
 //	char			llvmCode[llvmSize];
 
 //	unsigned		regVmConstants[regVmConstantCount];
+
+//	unsigned		regVmRelocations[regVmRelocationCount];
 };
 
 #pragma pack(pop)
@@ -337,5 +343,6 @@ char*				FindSymbols(ByteCode *code);
 char*				FindSource(ByteCode *code);
 unsigned*			FindRegVmConstants(ByteCode *code);
 unsigned char*		FindRegVmRegKillInfo(ByteCode *code);
+unsigned*			FindRegVmRelocations(ByteCode *code);
 
 #endif
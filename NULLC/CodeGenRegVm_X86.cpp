@@ -4384,3 +4384,125 @@ void GenCodeCmdConvertPtr(CodeGenRegVmContext &ctx, RegVmCmd cmd)
 	EMIT_OP_RPTR_REG(ctx.ctx, o_mov, sDWORD, rREG, cmd.rA * 8, rEAX); // Move to target
 #endif
 }
+
+void* NewObjectWrap(CodeGenRegVmStateContext *vmState, unsigned size, unsigned typeId)
+{
+	CodeGenRegVmContext &ctx = *vmState->ctx;
+
+	vmState->callStackTop->instruction = vmState->callInstructionPos + 1;
+	vmState->callStackTop++;
+
+	vmState->jitCodeActive = false;
+
+	void *ptr = NULLC::AllocObject(size, typeId);
+
+	vmState->jitCodeActive = true;
+
+	if(!ctx.x86rvm->callContinue)
+		longjmp(vmState->errorHandler, 1);
+
+	vmState->callStackTop--;
+
+	return ptr;
+}
+
+void GenCodeCmdNewObject(CodeGenRegVmContext &ctx, RegVmCmd cmd)
+{
+	ctx.vmState->newObjectWrap = NewObjectWrap;
+
+	unsigned size = (cmd.rB << 8) | cmd.rC;
+
+	// Objects that have a finalizer or don't fit into a size class are always allocated by the runtime
+	NULLC::AllocationBuffer *buffer = NULLC::GetAllocationBuffer(size);
+
+	if(ctx.exTypes[cmd.argument].typeFlags & ExternTypeInfo::TYPE_HAS_FINALIZER)
+		buffer = NULL;
+
+	// Marker is written as a sign-extended immediate
+	if(cmd.argument >= (1u << 23))
+		buffer = NULL;
+
+#if defined(_M_X64)
+	if(buffer)
+	{
+		EMIT_OP_REG_NUM64(ctx.ctx, o_mov64, rRDX, uintptr_t(buffer));
+		EMIT_OP_REG_RPTR(ctx.ctx, o_mov64, rRAX, sQWORD, rRDX, nullcOffsetOf(buffer, current)); // Load buffer position
+		EMIT_OP_REG_RPTR(ctx.ctx, o_mov64, rRCX, sQWORD, rRDX, nullcOffsetOf(buffer, end)); // Load buffer end
+		EMIT_OP_REG_REG(ctx.ctx, o_cmp64, rRAX, rRCX);
+		EMIT_OP_LABEL(ctx.ctx, o_je, ctx.labelCount, false);
+
+		// Check that the allocation doesn't reach the collection limit
+		EMIT_OP_REG_NUM64(ctx.ctx, o_mov64, rRCX, uintptr_t(NULLC::GetUsedMemoryCounter()));
+		EMIT_OP_REG_RPTR(ctx.ctx, o_mov, rEDI, sDWORD, rRCX, 0);
+		EMIT_OP_REG_NUM(ctx.ctx, o_add, rEDI, buffer->blockSize);
+		EMIT_OP_REG_NUM64(ctx.ctx, o_mov64, rRSI, uintptr_t(NULLC::GetAllocationLimit()));
+		EMIT_OP_REG_RPTR(ctx.ctx, o_mov, rESI, sDWORD, rRSI, 0);
+		EMIT_OP_REG_REG(ctx.ctx, o_cmp, rEDI, rESI);
+		EMIT_OP_LABEL(ctx.ctx, o_ja, ctx.labelCount, false);
+
+		EMIT_OP_RPTR_REG(ctx.ctx, o_mov, sDWORD, rRCX, 0, rEDI); // Update used memory
+
+		EMIT_OP_REG_RPTR(ctx.ctx, o_lea, rRDI, sQWORD, rRAX, buffer->blockSize);
+		EMIT_OP_RPTR_REG(ctx.ctx, o_mov64, sQWORD, rRDX, nullcOffsetOf(buffer, current), rRDI); // Advance buffer position
+
+		EMIT_OP_RPTR_NUM(ctx.ctx, o_mov64, sQWORD, rRAX, 0, cmd.argument << 8); // Write marker
+		EMIT_OP_REG_NUM(ctx.ctx, o_add64, rRAX, sizeof(uintptr_t));
+		EMIT_OP_RPTR_REG(ctx.ctx, o_mov64, sQWORD, rREG, cmd.rA * 8, rRAX); // Store to target
+
+		EMIT_OP_LABEL(ctx.ctx, o_jmp, ctx.labelCount + 1, false);
+
+		EMIT_LABEL(ctx.ctx, ctx.labelCount, true);
+	}
+
+	EMIT_OP_REG_REG(ctx.ctx, o_mov64, rArg1, rR13);
+	EMIT_OP_RPTR_NUM(ctx.ctx, o_mov, sDWORD, rArg1, nullcOffsetOf(ctx.vmState, callInstructionPos), ctx.currInstructionPos);
+	EMIT_OP_REG_NUM(ctx.ctx, o_mov, rArg2, size);
+	EMIT_OP_REG_NUM(ctx.ctx, o_mov, rArg3, cmd.argument);
+	EMIT_REG_READ(ctx.ctx, rArg1);
+	EMIT_REG_READ(ctx.ctx, rArg2);
+	EMIT_REG_READ(ctx.ctx, rArg3);
+	EMIT_OP_RPTR(ctx.ctx, o_call, sQWORD, rArg1, nullcOffsetOf(ctx.vmState, newObjectWrap));
+
+	EMIT_OP_RPTR_REG(ctx.ctx, o_mov64, sQWORD, rREG, cmd.rA * 8, rRAX); // Store to target
+#else
+	if(buffer)
+	{
+		EMIT_OP_REG_ADDR(ctx.ctx, o_mov, rEAX, sDWORD, uintptr_t(&buffer->current)); // Load buffer position
+		EMIT_OP_REG_ADDR(ctx.ctx, o_mov, rECX, sDWORD, uintptr_t(&buffer->end)); // Load buffer end
+		EMIT_OP_REG_REG(ctx.ctx, o_cmp, rEAX, rECX);
+		EMIT_OP_LABEL(ctx.ctx, o_je, ctx.labelCount, false);
+
+		// Check that the allocation doesn't reach the collection limit
+		EMIT_OP_REG_ADDR(ctx.ctx, o_mov, rEDX, sDWORD, uintptr_t(NULLC::GetUsedMemoryCounter()));
+		EMIT_OP_REG_NUM(ctx.ctx, o_add, rEDX, buffer->blockSize);
+		EMIT_OP_REG_ADDR(ctx.ctx, o_mov, rECX, sDWORD, uintptr_t(NULLC::GetAllocationLimit()));
+		EMIT_OP_REG_REG(ctx.ctx, o_cmp, rEDX, rECX);
+		EMIT_OP_LABEL(ctx.ctx, o_ja, ctx.labelCount, false);
+
+		EMIT_OP_ADDR_REG(ctx.ctx, o_mov, sDWORD, uintptr_t(NULLC::GetUsedMemoryCounter()), rEDX); // Update used memory
+
+		EMIT_OP_REG_RPTR(ctx.ctx, o_lea, rECX, sDWORD, rEAX, buffer->blockSize);
+		EMIT_OP_ADDR_REG(ctx.ctx, o_mov, sDWORD, uintptr_t(&buffer->current), rECX); // Advance buffer position
+
+		EMIT_OP_RPTR_NUM(ctx.ctx, o_mov, sDWORD, rEAX, 0, cmd.argument << 8); // Write marker
+		EMIT_OP_REG_NUM(ctx.ctx, o_add, rEAX, sizeof(uintptr_t));
+		EMIT_OP_RPTR_REG(ctx.ctx, o_mov, sDWORD, rREG, cmd.rA * 8, rEAX); // Store to target
+
+		EMIT_OP_LABEL(ctx.ctx, o_jmp, ctx.labelCount + 1, false);
+
+		EMIT_LABEL(ctx.ctx, ctx.labelCount, true);
+	}
+
+	EMIT_OP_RPTR_NUM(ctx.ctx, o_mov, sDWORD, uintptr_t(&ctx.vmState->callInstructionPos), ctx.currInstructionPos);
+	EMIT_OP_NUM(ctx.ctx, o_push, cmd.argument);
+	EMIT_OP_NUM(ctx.ctx, o_push, size);
+	EMIT_OP_NUM(ctx.ctx, o_push, uintptr_t(ctx.vmState));
+	EMIT_OP_ADDR(ctx.ctx, o_call, sDWORD, uintptr_t(&ctx.vmState->newObjectWrap));
+	EMIT_OP_REG_NUM(ctx.ctx, o_add, rESP, 12);
+
+	EMIT_OP_RPTR_REG(ctx.ctx, o_mov, sDWORD, rREG, cmd.rA * 8, rEAX); // Store to target
+#endif
+
+	EMIT_LABEL(ctx.ctx, ctx.labelCount + 1, true);
+	ctx.labelCount += 2;
+}
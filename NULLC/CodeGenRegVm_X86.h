@@ -26,6 +26,7 @@ struct CodeGenRegVmStateContext
 		callWrap = NULL;
 		checkedReturnWrap = NULL;
 		convertPtrWrap = NULL;
+		newObjectWrap = NULL;
 
 		errorOutOfBoundsWrap = NULL;
 		errorNoReturnWrap = NULL;
@@ -86,6 +87,7 @@ struct CodeGenRegVmStateContext
 	void (*callWrap)(CodeGenRegVmStateContext *vmState, unsigned functionId);
 	void (*checkedReturnWrap)(CodeGenRegVmStateContext *vmState, uintptr_t frameBase, unsigned typeId);
 	void (*convertPtrWrap)(CodeGenRegVmStateContext *vmState, unsigned targetTypeId, unsigned sourceTypeId);
+	void* (*newObjectWrap)(CodeGenRegVmStateContext *vmState, unsigned size, unsigned typeId);
 
 	void (*errorOutOfBoundsWrap)(CodeGenRegVmStateContext *vmState);
 	void (*errorNoReturnWrap)(CodeGenRegVmStateContext *vmState);
@@ -283,3 +285,4 @@ void GenCodeCmdBitNotl(CodeGenRegVmContext &ctx, RegVmCmd cmd);
 void GenCodeCmdLogNot(CodeGenRegVmContext &ctx, RegVmCmd cmd);
 void GenCodeCmdLogNotl(CodeGenRegVmContext &ctx, RegVmCmd cmd);
 void GenCodeCmdConvertPtr(CodeGenRegVmContext &ctx, RegVmCmd cmd);
+void GenCodeCmdNewObject(CodeGenRegVmContext &ctx, RegVmCmd cmd);
@@ -494,6 +494,146 @@ ExprModule* AnalyzeModuleFromSource(CompilerContext &ctx)
 	return ctx.exprModule;
 }
 
+unsigned GetVmOptimizationCount(VmModule *module)
+{
+	return module->peepholeOptimizations + module->constantPropagations + module->deadCodeEliminations + module->controlFlowSimplifications + module->loadStorePropagations + module->commonSubexprEliminations + module->deadAllocaStoreEliminations;
+}
+
+// Function pipeline only changes the function itself, but passes share the expression context (types, temporary names) and the module scratch state
+void OptimizeVmFunction(CompilerContext &ctx, VmFunction *function)
+{
+	VmModule *module = ctx.vmModule;
+
+	// Dead code elimination is required for correct register allocation
+	if(ctx.optimizationLevel == 0)
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+
+	if(ctx.optimizationLevel >= 1)
+	{
+		TRACE_SCOPE("compiler", "OptimizationLevel1");
+
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_PEEPHOLE);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_ARRAY_TO_ELEMENTS);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+	}
+
+	RunVmPass(ctx.exprCtx, module, function, VM_PASS_LEGALIZE_ARRAY_VALUES);
+
+	if(ctx.optimizationLevel >= 2)
+	{
+		TRACE_SCOPE("compiler", "OptimizationLevel2");
+
+		for(unsigned i = 0; i < 6; i++)
+		{
+			TRACE_SCOPE("compiler", "iteration");
+
+			unsigned before = GetVmOptimizationCount(module);
+
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_COMMON_SUBEXPRESSION_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_PEEPHOLE);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_ALLOCA_STORE_ELIMINATION);
+
+			unsigned after = GetVmOptimizationCount(module);
+
+			// Reached fixed point
+			if(before == after)
+				break;
+		}
+
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_SCALAR_REPLACEMENT);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_MEMORY_TO_REGISTER);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+
+		unsigned loopUnrolls = module->loopUnrolls;
+
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_LOOP_UNROLLING);
+
+		// Clean up unrolled loop bodies
+		if(module->loopUnrolls != loopUnrolls)
+		{
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
+
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_COMMON_SUBEXPRESSION_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_PEEPHOLE);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
+			RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+		}
+
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_LATE_PEEPHOLE);
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+
+		RunVmPass(ctx.exprCtx, module, function, VM_PASS_OPT_DEAD_ALLOCA_STORE_ELIMINATION);
+	}
+}
+
+void OptimizeVmModule(CompilerContext &ctx)
+{
+	TRACE_SCOPE("compiler", "OptimizeVmModule");
+
+	// Functions can be replaced at runtime through std.dynamic, so call sites have to stay intact
+	bool hasDynamicOverrides = false;
+
+	for(unsigned i = 0; i < ctx.exprCtx.uniqueDependencies.size(); i++)
+	{
+		if(ctx.exprCtx.uniqueDependencies[i]->name == InplaceStr("std/dynamic.nc"))
+			hasDynamicOverrides = true;
+	}
+
+	if(ctx.optimizationLevel >= 3 && !hasDynamicOverrides)
+	{
+		TRACE_SCOPE("compiler", "OptimizationLevel3");
+
+		// Simplify all functions first, so that inlining heuristic sees the reduced callee size
+		for(VmFunction *function = ctx.vmModule->functions.head; function; function = function->next)
+		{
+			if(!function->firstBlock)
+				continue;
+
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_PEEPHOLE);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+		}
+
+		// Generic function instances from imported modules are instantiated in this module, so their bodies are available for inlining as well
+		for(VmFunction *function = ctx.vmModule->functions.head; function; function = function->next)
+			RunVmPass(ctx.exprCtx, ctx.vmModule, function, VM_PASS_OPT_FUNCION_INLINING);
+	}
+
+	for(VmFunction *function = ctx.vmModule->functions.head; function; function = function->next)
+	{
+		if(!function->firstBlock)
+			continue;
+
+		OptimizeVmFunction(ctx, function);
+	}
+
+	RunVmPass(ctx.exprCtx, ctx.vmModule, VM_PASS_UPDATE_LIVE_SETS);
+
+	if(ctx.optimizationLevel >= 2)
+		RunVmPass(ctx.exprCtx, ctx.vmModule, VM_PASS_PREPARE_SSA_EXIT);
+
+	RunVmPass(ctx.exprCtx, ctx.vmModule, VM_PASS_LEGALIZE_BITCASTS);
+	RunVmPass(ctx.exprCtx, ctx.vmModule, VM_PASS_LEGALIZE_EXTRACTS);
+}
+
 bool CompileModuleFromSource(CompilerContext &ctx)
 {
 	TRACE_SCOPE("compiler", "CompileModuleFromSource");
@@ -501,6 +641,9 @@ bool CompileModuleFromSource(CompilerContext &ctx)
 	if(!AnalyzeModuleFromSource(ctx))
 		return false;
 
+	if(ctx.compileStage == NULLC_STAGE_ANALYZE)
+		return true;
+
 	ExpressionContext &exprCtx = ctx.exprCtx;
 
 	ctx.vmModule = CompileVm(exprCtx, ctx.exprModule, ctx.code);
@@ -540,81 +683,11 @@ bool CompileModuleFromSource(CompilerContext &ctx)
 		}
 	}
 
-	// Build LLVM module is support is enabled or just to test execution paths in debug build
-#if defined(NULLC_LLVM_SUPPORT)
-	ctx.llvmModule = CompileLlvm(exprCtx, ctx.exprModule);
-#elif !defined(NDEBUG)
-	ctx.llvmModule = CompileLlvm(exprCtx, ctx.exprModule);
-#endif
-
-	for(VmFunction *function = ctx.vmModule->functions.head; function; function = function->next)
-	{
-		if(!function->firstBlock)
-			continue;
-
-		// Dead code elimination is required for correct register allocation
-		if(ctx.optimizationLevel == 0)
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-
-		if(ctx.optimizationLevel >= 1)
-		{
-			TRACE_SCOPE("compiler", "OptimizationLevel1");
-
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_PEEPHOLE);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_ARRAY_TO_ELEMENTS);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-		}
-
-		RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_LEGALIZE_ARRAY_VALUES);
-
-		if(ctx.optimizationLevel >= 2)
-		{
-			TRACE_SCOPE("compiler", "OptimizationLevel2");
-
-			for(unsigned i = 0; i < 6; i++)
-			{
-				TRACE_SCOPE("compiler", "iteration");
-
-				unsigned before = ctx.vmModule->peepholeOptimizations + ctx.vmModule->constantPropagations + ctx.vmModule->deadCodeEliminations + ctx.vmModule->controlFlowSimplifications + ctx.vmModule->loadStorePropagations + ctx.vmModule->commonSubexprEliminations + ctx.vmModule->deadAllocaStoreEliminations;
-
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONSTANT_PROPAGATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_LOAD_STORE_PROPAGATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_COMMON_SUBEXPRESSION_ELIMINATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_PEEPHOLE);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_CONTROL_FLOW_SIPLIFICATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-				RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_ALLOCA_STORE_ELIMINATION);
-
-				unsigned after = ctx.vmModule->peepholeOptimizations + ctx.vmModule->constantPropagations + ctx.vmModule->deadCodeEliminations + ctx.vmModule->controlFlowSimplifications + ctx.vmModule->loadStorePropagations + ctx.vmModule->commonSubexprEliminations + ctx.vmModule->deadAllocaStoreEliminations;
-
-				// Reached fixed point
-				if(before == after)
-					break;
-			}
-
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_MEMORY_TO_REGISTER);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
+	// LLVM module is only built when requested, debug builds can request it without LLVM support to test the execution paths
+	if(ctx.compileStage >= NULLC_STAGE_LLVM)
+		ctx.llvmModule = CompileLlvm(exprCtx, ctx.exprModule);
 
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_LATE_PEEPHOLE);
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_CODE_ELIMINATION);
-
-			RunVmPass(exprCtx, ctx.vmModule, function, VM_PASS_OPT_DEAD_ALLOCA_STORE_ELIMINATION);
-		}
-	}
-
-	RunVmPass(exprCtx, ctx.vmModule, VM_PASS_UPDATE_LIVE_SETS);
-
-	if(ctx.optimizationLevel >= 2)
-		RunVmPass(exprCtx, ctx.vmModule, VM_PASS_PREPARE_SSA_EXIT);
-
-	RunVmPass(exprCtx, ctx.vmModule, VM_PASS_LEGALIZE_BITCASTS);
-	RunVmPass(exprCtx, ctx.vmModule, VM_PASS_LEGALIZE_EXTRACTS);
+	OptimizeVmModule(ctx);
 
 	RunVmPass(exprCtx, ctx.vmModule, VM_PASS_CREATE_ALLOCA_STORAGE);
 
@@ -641,6 +714,9 @@ bool CompileModuleFromSource(CompilerContext &ctx)
 		}
 	}
 
+	if(ctx.compileStage == NULLC_STAGE_VM)
+		return true;
+
 	ctx.regVmLoweredModule = RegVmLowerModule(exprCtx, ctx.vmModule);
 
 	if(!ctx.regVmLoweredModule->functions.empty() && ctx.regVmLoweredModule->functions.back()->hasRegisterOverflow)
@@ -814,6 +890,10 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 		if(!ctx.exprCtx.GlobalScopeFrom(variable->scope))
 			continue;
 
+		// Temporaries that are not used by the generated code don't have storage
+		if(variable->offset == ~0u)
+			continue;
+
 		externVariableInfoCount++;
 
 		globalVarCount++;
@@ -965,6 +1045,17 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 	unsigned offsetToRegVmConstants = size;
 	size += ctx.instRegVmFinalizeCtx.constants.size() * sizeof(ctx.instRegVmFinalizeCtx.constants[0]);
 
+	unsigned regVmRelocationCount = 0;
+
+	for(unsigned i = 0; i < ctx.instRegVmFinalizeCtx.cmds.size(); i++)
+	{
+		if(HasRegVmRelocation(ctx.instRegVmFinalizeCtx.cmds[i]))
+			regVmRelocationCount++;
+	}
+
+	unsigned offsetToRegVmRelocations = size;
+	size += regVmRelocationCount * sizeof(unsigned);
+
 	unsigned offsetToRegVmRegKillInfo = size;
 	size += ctx.instRegVmFinalizeCtx.regKillInfo.size() * sizeof(ctx.instRegVmFinalizeCtx.regKillInfo[0]);
 
@@ -995,6 +1086,7 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 
 	ByteCode *code = (ByteCode*)(*bytecode);
 	code->size = size;
+	code->version = NULLC_BYTECODE_VERSION;
 
 	code->typeCount = (unsigned)ctx.exprCtx.types.size();
 
@@ -1027,6 +1119,9 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 	code->regVmRegKillInfoCount = ctx.instRegVmFinalizeCtx.regKillInfo.size();
 	code->regVmOffsetToRegKillInfo = offsetToRegVmRegKillInfo;
 
+	code->regVmRelocationCount = regVmRelocationCount;
+	code->regVmOffsetToRelocations = offsetToRegVmRelocations;
+
 	code->symbolLength = symbolStorageSize;
 	code->offsetToSymbols = offsetToSymbols;
 
@@ -1422,6 +1517,9 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 		if(!ctx.exprCtx.GlobalScopeFrom(variable->scope))
 			continue;
 
+		if(variable->offset == ~0u)
+			continue;
+
 		if(variable->scope != ctx.exprCtx.globalScope && !variable->scope->ownerNamespace)
 			continue;
 
@@ -1447,6 +1545,9 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 		if(!ctx.exprCtx.GlobalScopeFrom(variable->scope))
 			continue;
 
+		if(variable->offset == ~0u)
+			continue;
+
 		if(variable->scope == ctx.exprCtx.globalScope || variable->scope->ownerNamespace)
 			continue;
 
@@ -1841,6 +1942,14 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode)
 	if(ctx.instRegVmFinalizeCtx.regKillInfo.size())
 		memcpy(FindRegVmRegKillInfo(code), ctx.instRegVmFinalizeCtx.regKillInfo.data, ctx.instRegVmFinalizeCtx.regKillInfo.size() * sizeof(ctx.instRegVmFinalizeCtx.regKillInfo[0]));
 
+	unsigned *regVmRelocations = FindRegVmRelocations(code);
+
+	for(unsigned i = 0; i < ctx.instRegVmFinalizeCtx.cmds.size(); i++)
+	{
+		if(HasRegVmRelocation(ctx.instRegVmFinalizeCtx.cmds[i]))
+			*regVmRelocations++ = i;
+	}
+
 	char *sourceCode = (char*)code + offsetToSource;
 	memcpy(sourceCode, ctx.code, sourceLength);
 
@@ -1968,7 +2077,7 @@ bool SaveListing(CompilerContext &ctx, const char *fileName)
 	return true;
 }
 
-bool TranslateToC(CompilerContext &ctx, const char *fileName, const char *mainName, void (*addDependency)(const char *fileName))
+bool TranslateToC(CompilerContext &ctx, const char *fileName, const char *mainName, void (*addDependency)(const char *fileName), bool exportNativeBindings, bool vectorFriendlyLoops)
 {
 	TRACE_SCOPE("compiler", "TranslateToC");
 
@@ -1985,6 +2094,9 @@ bool TranslateToC(CompilerContext &ctx, const char *fileName, const char *mainNa
 
 	exprTranslateCtx.mainName = mainName;
 
+	exprTranslateCtx.exportNativeBindings = exportNativeBindings;
+	exprTranslateCtx.vectorFriendlyLoops = vectorFriendlyLoops;
+
 	exprTranslateCtx.errorBuf = ctx.errorBuf;
 	exprTranslateCtx.errorBufSize = ctx.errorBufSize;
 
@@ -40,6 +40,12 @@ struct CompilerContext
 		regVmLoweredModule = 0;
 
 		enableLogFiles = false;
+
+#if defined(NULLC_LLVM_SUPPORT)
+		compileStage = NULLC_STAGE_LLVM;
+#else
+		compileStage = NULLC_STAGE_REG_VM;
+#endif
 	}
 
 	Allocator *allocator;
@@ -72,6 +78,8 @@ struct CompilerContext
 	bool enableLogFiles;
 
 	int optimizationLevel;
+
+	int compileStage;
 };
 
 bool BuildBaseModule(Allocator *allocator, int optimizationLevel);
@@ -84,7 +92,7 @@ unsigned GetBytecode(CompilerContext &ctx, char **bytecode);
 
 bool SaveListing(CompilerContext &ctx, const char *fileName);
 
-bool TranslateToC(CompilerContext &ctx, const char *fileName, const char *mainName, void (*addDependency)(const char *fileName));
+bool TranslateToC(CompilerContext &ctx, const char *fileName, const char *mainName, void (*addDependency)(const char *fileName), bool exportNativeBindings, bool vectorFriendlyLoops);
 
 char* BuildModuleFromSource(Allocator *allocator, const char *modulePath, const char *moduleRoot, const char *code, unsigned codeSize, const char **errorPos, char *errorBuf, unsigned errorBufSize, int optimizationLevel, ArrayView<InplaceStr> activeImports);
 char* BuildModuleFromPath(Allocator *allocator, InplaceStr moduleName, const char *moduleRoot, bool addExtension, const char **errorPos, char *errorBuf, unsigned errorBufSize, int optimizationLevel, ArrayView<InplaceStr> activeImports);
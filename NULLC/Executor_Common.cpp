@@ -718,7 +718,42 @@ namespace GC
 	FastVector<char*> rootsA, rootsB;
 	FastVector<char*> *curr = NULL, *next = NULL;
 
-	HashMap<int> functionIDs;
+	enum RootSlotKind
+	{
+		ROOT_POINTER,
+		ROOT_FUNCTION,
+		ROOT_VARIABLE
+	};
+
+	// Location of a pointer in global variables or a function stack frame. Variables that have to be inspected at run time are checked using their type
+	struct RootSlot
+	{
+		unsigned	offset;
+		unsigned	kind;
+		unsigned	type;
+	};
+
+	// Pointer slots of a function stack frame, sorted by function code address
+	// These only speed up the marker: the list covers the whole function, there is no liveness information for each call site, so all pointer locals of a frame are roots
+	struct FramePointerSlots
+	{
+		int			address;
+		int			end;
+		unsigned	stackSize;
+		unsigned	rootStart;
+		unsigned	rootCount;
+	};
+
+	FastVector<RootSlot>		globalRoots;
+	FastVector<RootSlot>		frameRoots;
+	FastVector<FramePointerSlots>	framePointerSlots;
+
+	// Linker code version that the pointer slot lists were built for
+	bool		pointerSlotsValid = false;
+	unsigned	pointerSlotsCodeVersion = 0;
+
+	// Number of objects marked as reachable since the start of the collection
+	unsigned	markedObjects = 0;
 
 	void PrintMarker(markerType marker)
 	{
@@ -783,6 +818,11 @@ namespace GC
 
 			// Marker is before the block
 			markerType *marker = (markerType*)((char*)basePtr - sizeof(markerType));
+
+			// Pointer to the end of an object or to a zero-sized object might point to a free block that follows it
+			if(*marker & OBJECT_FREED)
+				return;
+
 			PrintMarker(*marker);
 
 			// If block is unmarked
@@ -791,6 +831,7 @@ namespace GC
 
 			// Mark block as used
 			*marker |= OBJECT_VISIBLE;
+			markedObjects++;
 
 			GC_DEBUG_PRINT("\tMarked as used\n");
 
@@ -981,6 +1022,194 @@ namespace GC
 	}
 }
 
+namespace GC
+{
+	void AddRootSlot(FastVector<RootSlot> &roots, unsigned offset, RootSlotKind kind, unsigned type)
+	{
+		RootSlot &slot = *roots.push_back();
+
+		slot.offset = offset;
+		slot.kind = kind;
+		slot.type = type;
+	}
+
+	// Flatten variable of the specified type into a list of pointer slots
+	void AddRootSlots(FastVector<RootSlot> &roots, unsigned offset, unsigned typeIndex)
+	{
+		ExternTypeInfo &type = NULLC::commonLinker->exTypes[typeIndex];
+
+		// Actual type of an extendable class is only known at run time
+		if(type.typeFlags & ExternTypeInfo::TYPE_IS_EXTENDABLE)
+		{
+			AddRootSlot(roots, offset, ROOT_VARIABLE, typeIndex);
+			return;
+		}
+
+		if(!type.pointerCount)
+			return;
+
+		switch(type.subCat)
+		{
+		case ExternTypeInfo::CAT_NONE:
+			break;
+		case ExternTypeInfo::CAT_ARRAY:
+			if(type.arrSize == ~0u)
+			{
+				AddRootSlot(roots, offset, ROOT_POINTER, typeIndex);
+			}
+			else if(type.arrSize <= 16)
+			{
+				unsigned elementSize = NULLC::commonLinker->exTypes[type.subType].size;
+
+				for(unsigned i = 0; i < type.arrSize; i++)
+					AddRootSlots(roots, offset + i * elementSize, type.subType);
+			}
+			else
+			{
+				AddRootSlot(roots, offset, ROOT_VARIABLE, typeIndex);
+			}
+			break;
+		case ExternTypeInfo::CAT_POINTER:
+			AddRootSlot(roots, offset, ROOT_POINTER, typeIndex);
+			break;
+		case ExternTypeInfo::CAT_FUNCTION:
+			AddRootSlot(roots, offset, ROOT_FUNCTION, typeIndex);
+			break;
+		case ExternTypeInfo::CAT_CLASS:
+			// Pointer of 'auto ref' and 'auto[]' follows the type ID
+			if(type.nameHash == objectName || type.nameHash == autoArrayName)
+			{
+				AddRootSlot(roots, offset + NULLC_PTR_SIZE, ROOT_POINTER, typeIndex);
+			}
+			else
+			{
+				ExternMemberInfo *memberList = &NULLC::commonLinker->exTypeExtra[type.memberOffset + type.memberCount];
+
+				for(unsigned n = 0; n < type.pointerCount; n++)
+					AddRootSlots(roots, offset + memberList[n].offset, memberList[n].type);
+			}
+			break;
+		}
+	}
+
+	// Build pointer slot lists of global variables and function stack frames once for each version of the linked code
+	void UpdatePointerSlots()
+	{
+		Linker *linker = NULLC::commonLinker;
+
+		if(pointerSlotsValid && pointerSlotsCodeVersion == linker->codeVersion)
+			return;
+
+		globalRoots.clear();
+		frameRoots.clear();
+		framePointerSlots.clear();
+
+		for(unsigned i = 0; i < linker->exVariables.size(); i++)
+			AddRootSlots(globalRoots, linker->exVariables[i].offset, linker->exVariables[i].type);
+
+		for(unsigned i = 0; i < linker->exFunctions.size(); i++)
+		{
+			ExternFuncInfo &function = linker->exFunctions[i];
+
+			if(function.regVmAddress == -1)
+				continue;
+
+			FramePointerSlots &map = *framePointerSlots.push_back();
+
+			map.address = function.regVmAddress;
+			map.end = function.regVmAddress + function.regVmCodeSize;
+			map.stackSize = (function.stackSize + 0xf) & ~0xf;
+			map.rootStart = frameRoots.size();
+
+			for(unsigned k = 0; k < function.localCount; k++)
+			{
+				ExternLocalInfo &lInfo = linker->exLocals[function.offsetToFirstLocal + k];
+
+				AddRootSlots(frameRoots, lInfo.offset, lInfo.type);
+			}
+
+			if(function.contextType != ~0u)
+				AddRootSlot(frameRoots, function.bytesToPop - NULLC_PTR_SIZE, ROOT_POINTER, function.contextType);
+
+			map.rootCount = frameRoots.size() - map.rootStart;
+		}
+
+		// Functions are sorted by address for a binary search, code of each function is continuous
+		for(unsigned i = 1; i < framePointerSlots.size(); i++)
+		{
+			FramePointerSlots map = framePointerSlots[i];
+
+			unsigned k = i;
+
+			while(k > 0 && framePointerSlots[k - 1].address > map.address)
+			{
+				framePointerSlots[k] = framePointerSlots[k - 1];
+				k--;
+			}
+
+			framePointerSlots[k] = map;
+		}
+
+		// Different function entries can share the same code, the last one is used
+		unsigned uniqueCount = 0;
+
+		for(unsigned i = 0; i < framePointerSlots.size(); i++)
+		{
+			if(uniqueCount && framePointerSlots[uniqueCount - 1].address == framePointerSlots[i].address)
+				uniqueCount--;
+
+			framePointerSlots[uniqueCount++] = framePointerSlots[i];
+		}
+
+		framePointerSlots.count = uniqueCount;
+
+		pointerSlotsValid = true;
+		pointerSlotsCodeVersion = linker->codeVersion;
+	}
+
+	FramePointerSlots* FindFramePointerSlots(int address)
+	{
+		unsigned lowerBound = 0;
+		unsigned upperBound = framePointerSlots.size();
+
+		while(lowerBound < upperBound)
+		{
+			unsigned pointer = (lowerBound + upperBound) >> 1;
+
+			if(framePointerSlots[pointer].end <= address)
+				lowerBound = pointer + 1;
+			else
+				upperBound = pointer;
+		}
+
+		if(lowerBound < framePointerSlots.size() && address >= framePointerSlots[lowerBound].address)
+			return &framePointerSlots[lowerBound];
+
+		return NULL;
+	}
+
+	void CheckRootSlots(char *base, RootSlot *slots, unsigned count)
+	{
+		ExternTypeInfo *types = NULLC::commonLinker->exTypes.data;
+
+		for(RootSlot *slot = slots, *end = slots + count; slot != end; slot++)
+		{
+			switch(slot->kind)
+			{
+			case ROOT_POINTER:
+				CheckPointer(base + slot->offset);
+				break;
+			case ROOT_FUNCTION:
+				CheckFunction(base + slot->offset);
+				break;
+			case ROOT_VARIABLE:
+				CheckVariable(base + slot->offset, types[slot->type]);
+				break;
+			}
+		}
+	}
+}
+
 // Set range of memory that is not checked. Used to exclude pointers to stack from marking and GC
 void GC::SetUnmanagableRange(char* base, unsigned int size)
 {
@@ -998,15 +1227,9 @@ void GC::MarkUsedBlocks()
 {
 	GC_DEBUG_PRINT("Unmanageable range: %p-%p\n", GC::unmanageableBase, GC::unmanageableTop);
 
-	// Get information about programs' functions, variables, types and symbols (for debug output)
-	ExternFuncInfo	*functions = NULLC::commonLinker->exFunctions.data;
-	ExternVarInfo	*vars = NULLC::commonLinker->exVariables.data;
-	ExternTypeInfo	*types = NULLC::commonLinker->exTypes.data;
-	char			*symbols = NULLC::commonLinker->exSymbols.data;
-	(void)symbols;
+	GC::UpdatePointerSlots();
 
-	GC::functionIDs.init();
-	GC::functionIDs.clear();
+	GC::markedObjects = 0;
 
 	GC::curr = &GC::rootsA;
 	GC::next = &GC::rootsB;
@@ -1020,11 +1243,8 @@ void GC::MarkUsedBlocks()
 	if(execID != NULLC_LLVM)
 	{
 		// Mark global variables
-		for(unsigned int i = 0; i < NULLC::commonLinker->exVariables.size(); i++)
-		{
-			GC_DEBUG_PRINT("Global %s %s (with offset of %d)\n", symbols + types[vars[i].type].offsetToName, symbols + vars[i].offsetToName, vars[i].offset);
-			GC::CheckVariable(GC::unmanageableBase + vars[i].offset, types[vars[i].type]);
-		}
+		GC_DEBUG_PRINT("Globals (%d pointer slots)\n", GC::globalRoots.size());
+		GC::CheckRootSlots(GC::unmanageableBase, GC::globalRoots.data, GC::globalRoots.size());
 	}
 	else
 	{
@@ -1034,11 +1254,8 @@ void GC::MarkUsedBlocks()
 		unsigned count = 0;
 		char *data = exec->GetVariableData(&count);
 
-		for(unsigned int i = 0; i < NULLC::commonLinker->exVariables.size(); i++)
-		{
-			GC_DEBUG_PRINT("Global %s %s (with offset of %d)\n", symbols + types[vars[i].type].offsetToName, symbols + vars[i].offsetToName, vars[i].offset);
-			GC::CheckVariable(data + vars[i].offset, types[vars[i].type]);
-		}
+		GC_DEBUG_PRINT("Globals (%d pointer slots)\n", GC::globalRoots.size());
+		GC::CheckRootSlots(data, GC::globalRoots.data, GC::globalRoots.size());
 #endif
 	}
 
@@ -1081,58 +1298,19 @@ void GC::MarkUsedBlocks()
 		if(address == 0)
 			break;
 
-		// Find corresponding function
-		int *cachedFuncID = GC::functionIDs.find(address);
-
-		int funcID = -1;
-		if(cachedFuncID)
-		{
-			funcID = *cachedFuncID;
-		}
-		else
-		{
-			for(unsigned i = 0; i < NULLC::commonLinker->exFunctions.size(); i++)
-			{
-				if(address >= functions[i].regVmAddress && address < (functions[i].regVmAddress + functions[i].regVmCodeSize))
-					funcID = i;
-			}
-
-			GC::functionIDs.insert(address, funcID);
-		}
-
-		// If we are not in global scope
-		if(funcID != -1)
+		// If we are not in global scope, check pointer slots of the function stack frame
+		if(GC::FramePointerSlots *map = GC::FindFramePointerSlots(address))
 		{
-			ExternFuncInfo &function = functions[funcID];
-
 			// Align offset to the first variable (by 16 byte boundary)
 			int alignOffset = (offset % 16 != 0) ? (16 - (offset % 16)) : 0;
 			offset += alignOffset;
-			GC_DEBUG_PRINT("In function %s (with offset of %d)\n", symbols + function.offsetToName, alignOffset);
-
-			unsigned stackSize = (function.stackSize + 0xf) & ~0xf;
-
-			// Check every function local
-			for(unsigned i = 0; i < function.localCount; i++)
-			{
-				// Get information about local
-				ExternLocalInfo &lInfo = NULLC::commonLinker->exLocals[function.offsetToFirstLocal + i];
-
-				GC_DEBUG_PRINT("Local %s %s (with offset of %d+%d)\n", symbols + types[lInfo.type].offsetToName, symbols + lInfo.offsetToName, offset, lInfo.offset);
-				// Check it
-				GC::CheckVariable(GC::unmanageableBase + offset + lInfo.offset, types[lInfo.type]);
-			}
+			GC_DEBUG_PRINT("In function at %d (with offset of %d, %d pointer slots)\n", map->address, alignOffset, map->rootCount);
 
-			if(function.contextType != ~0u)
-			{
-				GC_DEBUG_PRINT("Local %s $context (with offset of %d+%d)\n", symbols + types[function.contextType].offsetToName, offset, function.bytesToPop - NULLC_PTR_SIZE);
-				char *ptr = GC::unmanageableBase + offset + function.bytesToPop - NULLC_PTR_SIZE;
-				GC::CheckPointer(ptr);
-			}
+			GC::CheckRootSlots(GC::unmanageableBase + offset, GC::frameRoots.data + map->rootStart, map->rootCount);
 
-			offset += stackSize;
+			offset += map->stackSize;
 
-			GC_DEBUG_PRINT("Moving offset to next frame by %d bytes\n", stackSize);
+			GC_DEBUG_PRINT("Moving offset to next frame by %d bytes\n", map->stackSize);
 		}
 	}
 
@@ -1201,6 +1379,7 @@ void GC::MarkUsedBlocks()
 				if(!(*marker & OBJECT_VISIBLE))
 				{
 					*marker |= OBJECT_VISIBLE;
+					GC::markedObjects++;
 
 					GC_DEBUG_PRINT("\tMarked as used, checking content\n");
 
@@ -1243,12 +1422,678 @@ void GC::MarkPendingRoots()
 	GC_DEBUG_PRINT("\n");
 }
 
+unsigned GC::MarkedObjectCount()
+{
+	return GC::markedObjects;
+}
+
 void GC::ResetGC()
 {
 	GC::rootsA.reset();
 	GC::rootsB.reset();
 
-	GC::functionIDs.reset();
+	GC::globalRoots.reset();
+	GC::frameRoots.reset();
+	GC::framePointerSlots.reset();
+
+	GC::pointerSlotsValid = false;
+}
+
+namespace ProgramImage
+{
+	struct Fixup
+	{
+		// Object index is 0 for global variables and (index + 1) for heap objects
+		unsigned sourceObject;
+		unsigned sourceOffset;
+
+		unsigned targetObject;
+		unsigned targetOffset;
+	};
+
+	struct SaveContext
+	{
+		SaveContext(char *globals, unsigned globalSize): globals(globals), globalSize(globalSize)
+		{
+			objectMap.init();
+
+			regionBase = globals;
+			regionIndex = 0;
+
+			external = false;
+		}
+
+		char *globals;
+		unsigned globalSize;
+
+		FastVector<char*> objects;
+		HashMap<unsigned> objectMap;
+
+		FastVector<Fixup> fixups;
+
+		char *regionBase;
+		unsigned regionIndex;
+
+		// Pointer to memory that is not owned by the program was found
+		bool external;
+	};
+
+	unsigned GetObjectIndex(SaveContext &ctx, char *base)
+	{
+		unsigned hash = NULLC::GetStringHash((const char*)&base, (const char*)&base + sizeof(base));
+
+		for(HashMap<unsigned>::Node *curr = ctx.objectMap.first(hash); curr; curr = ctx.objectMap.next(curr))
+		{
+			if(ctx.objects[curr->value] == base)
+				return curr->value;
+		}
+
+		ctx.objects.push_back(base);
+		ctx.objectMap.insert(hash, ctx.objects.size() - 1);
+
+		return ctx.objects.size() - 1;
+	}
+
+	void SaveVariable(SaveContext &ctx, char* ptr, const ExternTypeInfo& type);
+
+	// Pointers are traversed in the same way as the garbage collector marks memory blocks
+	// Values that do not point into global variables or heap objects are not owned by the program and can't be saved
+	void SavePointer(SaveContext &ctx, char* ptr)
+	{
+		char *target = GC::ReadVmMemoryPointer(ptr);
+
+		// Range of 0x00000000-0x00010000 contains upvalue offsets inside closures
+		if(target <= (char*)0x00010000)
+			return;
+
+		Fixup fixup;
+
+		fixup.sourceObject = ctx.regionIndex;
+		fixup.sourceOffset = unsigned(ptr - ctx.regionBase);
+
+		if(target >= ctx.globals && target <= ctx.globals + ctx.globalSize)
+		{
+			fixup.targetObject = 0;
+			fixup.targetOffset = unsigned(target - ctx.globals);
+		}
+		else if(char *base = (char*)NULLC::GetBasePointer(target))
+		{
+			fixup.targetObject = GetObjectIndex(ctx, base) + 1;
+			fixup.targetOffset = unsigned(target - base);
+		}
+		else
+		{
+			ctx.external = true;
+			return;
+		}
+
+		ctx.fixups.push_back(fixup);
+	}
+
+	void SaveArrayElements(SaveContext &ctx, char* ptr, unsigned size, const ExternTypeInfo& elementType)
+	{
+		if(!elementType.pointerCount)
+			return;
+
+		for(unsigned i = 0; i < size; i++, ptr += elementType.size)
+			SaveVariable(ctx, ptr, elementType);
+	}
+
+	void SaveArray(SaveContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		if(type.arrSize == ~0u)
+		{
+			NULLCArray *data = (NULLCArray*)ptr;
+
+			if(data->ptr)
+				SavePointer(ctx, (char*)&data->ptr);
+		}
+		else
+		{
+			SaveArrayElements(ctx, ptr, type.arrSize, NULLC::commonLinker->exTypes[type.subType]);
+		}
+	}
+
+	void SaveClass(SaveContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		if(type.nameHash == GC::objectName)
+		{
+			NULLCRef *data = (NULLCRef*)ptr;
+
+			if(data->ptr)
+				SavePointer(ctx, (char*)&data->ptr);
+		}
+		else if(type.nameHash == GC::autoArrayName)
+		{
+			NULLCAutoArray *data = (NULLCAutoArray*)ptr;
+
+			if(data->ptr)
+				SavePointer(ctx, (char*)&data->ptr);
+		}
+		else
+		{
+			ExternMemberInfo *memberList = type.pointerCount ? &NULLC::commonLinker->exTypeExtra[type.memberOffset + type.memberCount] : NULL;
+
+			for(unsigned n = 0; n < type.pointerCount; n++)
+				SaveVariable(ctx, ptr + memberList[n].offset, NULLC::commonLinker->exTypes[memberList[n].type]);
+		}
+	}
+
+	void SaveFunction(SaveContext &ctx, char* ptr)
+	{
+		NULLCFuncPtr *fPtr = (NULLCFuncPtr*)ptr;
+
+		if(!fPtr->context)
+			return;
+
+		const ExternFuncInfo &func = NULLC::commonLinker->exFunctions[fPtr->id];
+
+		if(func.regVmAddress == -1)
+			return;
+
+		if(func.contextType != ~0u)
+			SavePointer(ctx, (char*)&fPtr->context);
+	}
+
+	void SaveVariable(SaveContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		const ExternTypeInfo *realType = &type;
+
+		if(type.typeFlags & ExternTypeInfo::TYPE_IS_EXTENDABLE)
+			realType = &NULLC::commonLinker->exTypes[*(int*)ptr];
+
+		if(!realType->pointerCount)
+			return;
+
+		switch(type.subCat)
+		{
+		case ExternTypeInfo::CAT_NONE:
+			break;
+		case ExternTypeInfo::CAT_ARRAY:
+			SaveArray(ctx, ptr, type);
+			break;
+		case ExternTypeInfo::CAT_POINTER:
+			SavePointer(ctx, ptr);
+			break;
+		case ExternTypeInfo::CAT_FUNCTION:
+			SaveFunction(ctx, ptr);
+			break;
+		case ExternTypeInfo::CAT_CLASS:
+			SaveClass(ctx, ptr, *realType);
+			break;
+		}
+	}
+
+	void WriteUnsigned(FastVector<char> &image, unsigned value)
+	{
+		image.push_back((const char*)&value, sizeof(value));
+	}
+
+	bool ReadUnsigned(const char *&pos, const char *end, unsigned &value)
+	{
+		if(unsigned(end - pos) < sizeof(value))
+			return false;
+
+		memcpy(&value, pos, sizeof(value));
+		pos += sizeof(value);
+
+		return true;
+	}
+}
+
+bool SaveProgramImageData(FastVector<char> &image, char *globals, unsigned globalSize, const char* &error)
+{
+	using namespace ProgramImage;
+
+	SaveContext ctx(globals, globalSize);
+
+	ExternVarInfo *vars = NULLC::commonLinker->exVariables.data;
+	ExternTypeInfo *types = NULLC::commonLinker->exTypes.data;
+
+	for(unsigned i = 0; i < NULLC::commonLinker->exVariables.size(); i++)
+		SaveVariable(ctx, globals + vars[i].offset, types[vars[i].type]);
+
+	// Objects found on the way are appended to the list
+	for(unsigned i = 0; i < ctx.objects.size(); i++)
+	{
+		char *base = ctx.objects[i];
+
+		ctx.regionBase = base;
+		ctx.regionIndex = i + 1;
+
+		markerType marker = *(markerType*)(base - sizeof(markerType));
+
+		const ExternTypeInfo &type = types[unsigned(marker >> 8)];
+
+		if(marker & OBJECT_ARRAY)
+		{
+			unsigned arrayPadding = type.defaultAlign > 4 ? type.defaultAlign : 4;
+
+			char *elements = base + arrayPadding;
+
+			unsigned size;
+			memcpy(&size, elements - sizeof(unsigned), sizeof(unsigned));
+
+			SaveArrayElements(ctx, elements, size, type);
+		}
+		else if(type.subCat != ExternTypeInfo::CAT_NONE)
+		{
+			SaveVariable(ctx, base, type);
+		}
+	}
+
+	if(ctx.external)
+	{
+		error = "ERROR: program image can't be saved with pointers to memory that is not owned by the program";
+		return false;
+	}
+
+	WriteUnsigned(image, globalSize);
+	image.push_back(globals, globalSize);
+
+	WriteUnsigned(image, ctx.objects.size());
+
+	for(unsigned i = 0; i < ctx.objects.size(); i++)
+	{
+		char *base = ctx.objects[i];
+
+		markerType marker = *(markerType*)(base - sizeof(markerType));
+
+		unsigned size = NULLC::GetObjectSize(base);
+
+		WriteUnsigned(image, unsigned(marker >> 8));
+		WriteUnsigned(image, unsigned(marker & (OBJECT_FINALIZABLE | OBJECT_FINALIZED | OBJECT_ARRAY)));
+		WriteUnsigned(image, size);
+
+		image.push_back(base, size);
+	}
+
+	WriteUnsigned(image, ctx.fixups.size());
+	image.push_back((const char*)ctx.fixups.data, ctx.fixups.size() * sizeof(Fixup));
+
+	error = NULL;
+
+	return true;
+}
+
+bool LoadProgramImageData(const char *&pos, const char *end, char *globals, unsigned globalSize, const char* &error)
+{
+	using namespace ProgramImage;
+
+	error = "ERROR: program image is corrupted";
+
+	unsigned imageGlobalSize = 0;
+
+	if(!ReadUnsigned(pos, end, imageGlobalSize) || imageGlobalSize != globalSize || unsigned(end - pos) < globalSize)
+		return false;
+
+	const char *globalData = pos;
+	pos += globalSize;
+
+	unsigned objectCount = 0;
+
+	if(!ReadUnsigned(pos, end, objectCount))
+		return false;
+
+	struct ObjectInfo
+	{
+		unsigned type;
+		unsigned flags;
+		unsigned size;
+
+		const char *data;
+	};
+
+	FastVector<ObjectInfo> objectInfos;
+
+	ExternTypeInfo *types = NULLC::commonLinker->exTypes.data;
+	unsigned typeCount = NULLC::commonLinker->exTypes.size();
+
+	// Whole image is validated before global variables are replaced
+	for(unsigned i = 0; i < objectCount; i++)
+	{
+		ObjectInfo info;
+
+		if(!ReadUnsigned(pos, end, info.type) || !ReadUnsigned(pos, end, info.flags) || !ReadUnsigned(pos, end, info.size) || unsigned(end - pos) < info.size || info.type >= typeCount)
+			return false;
+
+		if(info.flags & ~unsigned(OBJECT_FINALIZABLE | OBJECT_FINALIZED | OBJECT_ARRAY))
+			return false;
+
+		// Finalizable flag is set by the allocation, it has to match the type of the object
+		bool finalizable = info.type && (types[info.type].typeFlags & ExternTypeInfo::TYPE_HAS_FINALIZER);
+
+		if(finalizable != ((info.flags & OBJECT_FINALIZABLE) != 0))
+			return false;
+
+		info.data = pos;
+		pos += info.size;
+
+		objectInfos.push_back(info);
+	}
+
+	unsigned fixupCount = 0;
+
+	if(!ReadUnsigned(pos, end, fixupCount) || unsigned(end - pos) / sizeof(Fixup) < fixupCount)
+		return false;
+
+	const char *fixupData = pos;
+
+	for(unsigned i = 0; i < fixupCount; i++)
+	{
+		Fixup fixup;
+		memcpy(&fixup, pos, sizeof(Fixup));
+		pos += sizeof(Fixup);
+
+		if(fixup.sourceObject > objectCount || fixup.targetObject > objectCount)
+			return false;
+
+		unsigned sourceSize = fixup.sourceObject ? objectInfos[fixup.sourceObject - 1].size : globalSize;
+		unsigned targetSize = fixup.targetObject ? objectInfos[fixup.targetObject - 1].size : globalSize;
+
+		if(fixup.sourceOffset > sourceSize || sourceSize - fixup.sourceOffset < sizeof(void*) || fixup.targetOffset > targetSize)
+			return false;
+	}
+
+	if(pos != end)
+		return false;
+
+	FastVector<char*> objects;
+
+	// Collection can't run until all pointers are restored
+	NULLC::SetCollectMemory(false);
+
+	for(unsigned i = 0; i < objectCount; i++)
+	{
+		ObjectInfo &info = objectInfos[i];
+
+		char *base = (char*)NULLC::AllocTypedObject(info.size, info.type, (info.flags & OBJECT_ARRAY) != 0);
+
+		if(!base)
+		{
+			NULLC::SetCollectMemory(true);
+
+			error = "ERROR: failed to allocate program image object";
+			return false;
+		}
+
+		memcpy(base, info.data, info.size);
+
+		*(markerType*)(base - sizeof(markerType)) |= info.flags & OBJECT_FINALIZED;
+
+		objects.push_back(base);
+	}
+
+	NULLC::SetCollectMemory(true);
+
+	memcpy(globals, globalData, globalSize);
+
+	for(unsigned i = 0; i < fixupCount; i++)
+	{
+		Fixup fixup;
+		memcpy(&fixup, fixupData + i * sizeof(Fixup), sizeof(Fixup));
+
+		char *source = fixup.sourceObject ? objects[fixup.sourceObject - 1] : globals;
+		char *target = (fixup.targetObject ? objects[fixup.targetObject - 1] : globals) + fixup.targetOffset;
+
+		memcpy(source + fixup.sourceOffset, &target, sizeof(void*));
+	}
+
+	error = NULL;
+
+	return true;
+}
+
+namespace RelinkCheck
+{
+	unsigned int	typeidName = NULLC::GetStringHash("typeid");
+
+	struct CheckContext
+	{
+		CheckContext(char *globals, unsigned globalSize, unsigned keptGlobalSize, unsigned keptTypeCount, unsigned keptFunctionCount): globals(globals), globalSize(globalSize), keptGlobalSize(keptGlobalSize), keptTypeCount(keptTypeCount), keptFunctionCount(keptFunctionCount)
+		{
+			objectMap.init();
+
+			keptData = true;
+			found = false;
+		}
+
+		char *globals;
+		unsigned globalSize;
+
+		unsigned keptGlobalSize;
+		unsigned keptTypeCount;
+		unsigned keptFunctionCount;
+
+		FastVector<char*> objects;
+		HashMap<unsigned> objectMap;
+
+		// Data that is reachable from the kept global variables can't reference anything that is unlinked
+		// Other objects are released after relink and only their finalizers have to belong to the kept types
+		bool keptData;
+
+		bool found;
+	};
+
+	bool IsUnlinkedType(CheckContext &ctx, unsigned typeId)
+	{
+		if(typeId >= ctx.keptTypeCount)
+			ctx.found = true;
+
+		return ctx.found;
+	}
+
+	void CheckVariable(CheckContext &ctx, char* ptr, const ExternTypeInfo& type);
+
+	void CheckPointer(CheckContext &ctx, char* ptr)
+	{
+		char *target = GC::ReadVmMemoryPointer(ptr);
+
+		// Range of 0x00000000-0x00010000 contains upvalue offsets inside closures
+		if(target <= (char*)0x00010000)
+			return;
+
+		if(target >= ctx.globals && target <= ctx.globals + ctx.globalSize)
+		{
+			if(ctx.keptData && target >= ctx.globals + ctx.keptGlobalSize)
+				ctx.found = true;
+
+			return;
+		}
+
+		char *base = (char*)NULLC::GetBasePointer(target);
+
+		if(!base)
+			return;
+
+		unsigned hash = NULLC::GetStringHash((const char*)&base, (const char*)&base + sizeof(base));
+
+		for(HashMap<unsigned>::Node *curr = ctx.objectMap.first(hash); curr; curr = ctx.objectMap.next(curr))
+		{
+			if(ctx.objects[curr->value] == base)
+				return;
+		}
+
+		ctx.objects.push_back(base);
+		ctx.objectMap.insert(hash, ctx.objects.size() - 1);
+
+		markerType marker = *(markerType*)(base - sizeof(markerType));
+
+		if(ctx.keptData || ((marker & OBJECT_FINALIZABLE) && !(marker & OBJECT_FINALIZED)))
+			IsUnlinkedType(ctx, unsigned(marker >> 8));
+	}
+
+	void CheckArrayElements(CheckContext &ctx, char* ptr, unsigned size, const ExternTypeInfo& elementType)
+	{
+		if(!elementType.pointerCount && (!ctx.keptData || (elementType.subCat == ExternTypeInfo::CAT_NONE && elementType.nameHash != typeidName)))
+			return;
+
+		for(unsigned i = 0; i < size && !ctx.found; i++, ptr += elementType.size)
+			CheckVariable(ctx, ptr, elementType);
+	}
+
+	void CheckArray(CheckContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		if(type.arrSize == ~0u)
+		{
+			NULLCArray *data = (NULLCArray*)ptr;
+
+			if(data->ptr)
+				CheckPointer(ctx, (char*)&data->ptr);
+		}
+		else
+		{
+			CheckArrayElements(ctx, ptr, type.arrSize, NULLC::commonLinker->exTypes[type.subType]);
+		}
+	}
+
+	void CheckClass(CheckContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		if(type.nameHash == GC::objectName)
+		{
+			NULLCRef *data = (NULLCRef*)ptr;
+
+			if(data->ptr && (!ctx.keptData || !IsUnlinkedType(ctx, data->typeID)))
+				CheckPointer(ctx, (char*)&data->ptr);
+		}
+		else if(type.nameHash == GC::autoArrayName)
+		{
+			NULLCAutoArray *data = (NULLCAutoArray*)ptr;
+
+			if(data->ptr && (!ctx.keptData || !IsUnlinkedType(ctx, data->typeID)))
+				CheckPointer(ctx, (char*)&data->ptr);
+		}
+		else if(ctx.keptData)
+		{
+			ExternMemberInfo *memberList = &NULLC::commonLinker->exTypeExtra[type.memberOffset];
+
+			for(unsigned n = 0; n < type.memberCount && !ctx.found; n++)
+				CheckVariable(ctx, ptr + memberList[n].offset, NULLC::commonLinker->exTypes[memberList[n].type]);
+		}
+		else
+		{
+			ExternMemberInfo *memberList = type.pointerCount ? &NULLC::commonLinker->exTypeExtra[type.memberOffset + type.memberCount] : NULL;
+
+			for(unsigned n = 0; n < type.pointerCount && !ctx.found; n++)
+				CheckVariable(ctx, ptr + memberList[n].offset, NULLC::commonLinker->exTypes[memberList[n].type]);
+		}
+	}
+
+	void CheckFunction(CheckContext &ctx, char* ptr)
+	{
+		NULLCFuncPtr *fPtr = (NULLCFuncPtr*)ptr;
+
+		if(ctx.keptData && unsigned(fPtr->id) >= ctx.keptFunctionCount)
+		{
+			ctx.found = true;
+			return;
+		}
+
+		if(!fPtr->context || unsigned(fPtr->id) >= NULLC::commonLinker->exFunctions.size())
+			return;
+
+		const ExternFuncInfo &func = NULLC::commonLinker->exFunctions[fPtr->id];
+
+		if(func.regVmAddress == -1)
+			return;
+
+		if(func.contextType != ~0u)
+			CheckPointer(ctx, (char*)&fPtr->context);
+	}
+
+	void CheckVariable(CheckContext &ctx, char* ptr, const ExternTypeInfo& type)
+	{
+		const ExternTypeInfo *realType = &type;
+
+		if(type.typeFlags & ExternTypeInfo::TYPE_IS_EXTENDABLE)
+		{
+			if(ctx.keptData && IsUnlinkedType(ctx, *(unsigned*)ptr))
+				return;
+
+			realType = &NULLC::commonLinker->exTypes[*(int*)ptr];
+		}
+
+		if(!realType->pointerCount && !ctx.keptData)
+			return;
+
+		switch(type.subCat)
+		{
+		case ExternTypeInfo::CAT_NONE:
+			if(type.nameHash == typeidName && ctx.keptData)
+				IsUnlinkedType(ctx, *(unsigned*)ptr);
+			break;
+		case ExternTypeInfo::CAT_ARRAY:
+			CheckArray(ctx, ptr, type);
+			break;
+		case ExternTypeInfo::CAT_POINTER:
+			CheckPointer(ctx, ptr);
+			break;
+		case ExternTypeInfo::CAT_FUNCTION:
+			CheckFunction(ctx, ptr);
+			break;
+		case ExternTypeInfo::CAT_CLASS:
+			CheckClass(ctx, ptr, *realType);
+			break;
+		}
+	}
+
+	void CheckObjects(CheckContext &ctx, unsigned start)
+	{
+		ExternTypeInfo *types = NULLC::commonLinker->exTypes.data;
+
+		// Objects found on the way are appended to the list
+		for(unsigned i = start; i < ctx.objects.size() && !ctx.found; i++)
+		{
+			char *base = ctx.objects[i];
+
+			markerType marker = *(markerType*)(base - sizeof(markerType));
+
+			const ExternTypeInfo &type = types[unsigned(marker >> 8)];
+
+			if(marker & OBJECT_ARRAY)
+			{
+				unsigned arrayPadding = type.defaultAlign > 4 ? type.defaultAlign : 4;
+
+				char *elements = base + arrayPadding;
+
+				unsigned size;
+				memcpy(&size, elements - sizeof(unsigned), sizeof(unsigned));
+
+				CheckArrayElements(ctx, elements, size, type);
+			}
+			else if(type.subCat != ExternTypeInfo::CAT_NONE || ctx.keptData)
+			{
+				CheckVariable(ctx, base, type);
+			}
+		}
+	}
+}
+
+bool HasUnlinkedReferences(char *globals, unsigned globalSize, unsigned keptVariableCount, unsigned keptGlobalSize, unsigned keptTypeCount, unsigned keptFunctionCount)
+{
+	using namespace RelinkCheck;
+
+	CheckContext ctx(globals, globalSize, keptGlobalSize, keptTypeCount, keptFunctionCount);
+
+	ExternVarInfo *vars = NULLC::commonLinker->exVariables.data;
+	ExternTypeInfo *types = NULLC::commonLinker->exTypes.data;
+
+	for(unsigned i = 0; i < keptVariableCount && !ctx.found; i++)
+		CheckVariable(ctx, globals + vars[i].offset, types[vars[i].type]);
+
+	CheckObjects(ctx, 0);
+
+	// Objects that are only reachable from the unlinked global variables are checked for the finalizers
+	unsigned keptObjectCount = ctx.objects.size();
+
+	ctx.keptData = false;
+
+	for(unsigned i = keptVariableCount; i < NULLC::commonLinker->exVariables.size() && !ctx.found; i++)
+		CheckVariable(ctx, globals + vars[i].offset, types[vars[i].type]);
+
+	CheckObjects(ctx, keptObjectCount);
+
+	return ctx.found;
 }
 
 namespace
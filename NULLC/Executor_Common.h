@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Array.h"
+
 class Linker;
 
 struct ExternTypeInfo;
@@ -37,9 +39,19 @@ namespace GC
 	int IsPointerUnmanaged(NULLCRef ptr);
 	void MarkUsedBlocks();
 	void MarkPendingRoots();
+	unsigned MarkedObjectCount();
 	void ResetGC();
 }
 
+// Program image
+
+bool SaveProgramImageData(FastVector<char> &image, char *globals, unsigned globalSize, const char* &error);
+bool LoadProgramImageData(const char *&pos, const char *end, char *globals, unsigned globalSize, const char* &error);
+
+// Relink
+
+bool HasUnlinkedReferences(char *globals, unsigned globalSize, unsigned keptVariableCount, unsigned keptGlobalSize, unsigned keptTypeCount, unsigned keptFunctionCount);
+
 #if !defined(NULLC_NO_RAW_EXTERNAL_CALL)
 typedef struct DCCallVM_ DCCallVM;
 
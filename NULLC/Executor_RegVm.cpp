@@ -87,9 +87,13 @@ ExecutorRegVm::~ExecutorRegVm()
 {
 	NULLC::dealloc(execErrorBuffer);
 
-	NULLC::dealloc(tempStackArrayBase);
+	// Data stack storage is owned by the executor
+	NULLC::deallocPages(dataStack.data, dataStack.max);
+	dataStack.data = NULL;
 
-	NULLC::dealloc(regFileArrayBase);
+	NULLC::deallocPages(tempStackArrayBase, sizeof(unsigned) * 1024 * 16);
+
+	NULLC::deallocPages(regFileArrayBase, sizeof(RegVmRegister) * 1024 * 32);
 
 #if !defined(NULLC_NO_RAW_EXTERNAL_CALL)
 	if(dcCallVM)
@@ -105,9 +109,13 @@ void ExecutorRegVm::InitExecution()
 
 	CommonSetLinker(exLinker);
 
-	dataStack.reserve(minStackSize);
+	unsigned globalSize = (exLinker->globalVarSize + 0xf) & ~0xf;
+
+	// Global variables are placed at the start of the stack, leave the full stack size after them if they don't fit
+	ReserveDataStack(globalSize < minStackSize ? minStackSize : globalSize + minStackSize);
+
 	dataStack.clear();
-	dataStack.resize((exLinker->globalVarSize + 0xf) & ~0xf);
+	dataStack.resize(globalSize);
 
 	GC::SetUnmanagableRange(dataStack.data, dataStack.max);
 
@@ -126,15 +134,13 @@ void ExecutorRegVm::InitExecution()
 
 	if(!tempStackArrayBase)
 	{
-		tempStackArrayBase = (unsigned*)NULLC::alloc(sizeof(unsigned) * 1024 * 16);
-		memset(tempStackArrayBase, 0, sizeof(unsigned) * 1024 * 16);
+		tempStackArrayBase = (unsigned*)NULLC::allocPages(sizeof(unsigned) * 1024 * 16);
 		tempStackArrayEnd = tempStackArrayBase + 1024 * 16;
 	}
 
 	if(!regFileArrayBase)
 	{
-		regFileArrayBase = (RegVmRegister*)NULLC::alloc(sizeof(RegVmRegister) * 1024 * 32);
-		memset(regFileArrayBase, 0, sizeof(RegVmRegister) * 1024 * 32);
+		regFileArrayBase = (RegVmRegister*)NULLC::allocPages(sizeof(RegVmRegister) * 1024 * 32);
 		regFileArrayEnd = regFileArrayBase + 1024 * 32;
 	}
 
@@ -272,9 +278,11 @@ bool ExecutorRegVm::Run(unsigned functionID, const char *arguments)
 	}
 	else
 	{
-		// If global code is executed, reset all global variables
+		// If global code is executed, reset all global variables except for the ones kept by module relink
 		assert(dataStack.size() >= exLinker->globalVarSize);
-		memset(dataStack.data, 0, exLinker->globalVarSize);
+		memset(dataStack.data + exLinker->keptGlobalVarSize, 0, exLinker->globalVarSize - exLinker->keptGlobalVarSize);
+
+		instruction = &exLinker->exRegVmCode[exLinker->keptRegVmCodeSize];
 
 		regFilePtr[rvrrGlobals].ptrValue = uintptr_t(dataStack.data);
 		regFilePtr[rvrrFrame].ptrValue = uintptr_t(dataStack.data);
@@ -409,6 +417,25 @@ void ExecutorRegVm::Resume()
 	execErrorObject.ptr = NULL;
 }
 
+void ExecutorRegVm::ReserveDataStack(unsigned size)
+{
+	if(size <= dataStack.max)
+		return;
+
+	// Stack is reserved from the system when page allocation is enabled, kept global variables are moved to the new storage
+	char *data = (char*)NULLC::allocPages(size);
+
+	if(dataStack.data)
+	{
+		memcpy(data, dataStack.data, dataStack.max);
+
+		NULLC::deallocPages(dataStack.data, dataStack.max);
+	}
+
+	dataStack.data = data;
+	dataStack.max = size;
+}
+
 bool ExecutorRegVm::SetStackSize(unsigned bytes)
 {
 	if(codeRunning)
@@ -524,6 +551,7 @@ RegVmReturnType ExecutorRegVm::RunCode(RegVmCmd *instruction, RegVmRegister * co
 		&&case_rviLogNot,
 		&&case_rviLogNotl,
 		&&case_rviConvertPtr,
+		&&case_rviNewObject,
 	};
 
 #define SWITCH goto *switchTable[instruction->code];
@@ -1210,6 +1238,14 @@ RegVmReturnType ExecutorRegVm::RunCode(RegVmCmd *instruction, RegVmRegister * co
 			if(!rvm->ExecConvertPtr(cmd, instruction, regFilePtr))
 				return rvrError;
 
+			instruction++;
+			BREAK;
+		CASE(rviNewObject)
+			if(void *ptr = NULLC::AllocObjectFast((cmd.rB << 8) | cmd.rC, cmd.argument))
+				regFilePtr[cmd.rA].ptrValue = uintptr_t(ptr);
+			else if(!rvm->ExecNewObject(cmd, instruction, regFilePtr))
+				return rvrError;
+
 			instruction++;
 			BREAK;
 #if !defined(USE_COMPUTED_GOTO)
@@ -1649,6 +1685,22 @@ bool ExecutorRegVm::ExecConvertPtr(const RegVmCmd cmd, RegVmCmd * const instruct
 	return true;
 }
 
+bool ExecutorRegVm::ExecNewObject(const RegVmCmd cmd, RegVmCmd * const instruction, RegVmRegister * const regFilePtr)
+{
+	callStack.push_back(instruction + 1);
+
+	void *ptr = NULLC::AllocObject((cmd.rB << 8) | cmd.rC, cmd.argument);
+
+	if(!callContinue)
+		return false;
+
+	callStack.pop_back();
+
+	regFilePtr[cmd.rA].ptrValue = uintptr_t(ptr);
+
+	return true;
+}
+
 void ExecutorRegVm::ExecCheckedReturn(unsigned typeId, RegVmRegister * const regFilePtr)
 {
 	uintptr_t frameBase = regFilePtr[rvrrFrame].ptrValue;
@@ -1743,6 +1795,15 @@ char* ExecutorRegVm::GetVariableData(unsigned *count)
 	return dataStack.data;
 }
 
+char* ExecutorRegVm::InitVariableData()
+{
+	InitExecution();
+
+	memset(dataStack.data, 0, exLinker->globalVarSize);
+
+	return dataStack.data;
+}
+
 unsigned ExecutorRegVm::GetCallStackAddress(unsigned frame)
 {
 	if(frame >= callStack.size())
@@ -36,6 +36,9 @@ public:
 
 	char*		GetVariableData(unsigned *count);
 
+	// Prepares global variable storage of a restored program image without running global code
+	char*		InitVariableData();
+
 	unsigned	GetCallStackAddress(unsigned frame);
 
 	void*		GetStackStart();
@@ -50,6 +53,7 @@ public:
 
 private:
 	void	InitExecution();
+	void	ReserveDataStack(unsigned size);
 
 	bool	codeRunning;
 
@@ -109,6 +113,7 @@ private:
 	bool ExecCall(unsigned microcodePos, unsigned functionId, RegVmCmd * const instruction, RegVmRegister * const regFilePtr);
 	RegVmReturnType ExecReturn(const RegVmCmd cmd, RegVmCmd * const instruction, RegVmRegister * const regFilePtr);
 	bool ExecConvertPtr(const RegVmCmd cmd, RegVmCmd * const instruction, RegVmRegister * const regFilePtr);
+	bool ExecNewObject(const RegVmCmd cmd, RegVmCmd * const instruction, RegVmRegister * const regFilePtr);
 	void ExecCheckedReturn(unsigned typeId, RegVmRegister * const regFilePtr);
 
 	RegVmReturnType ExecError(RegVmCmd * const instruction, const char *errorMessage);
@@ -381,7 +381,7 @@ namespace NULLC
 	}
 
 	typedef void (*codegenCallback)(CodeGenRegVmContext &ctx, RegVmCmd);
-	codegenCallback cgFuncs[rviConvertPtr + 1];
+	codegenCallback cgFuncs[rviNewObject + 1];
 }
 
 ExecutorX86::ExecutorX86(Linker *linker): exLinker(linker), exTypes(linker->exTypes), exFunctions(linker->exFunctions), exRegVmCode(linker->exRegVmCode), exRegVmConstants(linker->exRegVmConstants), exRegVmRegKillInfo(linker->exRegVmRegKillInfo)
@@ -438,13 +438,13 @@ ExecutorX86::~ExecutorX86()
 	NULLC::AllowMemoryPageRead(vmState.dataStackEnd);
 	NULLC::AllowMemoryPageRead(vmState.regFileArrayEnd);
 
-	NULLC::dealloc(vmState.dataStackBase);
+	NULLC::deallocPages(vmState.dataStackBase, unsigned(vmState.dataStackEnd - vmState.dataStackBase) + 8192);
 
-	NULLC::dealloc(vmState.callStackBase);
+	NULLC::deallocPages(vmState.callStackBase, sizeof(CodeGenRegVmCallStackEntry) * 1024 * 2 + 8192);
 
-	NULLC::dealloc(vmState.tempStackArrayBase);
+	NULLC::deallocPages(vmState.tempStackArrayBase, sizeof(unsigned) * 1024 * 16);
 
-	NULLC::dealloc(vmState.regFileArrayBase);
+	NULLC::deallocPages(vmState.regFileArrayBase, sizeof(RegVmRegister) * 1024 * 32 + 8192);
 
 #if !defined(NULLC_NO_RAW_EXTERNAL_CALL)
 	if(dcCallVM)
@@ -575,6 +575,7 @@ bool ExecutorX86::Initialize()
 	cgFuncs[rviLogNot] = GenCodeCmdLogNot;
 	cgFuncs[rviLogNotl] = GenCodeCmdLogNotl;
 	cgFuncs[rviConvertPtr] = GenCodeCmdConvertPtr;
+	cgFuncs[rviNewObject] = GenCodeCmdNewObject;
 
 	// Create code launch header
 	unsigned char *pos = codeLaunchHeader;
@@ -739,29 +740,25 @@ bool ExecutorX86::Initialize()
 
 	if(!vmState.callStackBase)
 	{
-		vmState.callStackBase = (CodeGenRegVmCallStackEntry*)NULLC::alloc(sizeof(CodeGenRegVmCallStackEntry) * 1024 * 2 + 8192); // Two extra pages for page guard
-		memset(vmState.callStackBase, 0, sizeof(CodeGenRegVmCallStackEntry) * 1024 * 2);
+		vmState.callStackBase = (CodeGenRegVmCallStackEntry*)NULLC::allocPages(sizeof(CodeGenRegVmCallStackEntry) * 1024 * 2 + 8192); // Two extra pages for page guard
 		vmState.callStackEnd = vmState.callStackBase + 1024 * 2;
 	}
 
 	if(!vmState.tempStackArrayBase)
 	{
-		vmState.tempStackArrayBase = (unsigned*)NULLC::alloc(sizeof(unsigned) * 1024 * 16);
-		memset(vmState.tempStackArrayBase, 0, sizeof(unsigned) * 1024 * 16);
+		vmState.tempStackArrayBase = (unsigned*)NULLC::allocPages(sizeof(unsigned) * 1024 * 16);
 		vmState.tempStackArrayEnd = vmState.tempStackArrayBase + 1024 * 16;
 	}
 
 	if(!vmState.dataStackBase)
 	{
-		vmState.dataStackBase = (char*)NULLC::alloc(sizeof(char) * minStackSize + 8192); // Two extra pages for page guard
-		memset(vmState.dataStackBase, 0, sizeof(char) * minStackSize);
+		vmState.dataStackBase = (char*)NULLC::allocPages(sizeof(char) * minStackSize + 8192); // Two extra pages for page guard
 		vmState.dataStackEnd = vmState.dataStackBase + minStackSize;
 	}
 
 	if(!vmState.regFileArrayBase)
 	{
-		vmState.regFileArrayBase = (RegVmRegister*)NULLC::alloc(sizeof(RegVmRegister) * 1024 * 32 + 8192); // Two extra pages for page guard
-		memset(vmState.regFileArrayBase, 0, sizeof(RegVmRegister) * 1024 * 32);
+		vmState.regFileArrayBase = (RegVmRegister*)NULLC::allocPages(sizeof(RegVmRegister) * 1024 * 32 + 8192); // Two extra pages for page guard
 		vmState.regFileArrayEnd = vmState.regFileArrayBase + 1024 * 32;
 	}
 
@@ -955,9 +952,13 @@ bool ExecutorX86::Run(unsigned int functionID, const char *arguments)
 	}
 	else
 	{
-		// If global code is executed, reset all global variables
+		// If global code is executed, reset all global variables except for the ones kept by module relink
 		assert(unsigned(vmState.dataStackTop - vmState.dataStackBase) >= exLinker->globalVarSize);
-		memset(vmState.dataStackBase, 0, exLinker->globalVarSize);
+		memset(vmState.dataStackBase + exLinker->keptGlobalVarSize, 0, exLinker->globalVarSize - exLinker->keptGlobalVarSize);
+
+		// Global code of the relinked modules is entered directly, skipping the jump that closes the global code frame of the kept modules
+		if(exLinker->keptRegVmCodeSize)
+			instructionPos = exRegVmCode[exLinker->keptRegVmCodeSize].argument;
 
 		regFilePtr[rvrrGlobals].ptrValue = uintptr_t(vmState.dataStackBase);
 		regFilePtr[rvrrFrame].ptrValue = uintptr_t(vmState.dataStackBase);
@@ -1193,14 +1194,13 @@ bool ExecutorX86::SetStackSize(unsigned bytes)
 	if(codeRunning || !instList.empty())
 		return false;
 
-	minStackSize = bytes;
-
 	NULLC::AllowMemoryPageRead(vmState.dataStackEnd);
 
-	NULLC::dealloc(vmState.dataStackBase);
+	NULLC::deallocPages(vmState.dataStackBase, unsigned(vmState.dataStackEnd - vmState.dataStackBase) + 8192);
 
-	vmState.dataStackBase = (char*)NULLC::alloc(sizeof(char) * minStackSize + 8192); // Two extra pages for page guard
-	memset(vmState.dataStackBase, 0, sizeof(char) * minStackSize);
+	minStackSize = bytes;
+
+	vmState.dataStackBase = (char*)NULLC::allocPages(sizeof(char) * minStackSize + 8192); // Two extra pages for page guard
 	vmState.dataStackEnd = vmState.dataStackBase + minStackSize;
 
 	NULLC::DenyMemoryPageRead(vmState.dataStackEnd);
@@ -1271,6 +1271,42 @@ void ExecutorX86::ClearNative()
 	codeRunning = false;
 }
 
+void ExecutorX86::TruncateNative()
+{
+	// Linker has removed the code of unlinked modules, native code translated for it is dropped
+	unsigned instructionCount = exRegVmCode.size();
+
+	if(instructionCount == 0 || binCodeSize == 0)
+	{
+		ClearNative();
+		return;
+	}
+
+	if(instructionCount >= lastInstructionCount)
+		return;
+
+	// Keep space for the final global return sequence that the next translation expects to overwrite
+#if defined(_M_X64)
+	binCodeSize = unsigned(instAddress[instructionCount] - binCode) + 10;
+#else
+	binCodeSize = unsigned(instAddress[instructionCount] - binCode) + 8;
+#endif
+
+	lastInstructionCount = instructionCount;
+
+	while(!globalCodeRanges.empty() && globalCodeRanges.back() >= instructionCount)
+		globalCodeRanges.pop_back();
+
+	if(globalCodeRanges.size() % 2 != 0)
+		globalCodeRanges.push_back(instructionCount);
+
+	oldJumpTargetCount = exLinker->regVmJumpTargets.size();
+	oldRegKillInfoCount = exRegVmRegKillInfo.size();
+	oldFunctionSize = exFunctions.size();
+
+	functionAddress.shrink(oldFunctionSize);
+}
+
 bool ExecutorX86::TranslateToNative(bool enableLogFiles, OutputContext &output)
 {
 	if(instList.size())
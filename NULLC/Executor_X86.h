@@ -32,6 +32,7 @@ public:
 	bool	Initialize();
 
 	void	ClearNative();
+	void	TruncateNative();
 	bool	TranslateToNative(bool enableLogFiles, OutputContext &output);
 	void	UpdateFunctionPointer(unsigned source, unsigned target);
 	void	SaveListing(OutputContext &output);
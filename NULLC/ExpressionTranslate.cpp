@@ -933,6 +933,26 @@ void TranslateMemberAccess(ExpressionTranslateContext &ctx, ExprMemberAccess *ex
 
 void TranslateArrayIndex(ExpressionTranslateContext &ctx, ExprArrayIndex *expression)
 {
+	if(ctx.vectorLoopIndex)
+	{
+		ExprVariableAccess *value = getType<ExprVariableAccess>(expression->value);
+		ExprVariableAccess *index = getType<ExprVariableAccess>(expression->index);
+
+		if(value && index && index->variable == ctx.vectorLoopIndex)
+		{
+			for(unsigned i = 0; i < ctx.vectorLoopArrays.size(); i++)
+			{
+				if(ctx.vectorLoopArrays[i] == value->variable)
+				{
+					Print(ctx, "(__nullcVector%d + ", ctx.vectorLoopArrayIds[i]);
+					TranslateVariableName(ctx, index->variable);
+					Print(ctx, ")");
+					return;
+				}
+			}
+		}
+	}
+
 	if(TypeUnsizedArray *typeUnsizedArray = getType<TypeUnsizedArray>(expression->value->type))
 	{
 		Print(ctx, "__nullcIndexUnsizedArray(");
@@ -1668,18 +1688,570 @@ void TranslateIfElse(ExpressionTranslateContext &ctx, ExprIfElse *expression)
 	}
 }
 
-void TranslateFor(ExpressionTranslateContext &ctx, ExprFor *expression)
+bool IsVectorLoopLocal(ExpressionTranslateContext &ctx, VariableData *variable)
+{
+	if(!ctx.currentFunction || ctx.currentFunction->coroutine)
+		return false;
+
+	if(variable->usedAsExternal || variable->lookupOnly)
+		return false;
+
+	for(ScopeData *scope = variable->scope; scope; scope = scope->scope)
+	{
+		if(scope->ownerFunction)
+			return scope->ownerFunction == ctx.currentFunction;
+
+		if(scope->ownerType || scope->ownerNamespace || scope == ctx.ctx.globalScope)
+			return false;
+	}
+
+	return false;
+}
+
+bool IsVectorLoopElementType(ExpressionTranslateContext &ctx, TypeBase *type)
+{
+	ExpressionContext &exprCtx = ctx.ctx;
+
+	// Element size in C++ has to match the element size in nullc
+	return type == exprCtx.typeBool || type == exprCtx.typeChar || type == exprCtx.typeShort || type == exprCtx.typeInt || type == exprCtx.typeLong || type == exprCtx.typeFloat || type == exprCtx.typeDouble;
+}
+
+VariableData* GetVectorLoopArraySize(ExpressionTranslateContext &ctx, ExprBase *expression)
+{
+	// Matches 'arr.size' of a local unsized array
+	if(ExprPassthrough *node = getType<ExprPassthrough>(expression))
+		expression = node->value;
+
+	ExprDereference *dereference = getType<ExprDereference>(expression);
+
+	if(!dereference)
+		return NULL;
+
+	ExprMemberAccess *memberAccess = getType<ExprMemberAccess>(dereference->value);
+
+	if(!memberAccess || memberAccess->member->variable->name->name != InplaceStr("size"))
+		return NULL;
+
+	ExprGetAddress *address = getType<ExprGetAddress>(memberAccess->value);
+
+	if(!address || !isType<TypeUnsizedArray>(address->variable->variable->type) || !IsVectorLoopLocal(ctx, address->variable->variable))
+		return NULL;
+
+	return address->variable->variable;
+}
+
+struct VectorLoopInfo
+{
+	VectorLoopInfo(ExpressionTranslateContext &ctx): ctx(ctx), arrays(ctx.allocator), arrayWrites(ctx.allocator), sizeAddresses(ctx.allocator), addressVariables(ctx.allocator), safeReferences(ctx.allocator), directAddresses(ctx.allocator)
+	{
+		index = NULL;
+		boundVariable = NULL;
+		boundArray = NULL;
+
+		invalid = false;
+		restrictSafe = true;
+		addressTaken = false;
+	}
+
+	ExpressionTranslateContext &ctx;
+
+	VariableData *index;
+	VariableData *boundVariable;
+	VariableData *boundArray;
+
+	SmallArray<VariableData*, 8> arrays;
+	SmallArray<bool, 8> arrayWrites;
+
+	SmallArray<ExprBase*, 8> sizeAddresses;
+	SmallArray<VariableData*, 8> addressVariables;
+
+	// Body references that point to a local variable or a vectorized array element
+	SmallArray<VariableData*, 8> safeReferences;
+
+	// Addresses in the function that are only used to read or write the variable directly
+	SmallArray<ExprBase*, 8> directAddresses;
+
+	bool invalid;
+	bool restrictSafe;
+	bool addressTaken;
+
+private:
+	VectorLoopInfo(const VectorLoopInfo&);
+	VectorLoopInfo& operator=(const VectorLoopInfo&);
+};
+
+int FindVectorLoopArray(VectorLoopInfo &info, ExprBase *expression)
+{
+	ExprArrayIndex *node = getType<ExprArrayIndex>(expression);
+
+	if(!node)
+		return -1;
+
+	ExprVariableAccess *value = getType<ExprVariableAccess>(node->value);
+	ExprVariableAccess *index = getType<ExprVariableAccess>(node->index);
+
+	if(!value || !index || index->variable != info.index)
+		return -1;
+
+	for(unsigned i = 0; i < info.arrays.size(); i++)
+	{
+		if(info.arrays[i] == value->variable)
+			return int(i);
+	}
+
+	return -1;
+}
+
+bool IsVectorLoopSafeTarget(VectorLoopInfo &info, ExprBase *expression, bool isWrite)
+{
+	if(ExprGetAddress *node = getType<ExprGetAddress>(expression))
+		return IsVectorLoopLocal(info.ctx, node->variable->variable);
+
+	if(ExprVariableAccess *node = getType<ExprVariableAccess>(expression))
+	{
+		for(unsigned i = 0; i < info.safeReferences.size(); i++)
+		{
+			if(info.safeReferences[i] == node->variable)
+				return true;
+		}
+
+		return false;
+	}
+
+	int arrayIndex = FindVectorLoopArray(info, expression);
+
+	if(arrayIndex < 0)
+		return false;
+
+	if(isWrite)
+		info.arrayWrites[arrayIndex] = true;
+
+	return true;
+}
+
+void CollectVectorLoopArrays(void *context, ExprBase *child)
+{
+	VectorLoopInfo &info = *(VectorLoopInfo*)context;
+
+	if(ExprArrayIndex *node = getType<ExprArrayIndex>(child))
+	{
+		ExprVariableAccess *value = getType<ExprVariableAccess>(node->value);
+		ExprVariableAccess *index = getType<ExprVariableAccess>(node->index);
+
+		if(!value || !index || index->variable != info.index)
+			return;
+
+		TypeUnsizedArray *type = getType<TypeUnsizedArray>(value->variable->type);
+
+		if(!type || !IsVectorLoopElementType(info.ctx, type->subType) || !IsVectorLoopLocal(info.ctx, value->variable))
+			return;
+
+		for(unsigned i = 0; i < info.arrays.size(); i++)
+		{
+			if(info.arrays[i] == value->variable)
+				return;
+		}
+
+		info.arrays.push_back(value->variable);
+		info.arrayWrites.push_back(false);
+	}
+}
+
+void CheckVectorLoopBody(void *context, ExprBase *child)
+{
+	VectorLoopInfo &info = *(VectorLoopInfo*)context;
+
+	if(isType<ExprYield>(child) || isType<ExprFunctionDefinition>(child) || isType<ExprGenericFunctionPrototype>(child))
+	{
+		info.invalid = true;
+	}
+	else if(ExprBlock *node = getType<ExprBlock>(child))
+	{
+		ExprSequence *closures = getType<ExprSequence>(node->closures);
+
+		if(closures && !closures->expressions.empty())
+			info.invalid = true;
+	}
+	else if(ExprMemberAccess *node = getType<ExprMemberAccess>(child))
+	{
+		ExprGetAddress *address = getType<ExprGetAddress>(node->value);
+
+		// Reading the array size doesn't modify the array
+		if(address && isType<TypeUnsizedArray>(address->variable->variable->type) && node->member->variable->name->name == InplaceStr("size"))
+			info.sizeAddresses.push_back(address);
+		else
+			info.restrictSafe = false;
+	}
+	else if(ExprGetAddress *node = getType<ExprGetAddress>(child))
+	{
+		for(unsigned i = 0; i < info.sizeAddresses.size(); i++)
+		{
+			if(info.sizeAddresses[i] == child)
+				return;
+		}
+
+		info.addressVariables.push_back(node->variable->variable);
+	}
+	else if(ExprVariableAccess *node = getType<ExprVariableAccess>(child))
+	{
+		if(!IsVectorLoopLocal(info.ctx, node->variable))
+			info.restrictSafe = false;
+	}
+	else if(ExprVariableDefinition *node = getType<ExprVariableDefinition>(child))
+	{
+		ExprAssignment *initializer = getType<ExprAssignment>(node->initializer);
+
+		if(initializer && isType<TypeRef>(node->variable->variable->type) && IsVectorLoopSafeTarget(info, initializer->rhs, true))
+			info.safeReferences.push_back(node->variable->variable);
+	}
+	else if(ExprAssignment *node = getType<ExprAssignment>(child))
+	{
+		// Indirect stores might modify the array or loop variables
+		if(!IsVectorLoopSafeTarget(info, node->lhs, true))
+			info.invalid = true;
+	}
+	else if(ExprPreModify *node = getType<ExprPreModify>(child))
+	{
+		if(!IsVectorLoopSafeTarget(info, node->value, true))
+			info.invalid = true;
+	}
+	else if(ExprPostModify *node = getType<ExprPostModify>(child))
+	{
+		if(!IsVectorLoopSafeTarget(info, node->value, true))
+			info.invalid = true;
+	}
+	else if(ExprDereference *node = getType<ExprDereference>(child))
+	{
+		if(!IsVectorLoopSafeTarget(info, node->value, false))
+			info.restrictSafe = false;
+	}
+	else if(ExprArrayIndex *node = getType<ExprArrayIndex>(child))
+	{
+		if(FindVectorLoopArray(info, node) < 0)
+			info.restrictSafe = false;
+	}
+	else if(isType<ExprFunctionCall>(child) || isType<ExprFunctionContextAccess>(child) || isType<ExprUnboxing>(child))
+	{
+		// Callee might modify the array or loop variables through a reference
+		info.invalid = true;
+	}
+}
+
+bool IsVectorLoopVariable(VectorLoopInfo &info, VariableData *variable)
+{
+	if(variable == info.index || variable == info.boundVariable || variable == info.boundArray)
+		return true;
+
+	for(unsigned i = 0; i < info.arrays.size(); i++)
+	{
+		if(variable == info.arrays[i])
+			return true;
+	}
+
+	return false;
+}
+
+void CheckVectorLoopAddressUse(void *context, ExprBase *child)
 {
+	VectorLoopInfo &info = *(VectorLoopInfo*)context;
+
+	// Parents are visited first, so direct uses are known before the address itself is reached
+	if(ExprMemberAccess *node = getType<ExprMemberAccess>(child))
+		info.directAddresses.push_back(node->value);
+	else if(ExprAssignment *node = getType<ExprAssignment>(child))
+		info.directAddresses.push_back(node->lhs);
+	else if(ExprPreModify *node = getType<ExprPreModify>(child))
+		info.directAddresses.push_back(node->value);
+	else if(ExprPostModify *node = getType<ExprPostModify>(child))
+		info.directAddresses.push_back(node->value);
+	else if(ExprGetAddress *node = getType<ExprGetAddress>(child))
+	{
+		if(!IsVectorLoopVariable(info, node->variable->variable))
+			return;
+
+		for(unsigned i = 0; i < info.directAddresses.size(); i++)
+		{
+			if(info.directAddresses[i] == child)
+				return;
+		}
+
+		info.addressTaken = true;
+	}
+}
+
+bool AnalyzeVectorLoop(ExpressionTranslateContext &ctx, ExprFor *expression, VectorLoopInfo &info)
+{
+	// Condition has to be 'i < bound'
+	ExprBinaryOp *condition = getType<ExprBinaryOp>(expression->condition);
+
+	if(!condition || condition->op != SYN_BINARY_OP_LESS)
+		return false;
+
+	ExprVariableAccess *index = getType<ExprVariableAccess>(condition->lhs);
+
+	if(!index || index->variable->type != ctx.ctx.typeInt || !IsVectorLoopLocal(ctx, index->variable))
+		return false;
+
+	info.index = index->variable;
+
+	if(ExprVariableAccess *bound = getType<ExprVariableAccess>(condition->rhs))
+	{
+		if(bound->variable->type != ctx.ctx.typeInt || !IsVectorLoopLocal(ctx, bound->variable))
+			return false;
+
+		info.boundVariable = bound->variable;
+	}
+	else if(!isType<ExprIntegerLiteral>(condition->rhs))
+	{
+		info.boundArray = GetVectorLoopArraySize(ctx, condition->rhs);
+
+		if(!info.boundArray)
+			return false;
+	}
+
+	// Increment has to be a single '++i' or 'i++'
+	ExprBlock *increment = getType<ExprBlock>(expression->increment);
+
+	if(!increment)
+		return false;
+
+	unsigned modifyCount = 0;
+
+	for(ExprBase *curr = increment->expressions.head; curr; curr = curr->next)
+	{
+		if(ExprSequence *sequence = getType<ExprSequence>(curr))
+		{
+			if(!sequence->expressions.empty())
+				return false;
+
+			continue;
+		}
+
+		ExprBase *value = NULL;
+
+		if(ExprPreModify *node = getType<ExprPreModify>(curr))
+			value = node->isIncrement ? node->value : NULL;
+		else if(ExprPostModify *node = getType<ExprPostModify>(curr))
+			value = node->isIncrement ? node->value : NULL;
+
+		ExprGetAddress *address = getType<ExprGetAddress>(value);
+
+		if(!address || address->variable->variable != info.index)
+			return false;
+
+		modifyCount++;
+	}
+
+	if(modifyCount != 1)
+		return false;
+
+	VisitExpressionTreeNodes(expression->body, &info, CollectVectorLoopArrays);
+
+	if(info.arrays.empty())
+		return false;
+
+	VisitExpressionTreeNodes(expression->body, &info, CheckVectorLoopBody);
+
+	if(info.invalid)
+		return false;
+
+	// Loop index, bound and array variables can't change inside the body
+	for(unsigned i = 0; i < info.addressVariables.size(); i++)
+	{
+		if(IsVectorLoopVariable(info, info.addressVariables[i]))
+			return false;
+	}
+
+	// And no reference to them can exist anywhere in the function
+	VisitExpressionTreeNodes(ctx.currentFunction->declaration, &info, CheckVectorLoopAddressUse);
+
+	if(info.addressTaken)
+		return false;
+
+	return true;
+}
+
+void TranslateVectorLoopBound(ExpressionTranslateContext &ctx, ExprFor *expression)
+{
+	ExprBinaryOp *condition = getType<ExprBinaryOp>(expression->condition);
+
+	Print(ctx, "(");
+	Translate(ctx, condition->rhs);
+	Print(ctx, ")");
+}
+
+void TranslateVectorLoop(ExpressionTranslateContext &ctx, ExprFor *expression, VectorLoopInfo &info)
+{
+	// Bounds checks are hoisted out of the loop: index starts at a non-negative value and the bound is within every array
+	Print(ctx, "if(");
+	TranslateVariableName(ctx, info.index);
+	Print(ctx, " >= 0");
+
+	for(unsigned i = 0; i < info.arrays.size(); i++)
+	{
+		Print(ctx, " && ");
+		TranslateVectorLoopBound(ctx, expression);
+		Print(ctx, " <= ");
+		TranslateVariableName(ctx, info.arrays[i]);
+		Print(ctx, ".size");
+	}
+
+	// Written arrays can't overlap with other arrays to use restricted pointers
+	if(info.restrictSafe)
+	{
+		for(unsigned i = 0; i < info.arrays.size(); i++)
+		{
+			if(!info.arrayWrites[i])
+				continue;
+
+			for(unsigned k = 0; k < info.arrays.size(); k++)
+			{
+				if(k == i)
+					continue;
+
+				VariableData *a = info.arrays[i];
+				VariableData *b = info.arrays[k];
+
+				Print(ctx, " && (");
+				TranslateVariableName(ctx, a);
+				Print(ctx, ".ptr + (long long)");
+				TranslateVariableName(ctx, a);
+				Print(ctx, ".size * %lld <= ", getType<TypeUnsizedArray>(a->type)->subType->size);
+				TranslateVariableName(ctx, b);
+				Print(ctx, ".ptr || ");
+				TranslateVariableName(ctx, b);
+				Print(ctx, ".ptr + (long long)");
+				TranslateVariableName(ctx, b);
+				Print(ctx, ".size * %lld <= ", getType<TypeUnsizedArray>(b->type)->subType->size);
+				TranslateVariableName(ctx, a);
+				Print(ctx, ".ptr)");
+			}
+		}
+	}
+
+	Print(ctx, ")");
+	PrintLine(ctx);
+
+	PrintIndentedLine(ctx, "{");
+	ctx.depth++;
+
+	// Arrays of an outer versioned loop are not checked against the bounds of this loop index
+	SmallArray<VariableData*, 8> prevArrays(ctx.allocator);
+	SmallArray<unsigned, 8> prevArrayIds(ctx.allocator);
+
+	prevArrays.push_back(ctx.vectorLoopArrays.data, ctx.vectorLoopArrays.size());
+	prevArrayIds.push_back(ctx.vectorLoopArrayIds.data, ctx.vectorLoopArrayIds.size());
+
+	ctx.vectorLoopArrays.clear();
+	ctx.vectorLoopArrayIds.clear();
+
+	for(unsigned i = 0; i < info.arrays.size(); i++)
+	{
+		VariableData *variable = info.arrays[i];
+
+		unsigned id = ctx.nextVectorArrayId++;
+
+		PrintIndent(ctx);
+		TranslateTypeName(ctx, getType<TypeUnsizedArray>(variable->type)->subType);
+		Print(ctx, info.restrictSafe ? " *__restrict __nullcVector%d = (" : " *__nullcVector%d = (", id);
+		TranslateTypeName(ctx, getType<TypeUnsizedArray>(variable->type)->subType);
+		Print(ctx, "*)");
+		TranslateVariableName(ctx, variable);
+		Print(ctx, ".ptr;");
+		PrintLine(ctx);
+
+		ctx.vectorLoopArrays.push_back(variable);
+		ctx.vectorLoopArrayIds.push_back(id);
+	}
+
+	VariableData *prevIndex = ctx.vectorLoopIndex;
+
+	ctx.vectorLoopIndex = info.index;
+
 	unsigned loopBreakId = ctx.nextLoopBreakId++;
 	unsigned loopContinueId = ctx.nextLoopContinueId++;
 	ctx.loopBreakIdStack.push_back(loopBreakId);
 	ctx.loopContinueIdStack.push_back(loopContinueId);
 
+	PrintIndent(ctx);
+	Print(ctx, "while(");
+	Translate(ctx, expression->condition);
+	Print(ctx, ")");
+	PrintLine(ctx);
+
+	PrintIndentedLine(ctx, "{");
+	ctx.depth++;
+	PrintIndent(ctx);
+
+	Translate(ctx, expression->body);
+
+	Print(ctx, ";");
+
+	PrintLine(ctx);
+
+	Print(ctx, "continue_%d:;", loopContinueId);
+	PrintLine(ctx);
+
+	PrintIndentedLine(ctx, "// Increment");
+
+	PrintIndent(ctx);
+	Translate(ctx, expression->increment);
+
+	Print(ctx, ";");
+
+	PrintLine(ctx);
+	ctx.depth--;
+	PrintIndentedLine(ctx, "}");
+
+	Print(ctx, "break_%d:;", loopBreakId);
+	PrintLine(ctx);
+
+	ctx.loopBreakIdStack.pop_back();
+	ctx.loopContinueIdStack.pop_back();
+
+	ctx.vectorLoopIndex = prevIndex;
+
+	ctx.vectorLoopArrays.clear();
+	ctx.vectorLoopArrays.push_back(prevArrays.data, prevArrays.size());
+
+	ctx.vectorLoopArrayIds.clear();
+	ctx.vectorLoopArrayIds.push_back(prevArrayIds.data, prevArrayIds.size());
+
+	ctx.depth--;
+	PrintIndentedLine(ctx, "}");
+	PrintIndentedLine(ctx, "else");
+	PrintIndentedLine(ctx, "{");
+	ctx.depth++;
+	PrintIndent(ctx);
+}
+
+void TranslateFor(ExpressionTranslateContext &ctx, ExprFor *expression)
+{
 	Translate(ctx, expression->initializer);
 	Print(ctx, ";");
 	PrintLine(ctx);
 
 	PrintIndent(ctx);
+
+	bool vectorLoop = false;
+
+	if(ctx.vectorFriendlyLoops)
+	{
+		VectorLoopInfo info(ctx);
+
+		if(AnalyzeVectorLoop(ctx, expression, info))
+		{
+			TranslateVectorLoop(ctx, expression, info);
+
+			vectorLoop = true;
+		}
+	}
+
+	unsigned loopBreakId = ctx.nextLoopBreakId++;
+	unsigned loopContinueId = ctx.nextLoopContinueId++;
+	ctx.loopBreakIdStack.push_back(loopBreakId);
+	ctx.loopContinueIdStack.push_back(loopContinueId);
+
 	Print(ctx, "while(");
 	Translate(ctx, expression->condition);
 	Print(ctx, ")");
@@ -1715,6 +2287,17 @@ void TranslateFor(ExpressionTranslateContext &ctx, ExprFor *expression)
 
 	ctx.loopBreakIdStack.pop_back();
 	ctx.loopContinueIdStack.pop_back();
+
+	if(vectorLoop)
+	{
+		Print(ctx, ";");
+		PrintLine(ctx);
+		ctx.depth--;
+		PrintIndent(ctx);
+		Print(ctx, "}");
+		PrintLine(ctx);
+		PrintIndent(ctx);
+	}
 }
 
 void TranslateWhile(ExpressionTranslateContext &ctx, ExprWhile *expression)
@@ -2137,6 +2720,8 @@ bool TranslateModuleImports(ExpressionTranslateContext &ctx, SmallArray<const ch
 
 		nested.indent = ctx.indent;
 
+		nested.vectorFriendlyLoops = ctx.vectorFriendlyLoops;
+
 		nested.errorBuf = ctx.errorBuf;
 		nested.errorBufSize = ctx.errorBufSize;
 
@@ -2667,6 +3252,266 @@ void TranslateModuleGlobalFunctionInformation(ExpressionTranslateContext &ctx)
 	PrintLine(ctx);
 }
 
+bool IsNativeBindingType(ExpressionTranslateContext &ctx, TypeBase *type)
+{
+	ExpressionContext &exprCtx = ctx.ctx;
+
+	if(type == exprCtx.typeBool || type == exprCtx.typeChar || type == exprCtx.typeShort || type == exprCtx.typeInt)
+		return true;
+
+	if(type == exprCtx.typeLong || type == exprCtx.typeFloat || type == exprCtx.typeDouble)
+		return true;
+
+	return false;
+}
+
+struct NativeBindingGlobalAccess
+{
+	NativeBindingGlobalAccess(ExpressionTranslateContext &ctx): ctx(ctx), visited(ctx.allocator)
+	{
+		found = false;
+	}
+
+	ExpressionTranslateContext &ctx;
+
+	SmallArray<FunctionData*, 32> visited;
+
+	bool found;
+
+private:
+	NativeBindingGlobalAccess(const NativeBindingGlobalAccess&);
+	NativeBindingGlobalAccess& operator=(const NativeBindingGlobalAccess&);
+};
+
+bool IsNativeBindingGlobal(VariableData *variable)
+{
+	for(ScopeData *scope = variable->scope; scope; scope = scope->scope)
+	{
+		if(scope->ownerFunction || scope->ownerType)
+			return false;
+	}
+
+	return true;
+}
+
+void CheckNativeBindingFunctionGlobals(NativeBindingGlobalAccess &info, FunctionData *function);
+
+void CheckNativeBindingGlobalAccess(void *context, ExprBase *child)
+{
+	NativeBindingGlobalAccess &info = *(NativeBindingGlobalAccess*)context;
+
+	if(ExprVariableAccess *node = getType<ExprVariableAccess>(child))
+	{
+		if(IsNativeBindingGlobal(node->variable))
+			info.found = true;
+	}
+	else if(ExprGetAddress *node = getType<ExprGetAddress>(child))
+	{
+		if(IsNativeBindingGlobal(node->variable->variable))
+			info.found = true;
+	}
+	else if(ExprFunctionAccess *node = getType<ExprFunctionAccess>(child))
+	{
+		CheckNativeBindingFunctionGlobals(info, node->function);
+	}
+}
+
+void CheckNativeBindingFunctionGlobals(NativeBindingGlobalAccess &info, FunctionData *function)
+{
+	if(info.found)
+		return;
+
+	// Functions of other modules would use a private native copy of that module state
+	if(function->importModule)
+	{
+		info.found = true;
+		return;
+	}
+
+	if(!function->declaration)
+		return;
+
+	for(unsigned i = 0; i < info.visited.size(); i++)
+	{
+		if(info.visited[i] == function)
+			return;
+	}
+
+	info.visited.push_back(function);
+
+	VisitExpressionTreeNodes(function->declaration, &info, CheckNativeBindingGlobalAccess);
+}
+
+bool IsNativeBindingFunction(ExpressionTranslateContext &ctx, FunctionData *function)
+{
+	if(function->importModule || function->isPrototype || !function->declaration)
+		return false;
+
+	if(ctx.ctx.IsGenericFunction(function) || ctx.ctx.IsGenericInstance(function))
+		return false;
+
+	// Only global functions without a context can be called through the external function wrapper
+	if(function->scope != ctx.ctx.globalScope || function->scope->ownerType || function->coroutine)
+		return false;
+
+	if(function->contextType != ctx.ctx.typeVoid->refType)
+		return false;
+
+	if(*function->name->name.begin == '$' || function->isHidden)
+		return false;
+
+	if(function->type->returnType != ctx.ctx.typeVoid && !IsNativeBindingType(ctx, function->type->returnType))
+		return false;
+
+	for(unsigned i = 0; i < function->arguments.size(); i++)
+	{
+		if(!IsNativeBindingType(ctx, function->arguments[i].type))
+			return false;
+	}
+
+	// Native code has its own copy of the module globals, functions that use them stay in the VM
+	NativeBindingGlobalAccess info(ctx);
+
+	CheckNativeBindingFunctionGlobals(info, function);
+
+	return !info.found;
+}
+
+void TranslateModuleNativeBindings(ExpressionTranslateContext &ctx)
+{
+	PrintIndentedLine(ctx, "// Native module bindings");
+
+	// Argument layout matches the external function wrapper, every argument is rounded up to 4 bytes and small types are promoted to int
+	for(unsigned i = 0; i < ctx.ctx.functions.size(); i++)
+	{
+		FunctionData *function = ctx.ctx.functions[i];
+
+		if(!IsNativeBindingFunction(ctx, function))
+			continue;
+
+		PrintIndentedLine(ctx, "static void __nullcNativeWrap%d(void *func, char *retBuf, char *argBuf)", i);
+		PrintIndentedLine(ctx, "{");
+
+		ctx.depth++;
+
+		PrintIndentedLine(ctx, "(void)func;");
+
+		if(function->type->returnType == ctx.ctx.typeVoid)
+			PrintIndentedLine(ctx, "(void)retBuf;");
+
+		if(function->arguments.empty())
+			PrintIndentedLine(ctx, "(void)argBuf;");
+
+		unsigned offset = 0;
+
+		for(unsigned k = 0; k < function->arguments.size(); k++)
+		{
+			TypeBase *type = function->arguments[k].type;
+
+			PrintIndent(ctx);
+
+			if(type->size < 4)
+				Print(ctx, "int");
+			else
+				TranslateTypeName(ctx, type);
+
+			Print(ctx, " __arg%d; memcpy(&__arg%d, argBuf + %d, sizeof(__arg%d));", k, k, offset, k);
+			PrintLine(ctx);
+
+			offset += unsigned((type->size + 3) & ~3);
+		}
+
+		TypeBase *returnType = function->type->returnType;
+
+		PrintIndent(ctx);
+
+		if(returnType != ctx.ctx.typeVoid)
+		{
+			if(returnType->size < 4)
+				Print(ctx, "int __result = (int)");
+			else if(returnType == ctx.ctx.typeFloat)
+				Print(ctx, "double __result = (double)");
+			else
+			{
+				TranslateTypeName(ctx, returnType);
+				Print(ctx, " __result = ");
+			}
+		}
+
+		TranslateFunctionName(ctx, function);
+		Print(ctx, "(");
+
+		for(unsigned k = 0; k < function->arguments.size(); k++)
+		{
+			Print(ctx, "(");
+			TranslateTypeName(ctx, function->arguments[k].type);
+			Print(ctx, ")__arg%d, ", k);
+		}
+
+		Print(ctx, "NULL);");
+		PrintLine(ctx);
+
+		if(returnType != ctx.ctx.typeVoid)
+			PrintIndentedLine(ctx, "memcpy(retBuf, &__result, sizeof(__result));");
+
+		ctx.depth--;
+
+		PrintIndentedLine(ctx, "}");
+	}
+
+	PrintLine(ctx);
+
+	PrintIndentedLine(ctx, "#if defined(_MSC_VER)");
+	PrintIndentedLine(ctx, "extern \"C\" __declspec(dllexport) int %s_native(const char *module, unsigned char (*bind)(const char *module, void *func, void (*wrap)(void *func, char *retBuf, char *argBuf), const char *name, int index));", ctx.mainName);
+	PrintIndentedLine(ctx, "#else");
+	PrintIndentedLine(ctx, "extern \"C\" __attribute__((visibility(\"default\"))) int %s_native(const char *module, unsigned char (*bind)(const char *module, void *func, void (*wrap)(void *func, char *retBuf, char *argBuf), const char *name, int index));", ctx.mainName);
+	PrintIndentedLine(ctx, "#endif");
+	PrintLine(ctx);
+
+	PrintIndentedLine(ctx, "int %s_native(const char *module, unsigned char (*bind)(const char *module, void *func, void (*wrap)(void *func, char *retBuf, char *argBuf), const char *name, int index))", ctx.mainName);
+	PrintIndentedLine(ctx, "{");
+
+	ctx.depth++;
+
+	// Native code has its own copy of the module state
+	PrintIndentedLine(ctx, "%s();", ctx.mainName);
+
+	for(unsigned i = 0; i < ctx.ctx.functions.size(); i++)
+	{
+		FunctionData *function = ctx.ctx.functions[i];
+
+		if(!IsNativeBindingFunction(ctx, function))
+			continue;
+
+		// Overload index counts all module functions with the same name, including prototypes
+		unsigned overload = 0;
+
+		for(unsigned k = 0; k < i; k++)
+		{
+			FunctionData *prev = ctx.ctx.functions[k];
+
+			if(!prev->importModule && prev->name->name == function->name->name)
+				overload++;
+		}
+
+		PrintIndent(ctx);
+		Print(ctx, "if(!bind(module, (void*)");
+		TranslateFunctionName(ctx, function);
+		Print(ctx, ", __nullcNativeWrap%d, \"%.*s\", %d))", i, FMT_ISTR(function->name->name), overload);
+		PrintLine(ctx);
+
+		ctx.depth++;
+		PrintIndentedLine(ctx, "return 0;");
+		ctx.depth--;
+	}
+
+	PrintIndentedLine(ctx, "return 1;");
+
+	ctx.depth--;
+
+	PrintIndentedLine(ctx, "}");
+}
+
 bool TranslateModule(ExpressionTranslateContext &ctx, ExprModule *expression, SmallArray<const char*, 32> &dependencies)
 {
 	if(!TranslateModuleImports(ctx, dependencies))
@@ -2791,6 +3636,13 @@ bool TranslateModule(ExpressionTranslateContext &ctx, ExprModule *expression, Sm
 
 	PrintIndentedLine(ctx, "}");
 
+	if(ctx.exportNativeBindings)
+	{
+		PrintLine(ctx);
+
+		TranslateModuleNativeBindings(ctx);
+	}
+
 	ctx.output.Flush();
 
 	return true;
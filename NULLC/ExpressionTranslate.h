@@ -5,10 +5,11 @@
 #include "Output.h"
 
 struct FunctionData;
+struct VariableData;
 
 struct ExpressionTranslateContext
 {
-	ExpressionTranslateContext(ExpressionContext &ctx, OutputContext &output, Allocator *allocator): ctx(ctx), output(output), loopBreakIdStack(allocator), loopContinueIdStack(allocator), allocator(allocator)
+	ExpressionTranslateContext(ExpressionContext &ctx, OutputContext &output, Allocator *allocator): ctx(ctx), output(output), loopBreakIdStack(allocator), loopContinueIdStack(allocator), vectorLoopArrays(allocator), vectorLoopArrayIds(allocator), allocator(allocator)
 	{
 		mainName = "main";
 
@@ -26,6 +27,13 @@ struct ExpressionTranslateContext
 
 		skipFunctionDefinitions = false;
 
+		exportNativeBindings = false;
+
+		vectorFriendlyLoops = false;
+
+		vectorLoopIndex = 0;
+		nextVectorArrayId = 1;
+
 		currentFunction = 0;
 	}
 
@@ -52,6 +60,17 @@ struct ExpressionTranslateContext
 
 	bool skipFunctionDefinitions;
 
+	// Export '<mainName>_native' entry point that binds module functions to a running nullc host
+	bool exportNativeBindings;
+
+	// Counted loops over arrays get a version with hoisted bounds checks and raw element pointers
+	bool vectorFriendlyLoops;
+
+	VariableData *vectorLoopIndex;
+	SmallArray<VariableData*, 8> vectorLoopArrays;
+	SmallArray<unsigned, 8> vectorLoopArrayIds;
+	unsigned nextVectorArrayId;
+
 	FunctionData *currentFunction;
 
 	// Memory pool
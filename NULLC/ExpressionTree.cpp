@@ -896,6 +896,9 @@ ExpressionContext::ExpressionContext(Allocator *allocator, int optimizationLevel
 
 	baseModuleFunctionCount = 0;
 
+	redirectFunction = NULL;
+	redirectPtrFunction = NULL;
+
 	uniqueDependencies.set_allocator(allocator);
 	imports.set_allocator(allocator);
 	implicitImports.set_allocator(allocator);
@@ -6899,6 +6902,25 @@ ExprBase* GetFunctionTable(ExpressionContext &ctx, SynBase *source, FunctionData
 	return new (ctx.get<ExprVariableAccess>()) ExprVariableAccess(source, variable->type, variable);
 }
 
+ExprBase* CreateVirtualFunctionLookup(ExpressionContext &ctx, SynBase *source, ExprBase *context, ExprBase *table, bool allowMissing)
+{
+	ExprBase *call = CreateFunctionCall2(ctx, source, InplaceStr(allowMissing ? "__redirect_ptr" : "__redirect"), context, table, false, true, true);
+
+	// Lookup function is recorded, so that the call can be recognized during code generation
+	if(ExprFunctionCall *node = getType<ExprFunctionCall>(call))
+	{
+		if(ExprFunctionAccess *access = getType<ExprFunctionAccess>(node->function))
+		{
+			if(allowMissing)
+				ctx.redirectPtrFunction = access->function;
+			else
+				ctx.redirectFunction = access->function;
+		}
+	}
+
+	return call;
+}
+
 ExprBase* CreateFunctionCall0(ExpressionContext &ctx, SynBase *source, InplaceStr name, bool allowFailure, bool allowInternal, bool allowFastLookup)
 {
 	SmallArray<ArgumentData, 1> arguments(ctx.allocator);
@@ -7475,7 +7497,7 @@ ExprBase* CreateFunctionCallFinal(ExpressionContext &ctx, SynBase *source, ExprB
 		{
 			ExprBase *table = GetFunctionTable(ctx, source, bestOverload.function);
 
-			value = CreateFunctionCall2(ctx, source, InplaceStr("__redirect"), bestOverload.context, table, false, true, true);
+			value = CreateVirtualFunctionLookup(ctx, source, bestOverload.context, table, false);
 
 			value = new (ctx.get<ExprTypeCast>()) ExprTypeCast(source, function->type, value, EXPR_CAST_REINTERPRET);
 		}
@@ -8178,7 +8200,7 @@ ExprBase* ResolveInitializerValue(ExpressionContext &ctx, SynBase *source, ExprB
 			{
 				ExprBase *table = GetFunctionTable(ctx, source, function);
 
-				initializer = CreateFunctionCall2(ctx, source, InplaceStr("__redirect_ptr"), node->context, table, false, true, true);
+				initializer = CreateVirtualFunctionLookup(ctx, source, node->context, table, true);
 
 				if(!isType<TypeError>(initializer))
 					initializer = new (ctx.get<ExprTypeCast>()) ExprTypeCast(source, function->type, initializer, EXPR_CAST_REINTERPRET);
@@ -362,6 +362,10 @@ struct ExpressionContext
 
 	unsigned baseModuleFunctionCount;
 
+	// Runtime virtual function lookup functions used by the module, set when a virtual call is created
+	FunctionData *redirectFunction;
+	FunctionData *redirectPtrFunction;
+
 	// Context info
 	HashMap<TypeBase*> typeMap;
 	HashMap<FunctionData*> functionMap;
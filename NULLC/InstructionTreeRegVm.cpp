@@ -196,6 +196,8 @@ const char* GetInstructionName(RegVmInstructionCode code)
 		return "lognotl";
 	case rviConvertPtr:
 		return "convertptr";
+	case rviNewObject:
+		return "newobj";
 	case rviFuncAddr:
 		return "funcaddr";
 	case rviTypeid:
@@ -206,3 +208,89 @@ const char* GetInstructionName(RegVmInstructionCode code)
 
 	return "";
 }
+
+bool HasRegVmRelocation(const RegVmCmd &cmd)
+{
+	switch(cmd.code)
+	{
+	case rviLoadByte:
+	case rviLoadWord:
+	case rviLoadDword:
+	case rviLoadLong:
+	case rviLoadFloat:
+	case rviLoadDouble:
+	case rviStoreByte:
+	case rviStoreWord:
+	case rviStoreDword:
+	case rviStoreLong:
+	case rviStoreFloat:
+	case rviStoreDouble:
+	case rviGetAddr:
+	case rviAdd:
+	case rviSub:
+	case rviMul:
+	case rviDiv:
+	case rviPow:
+	case rviMod:
+	case rviLess:
+	case rviGreater:
+	case rviLequal:
+	case rviGequal:
+	case rviEqual:
+	case rviNequal:
+	case rviShl:
+	case rviShr:
+	case rviBitAnd:
+	case rviBitOr:
+	case rviBitXor:
+	case rviAddl:
+	case rviSubl:
+	case rviMull:
+	case rviDivl:
+	case rviPowl:
+	case rviModl:
+	case rviLessl:
+	case rviGreaterl:
+	case rviLequall:
+	case rviGequall:
+	case rviEquall:
+	case rviNequall:
+	case rviShll:
+	case rviShrl:
+	case rviBitAndl:
+	case rviBitOrl:
+	case rviBitXorl:
+	case rviAddd:
+	case rviSubd:
+	case rviMuld:
+	case rviDivd:
+	case rviAddf:
+	case rviSubf:
+	case rviMulf:
+	case rviDivf:
+	case rviPowd:
+	case rviModd:
+	case rviLessd:
+	case rviGreaterd:
+	case rviLequald:
+	case rviGequald:
+	case rviEquald:
+	case rviNequald:
+		return cmd.rC == rvrrGlobals || cmd.rC == rvrrConstants;
+	case rviJmp:
+	case rviJmpz:
+	case rviJmpnz:
+	case rviCall:
+	case rviCallPtr:
+	case rviReturn:
+	case rviConvertPtr:
+	case rviNewObject:
+	case rviFuncAddr:
+	case rviTypeid:
+		return true;
+	default:
+		break;
+	}
+
+	return false;
+}
@@ -133,6 +133,8 @@ enum RegVmInstructionCode
 
 	rviConvertPtr,
 
+	rviNewObject,
+
 	// Temporary instructions, no execution
 	rviFuncAddr,
 	rviTypeid,
@@ -233,3 +235,6 @@ struct RegVmRegister
 #endif
 
 const char* GetInstructionName(RegVmInstructionCode code);
+
+// Instruction refers to global memory, constants, code addresses, functions or types that are moved when module is linked
+bool HasRegVmRelocation(const RegVmCmd &cmd);
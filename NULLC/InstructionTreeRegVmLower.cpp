@@ -704,6 +704,58 @@ void LowerBinaryMemoryOperationIntoBlock(ExpressionContext &ctx, RegVmLoweredFun
 		assert(!"unknown type");
 }
 
+bool TryLowerObjectAllocationIntoBlock(ExpressionContext &ctx, RegVmLoweredFunction *lowFunction, RegVmLoweredBlock *lowBlock, VmInstruction *inst)
+{
+	// Allocation of an object with a known type and size is performed by a separate instruction that bumps size class buffer without a call
+	VmFunction *targetFunction = getType<VmFunction>(inst->arguments[1]);
+
+	if(!targetFunction || !targetFunction->function || targetFunction->function->name->name != InplaceStr("__newS"))
+		return false;
+
+	if(inst->arguments.size() != 5 || !isType<VmConstant>(inst->arguments[0]) || inst->type.type != VM_TYPE_POINTER)
+		return false;
+
+	VmConstant *resultAddress = getType<VmConstant>(inst->arguments[2]);
+
+	if(resultAddress && resultAddress->isReference)
+		return false;
+
+	VmConstant *size = getType<VmConstant>(inst->arguments[3]);
+	VmInstruction *typeId = getType<VmInstruction>(inst->arguments[4]);
+
+	if(!size || size->type != VmType::Int || unsigned(size->iValue) > 0xffff || !typeId || typeId->cmd != VM_INST_TYPE_ID)
+		return false;
+
+	VmConstant *typeIndex = getType<VmConstant>(typeId->arguments[0]);
+
+	assert(typeIndex);
+
+	SmallArray<unsigned char, 32> typeRegs(ctx.allocator);
+	GetArgumentRegisters(ctx, lowFunction, lowBlock, typeRegs, typeId);
+
+	bool fakeUser = false;
+
+	if(inst->users.empty())
+	{
+		fakeUser = true;
+		inst->users.push_back(NULL);
+	}
+
+	unsigned char targetReg = lowFunction->AllocateRegister(inst);
+
+	lowBlock->AddInstruction(ctx, inst->source, rviNewObject, targetReg, (unsigned char)(size->iValue >> 8), (unsigned char)(size->iValue & 0xff), typeIndex->iValue);
+
+	if(fakeUser)
+	{
+		for(unsigned i = 0; i < inst->regVmRegisters.size(); i++)
+			lowFunction->FreeRegister(inst->regVmRegisters[i]);
+
+		inst->users.clear();
+	}
+
+	return true;
+}
+
 void LowerInstructionIntoBlock(ExpressionContext &ctx, RegVmLoweredFunction *lowFunction, RegVmLoweredBlock *lowBlock, VmValue *value)
 {
 	RegVmLoweredInstruction *lastLowered = lowBlock->lastInstruction;
@@ -1698,6 +1750,9 @@ void LowerInstructionIntoBlock(ExpressionContext &ctx, RegVmLoweredFunction *low
 	{
 		assert((unsigned short)inst->type.size == inst->type.size);
 
+		if(TryLowerObjectAllocationIntoBlock(ctx, lowFunction, lowBlock, inst))
+			break;
+
 		RegVmInstructionCode targetInst = rviNop;
 
 		VmValue *targetContext = NULL;
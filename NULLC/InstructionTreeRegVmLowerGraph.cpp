@@ -678,6 +678,11 @@ void PrintInstruction(OutputContext &ctx, char *constantData, ExternFuncInfo *fu
 		Print(ctx, ", ");
 		PrintConstant(ctx, argument, constant);
 		break;
+	case rviNewObject:
+		PrintRegister(ctx, rA);
+		Print(ctx, ", %d, ", (rB << 8) | rC);
+		PrintConstant(ctx, argument, constant);
+		break;
 	case rviFuncAddr:
 	case rviTypeid:
 		PrintRegister(ctx, rA);
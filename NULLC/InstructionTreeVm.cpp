@@ -905,7 +905,7 @@ namespace
 			{
 				if(constant->isReference)
 				{
-					VmConstant *pointer = CreateConstantPointer(ctx.allocator, source, constant->iValue, constant->container, type, true);
+					VmConstant *pointer = CreateConstantPointer(ctx.allocator, source, constant->iValue, constant->container, ctx.GetReferenceType(type), true);
 
 					return CreateMemCopy(module, source, shiftAddress, 0, pointer, 0, int(type->size));
 				}
@@ -918,7 +918,7 @@ namespace
 		{
 			if(constant->isReference)
 			{
-				VmConstant *pointer = CreateConstantPointer(ctx.allocator, source, constant->iValue, constant->container, type, true);
+				VmConstant *pointer = CreateConstantPointer(ctx.allocator, source, constant->iValue, constant->container, ctx.GetReferenceType(type), true);
 
 				return CreateMemCopy(module, source, address, offset, pointer, 0, int(type->size));
 			}
@@ -1007,6 +1007,35 @@ namespace
 			(*optCount)++;
 	}
 
+	VmConstant* CloneAddressConstant(VmModule *module, VmConstant *constant)
+	{
+		VariableData *container = constant->container;
+
+		assert(container);
+
+		VmConstant *copy = NULL;
+
+		if(constant->isReference)
+		{
+			copy = new (module->get<VmConstant>()) VmConstant(module->allocator, constant->type, constant->source);
+
+			copy->iValue = constant->iValue;
+			copy->container = container;
+			copy->isReference = true;
+
+			container->users.push_back(copy);
+		}
+		else
+		{
+			copy = CreateConstantPointer(module->allocator, constant->source, constant->iValue, container, constant->type.structType, true);
+		}
+
+		if(!constant->comment.empty())
+			copy->comment = constant->comment;
+
+		return copy;
+	}
+
 	void ReplaceValue(VmModule *module, VmValue *value, VmValue *original, VmValue *replacement)
 	{
 		assert(original);
@@ -1168,8 +1197,16 @@ namespace
 		module->tempUsers.reserve(original->users.size());
 		module->tempUsers.push_back(original->users.data, original->users.size());
 
+		VmConstant *address = getType<VmConstant>(replacement);
+
 		for(unsigned i = 0; i < module->tempUsers.size(); i++)
-			ReplaceValue(module, module->tempUsers[i], original, replacement);
+		{
+			// Variable addresses are tracked by the variable, each user needs its own constant
+			if(i != 0 && address && address->container)
+				ReplaceValue(module, module->tempUsers[i], original, CloneAddressConstant(module, address));
+			else
+				ReplaceValue(module, module->tempUsers[i], original, replacement);
+		}
 
 		if(VmBlock *block = getType<VmBlock>(original))
 		{
@@ -3689,8 +3726,94 @@ VmValue* CompileVmFunctionAccess(ExpressionContext &ctx, VmModule *module, ExprF
 	return CheckType(ctx, node, funcRef);
 }
 
+VmValue* GetAutoRefComponent(ExpressionContext &ctx, VmModule *module, SynBase *source, VmValue *object, unsigned index)
+{
+	// Extracts are legalized after live sets are computed, so they must not be used outside of the current block
+	if(VmInstruction *inst = getType<VmInstruction>(object))
+	{
+		if(inst->cmd == VM_INST_CONSTRUCT)
+			return inst->arguments[index];
+	}
+
+	if(index == 0)
+		return CreateExtract(module, source, VmType::Int, object, 0);
+
+	return CreateExtract(module, source, VmType::Pointer(ctx.GetReferenceType(ctx.typeVoid)), object, 4);
+}
+
+VmValue* CompileVmFunctionRedirect(ExpressionContext &ctx, VmModule *module, ExprFunctionCall *node, FunctionData *redirect)
+{
+	VmValue *object = CompileVm(ctx, module, node->arguments.head);
+	VmValue *tableAddress = CompileVm(ctx, module, node->arguments.head->next);
+
+	VmValue *table = CreateLoad(ctx, module, node->source, ctx.GetUnsizedArrayType(ctx.typeFunctionID), tableAddress, 0);
+	VmValue *tableSize = CreateExtract(module, node->source, VmType::Int, table, sizeof(void*));
+
+	VmBlock *lookupBlock = CreateBlock(module, node->source, "vtbl_lookup");
+	VmBlock *foundBlock = CreateBlock(module, node->source, "vtbl_found");
+	VmBlock *fallbackBlock = CreateBlock(module, node->source, "vtbl_fallback");
+	VmBlock *exitBlock = CreateBlock(module, node->source, "vtbl_exit");
+
+	VmValue *typeId = GetAutoRefComponent(ctx, module, node->source, object, 0);
+
+	// Type id is unsigned, values with the high bit set are negative here and are checked separately
+	VmValue *inTable = CreateAnd(module, node->source, CreateCompareGreaterEqual(module, node->source, typeId, CreateConstantInt(module->allocator, node->source, 0)), CreateCompareLess(module, node->source, typeId, tableSize));
+
+	CreateJumpNotZero(module, node->source, inTable, lookupBlock, fallbackBlock);
+
+	module->currentFunction->AddBlock(lookupBlock);
+	module->currentBlock = lookupBlock;
+
+	VmValue *slot = CreateIndexUnsized(module, node->source, CreateConstantInt(module->allocator, node->source, 4), table, GetAutoRefComponent(ctx, module, node->source, object, 0), ctx.GetReferenceType(ctx.typeFunctionID));
+	VmValue *functionId = CreateLoad(ctx, module, node->source, ctx.typeFunctionID, slot, 0);
+
+	CreateJumpNotZero(module, node->source, functionId, foundBlock, fallbackBlock);
+
+	module->currentFunction->AddBlock(foundBlock);
+	module->currentBlock = foundBlock;
+
+	VmValue *target = CreateConstruct(module, node->source, GetVmType(ctx, node->type), GetAutoRefComponent(ctx, module, node->source, object, 1), functionId, NULL, NULL);
+
+	CreateJump(module, node->source, exitBlock);
+
+	// Runtime function reports invalid tables and reports missing implementations or returns a null function for them
+	module->currentFunction->AddBlock(fallbackBlock);
+	module->currentBlock = fallbackBlock;
+
+	VmInstruction *inst = new (module->get<VmInstruction>()) VmInstruction(module->allocator, GetVmType(ctx, node->type), node->source, VM_INST_CALL, module->currentFunction->nextInstructionId++);
+
+	inst->arguments.reserve(5);
+
+	inst->AddArgument(CreateConstantPointer(module->allocator, node->source, 0, NULL, ctx.typeNullPtr, false));
+	inst->AddArgument(redirect->vmFunction);
+	inst->AddArgument(CreateConstantInt(ctx.allocator, node->source, 0));
+	inst->AddArgument(object);
+	inst->AddArgument(tableAddress);
+
+	inst->hasSideEffects = HasSideEffects(inst->cmd);
+	inst->hasMemoryAccess = HasMemoryAccess(inst->cmd);
+
+	module->currentBlock->AddInstruction(inst);
+
+	CreateJump(module, node->source, exitBlock);
+
+	module->currentFunction->AddBlock(exitBlock);
+	module->currentBlock = exitBlock;
+
+	return CheckType(ctx, node, CreatePhi(module, node->source, getType<VmInstruction>(target), inst));
+}
+
 VmValue* CompileVmFunctionCall(ExpressionContext &ctx, VmModule *module, ExprFunctionCall *node)
 {
+	// Virtual function lookup is performed inline, with a runtime call only to report errors
+	if(ExprFunctionAccess *access = getType<ExprFunctionAccess>(node->function))
+	{
+		bool isRedirect = access->function == ctx.redirectFunction || access->function == ctx.redirectPtrFunction;
+
+		if(isRedirect && access->function->vmFunction)
+			return CompileVmFunctionRedirect(ctx, module, node, access->function);
+	}
+
 	VmValue *function = CompileVm(ctx, module, node->function);
 
 	assert(module->currentBlock);
@@ -4325,6 +4448,17 @@ void RunPeepholeOptimizations(ExpressionContext &ctx, VmModule *module, VmValue*
 				ReplaceValueUsersWith(module, inst, inst->arguments[0], &module->peepholeOptimizations);
 			}
 			break;
+		case VM_INST_INDEX:
+			// Index with a constant in-bounds index is a member access, multiplication and bounds check can be removed
+			if(VmConstant *index = getType<VmConstant>(inst->arguments[3]))
+			{
+				VmConstant *arrayLength = getType<VmConstant>(inst->arguments[0]);
+				VmConstant *elementSize = getType<VmConstant>(inst->arguments[1]);
+
+				if(arrayLength && elementSize && !isType<VmConstant>(inst->arguments[2]) && unsigned(index->iValue) < unsigned(arrayLength->iValue))
+					ChangeInstructionTo(module, inst, VM_INST_ADD, inst->arguments[2], CreateConstantInt(module->allocator, inst->source, index->iValue * elementSize->iValue), NULL, NULL, NULL, &module->peepholeOptimizations);
+			}
+			break;
 		case VM_INST_INDEX_UNSIZED:
 			// Try to replace unsized array index with an array index if the type[] is a construct expression
 			if(VmInstruction *objectConstruct = getType<VmInstruction>(inst->arguments[1]))
@@ -4498,6 +4632,30 @@ void RunPeepholeOptimizations(ExpressionContext &ctx, VmModule *module, VmValue*
 					ReplaceValueUsersWith(module, inst, inst->arguments[3], &module->peepholeOptimizations);
 				}
 			}
+			else if(VmInstruction *target = getType<VmInstruction>(inst->arguments[0]))
+			{
+				// Call through a function reference with a known target can be made direct
+				if(target->cmd == VM_INST_CONSTRUCT && isType<VmFunction>(target->arguments[1]))
+				{
+					VmValue *functionContext = target->arguments[0];
+					VmValue *function = target->arguments[1];
+
+					functionContext->AddUse(inst);
+					function->AddUse(inst);
+
+					inst->arguments.push_back(NULL);
+
+					for(unsigned i = inst->arguments.size() - 1; i > 1; i--)
+						inst->arguments[i] = inst->arguments[i - 1];
+
+					inst->arguments[0] = functionContext;
+					inst->arguments[1] = function;
+
+					target->RemoveUse(inst);
+
+					module->peepholeOptimizations++;
+				}
+			}
 			break;
 		case VM_INST_JUMP_NZ:
 			if(VmInstruction *cond = getType<VmInstruction>(inst->arguments[0]))
@@ -4839,6 +4997,8 @@ void RunDeadCodeElimiation(ExpressionContext &ctx, VmModule *module, VmFunction*
 	if(!function->firstBlock)
 		return;
 
+	unsigned eliminations = module->deadCodeEliminations;
+
 	for(VmBlock *curr = function->firstBlock; curr; curr = curr->nextSibling)
 	{
 		curr->predecessors.clear();
@@ -4934,6 +5094,16 @@ void RunDeadCodeElimiation(ExpressionContext &ctx, VmModule *module, VmFunction*
 
 		curr->visited = false;
 	}
+
+	// Branch with a constant condition might have been removed, leaving an unreachable block that is kept by users from other unreachable blocks
+	for(VmBlock *curr = function->firstBlock->nextSibling; curr; curr = curr->nextSibling)
+	{
+		if(curr->users.empty() && module->deadCodeEliminations != eliminations)
+		{
+			RunDeadCodeElimiation(ctx, module, function);
+			break;
+		}
+	}
 }
 
 void RunDeadCodeElimiation(ExpressionContext &ctx, VmModule *module, VmBlock *block)
@@ -5706,11 +5876,11 @@ void RunDeadAlocaStoreElimination(ExpressionContext &ctx, VmModule *module, VmVa
 			if(scope == ctx.globalScope)
 				return;
 
-			for(unsigned variablePos = 0, variableCount = scope->allVariables.count; variablePos < variableCount; variablePos++)
+			for(unsigned variablePos = 0, variableCount = scope->allVariables.count + function->memberAllocas.count; variablePos < variableCount; variablePos++)
 			{
-				VariableData *variable = scope->allVariables.data[variablePos];
+				VariableData *variable = variablePos < scope->allVariables.count ? scope->allVariables.data[variablePos] : function->memberAllocas.data[variablePos - scope->allVariables.count];
 
-				if(variable->isAlloca && variable->users.count == 0)
+				if((variable->isAlloca || variable->isVmAlloca) && variable->users.count == 0)
 					continue;
 
 				if(HasAddressTaken(variable))
@@ -6041,11 +6211,12 @@ void RunMemoryToRegister(ExpressionContext &ctx, VmModule *module, VmValue* valu
 			curr->hasPhiNodeForId = 0;
 		}
 
-		for(unsigned i = 0; i < scope->allVariables.size(); i++)
+		// Struct member allocas are promoted after the function scope variables
+		for(unsigned i = 0; i < scope->allVariables.size() + function->memberAllocas.size(); i++)
 		{
-			VariableData *variable = scope->allVariables[i];
+			VariableData *variable = i < scope->allVariables.size() ? scope->allVariables[i] : function->memberAllocas[i - scope->allVariables.size()];
 
-			if(variable->isAlloca && variable->users.empty())
+			if((variable->isAlloca || variable->isVmAlloca) && variable->users.empty())
 				continue;
 
 			assert(!IsMemberScope(variable->scope));
@@ -6447,7 +6618,7 @@ void RunLatePeepholeOptimizations(ExpressionContext &ctx, VmModule *module, VmVa
 	}
 }
 
-bool CheckFunctionForInlining(VmFunction *function)
+bool CheckFunctionForInlining(VmModule *module, VmFunction *function)
 {
 	// Can't inline external function
 	if(!function->firstBlock)
@@ -6457,6 +6628,24 @@ bool CheckFunctionForInlining(VmFunction *function)
 	if(!function->restoreBlocks.empty())
 		return false;
 
+	// Inlined locals are placed with their type alignment
+	for(unsigned i = 0; i < function->scope->allVariables.size(); i++)
+	{
+		VariableData *variable = function->scope->allVariables[i];
+
+		if(variable->alignment > variable->type->alignment)
+			return false;
+	}
+
+	// Function with a taken address can be overridden at runtime
+	for(unsigned i = 0; i < function->users.size(); i++)
+	{
+		VmInstruction *user = getType<VmInstruction>(function->users[i]);
+
+		if(!user || user->cmd != VM_INST_CALL || user->arguments[1] != function)
+			return false;
+	}
+
 	unsigned instructions = 0;
 
 	for(VmBlock *curr = function->firstBlock; curr; curr = curr->nextSibling)
@@ -6480,14 +6669,37 @@ bool CheckFunctionForInlining(VmFunction *function)
 			}
 
 			// Simplest heuristic, inline small functions
-			if(++instructions > 16)
+			if(++instructions > module->inlineCalleeSizeLimit)
 				return false;
 		}
 	}
 
+	function->inlineSize = instructions;
+
 	return true;
 }
 
+bool HasPackedFloatComponent(VmValue *value)
+{
+	VmInstruction *inst = getType<VmInstruction>(value);
+
+	if(inst && (inst->cmd == VM_INST_CONSTRUCT || inst->cmd == VM_INST_ARRAY))
+	{
+		for(unsigned i = 0; i < inst->arguments.size(); i++)
+		{
+			VmInstruction *component = getType<VmInstruction>(inst->arguments[i]);
+
+			if(component && component->cmd == VM_INST_DOUBLE_TO_FLOAT)
+				return true;
+
+			if(HasPackedFloatComponent(component))
+				return true;
+		}
+	}
+
+	return false;
+}
+
 VmConstant* CloneRemappedPointer(ExpressionContext &ctx, VmConstant *remap)
 {
 	VmConstant *ptr = CreateConstantPointer(ctx.allocator, remap->source, remap->iValue, remap->container, ctx.GetReferenceType(remap->container->type), true);
@@ -6508,7 +6720,7 @@ VmValue* RemapInstructionArgument(ExpressionContext &ctx, VmModule *module, VmVa
 			{
 				if(argOrigConstant->isReference)
 				{
-					VmConstant *reference = new (module->get<VmConstant>()) VmConstant(ctx.allocator, GetVmType(ctx, containerOrig->type), argOrigConstant->source);
+					VmConstant *reference = new (module->get<VmConstant>()) VmConstant(ctx.allocator, argOrigConstant->type, argOrigConstant->source);
 
 					reference->iValue = argOrigConstant->iValue;
 					reference->container = (*remap)->container;
@@ -6588,6 +6800,10 @@ void RunFunctionInlining(ExpressionContext &ctx, VmModule *module, VmValue* valu
 		if(inst->cmd != VM_INST_CALL)
 			return;
 
+		// Inlined function locals in global code would become global variables and keep their objects alive
+		if(!module->currentFunction->function)
+			return;
+
 		// Can't inline indirect call
 		if(inst->arguments[0]->type.type == VM_TYPE_FUNCTION_REF)
 			return;
@@ -6600,12 +6816,25 @@ void RunFunctionInlining(ExpressionContext &ctx, VmModule *module, VmValue* valu
 		{
 			targetFunction->checkedInline = true;
 
-			targetFunction->canInline = CheckFunctionForInlining(targetFunction);
+			targetFunction->canInline = CheckFunctionForInlining(module, targetFunction);
 		}
 
 		if(!targetFunction->canInline)
 			return;
 
+		// Composite values with float components can't be stored into argument memory directly (they are legalized later)
+		for(unsigned i = 3; i < inst->arguments.size(); i++)
+		{
+			if(HasPackedFloatComponent(inst->arguments[i]))
+				return;
+		}
+
+		// Limit code growth of the caller
+		if(module->currentFunction->inlinedInstructions + targetFunction->inlineSize > module->inlineCallerGrowthLimit)
+			return;
+
+		module->currentFunction->inlinedInstructions += targetFunction->inlineSize;
+
 		module->currentBlock->insertPoint = inst;
 
 		ScopeData *scope = targetFunction->scope;
@@ -6751,10 +6980,521 @@ void RunFunctionInlining(ExpressionContext &ctx, VmModule *module, VmValue* valu
 
 		module->functionInlines++;
 
+		// Function that was inlined can't be redirected at runtime, its body is already copied into the call sites
+		if(targetFunction->function)
+			targetFunction->function->attributes |= 1 << NULLC_ATTRIBUTE_INLINED;
+
 		module->currentBlock->insertPoint = module->currentBlock->lastInstruction;
 	}
 }
 
+VmValue* CloneLoopInstructionArgument(VmModule *module, VmValue *argOrig, const SmallDenseMap<VmInstruction*, VmValue*, VmInstructionHasher, 16> &valueRemap)
+{
+	if(VmConstant *argOrigConstant = getType<VmConstant>(argOrig))
+	{
+		// Variable addresses are tracked by the variable, each user needs its own constant
+		if(argOrigConstant->container)
+			return CloneAddressConstant(module, argOrigConstant);
+
+		return argOrigConstant;
+	}
+	else if(VmInstruction *argOrigInst = getType<VmInstruction>(argOrig))
+	{
+		// Values defined outside the loop are used as is
+		if(VmValue **remap = valueRemap.find(argOrigInst))
+			return *remap;
+
+		return argOrigInst;
+	}
+
+	return argOrig;
+}
+
+bool EvaluateLoopCondition(VmInstructionType cmd, long long value, long long limit)
+{
+	switch(cmd)
+	{
+	case VM_INST_LESS:
+		return value < limit;
+	case VM_INST_GREATER:
+		return value > limit;
+	case VM_INST_LESS_EQUAL:
+		return value <= limit;
+	case VM_INST_GREATER_EQUAL:
+		return value >= limit;
+	case VM_INST_NOT_EQUAL:
+		return value != limit;
+	default:
+		break;
+	}
+
+	assert(!"unknown condition");
+	return false;
+}
+
+VmValue* GetPhiIncomingValue(VmInstruction *phi, VmBlock *edge)
+{
+	for(unsigned i = 0; i < phi->arguments.size(); i += 2)
+	{
+		if(phi->arguments[i + 1] == edge)
+			return phi->arguments[i];
+	}
+
+	return NULL;
+}
+
+unsigned GetLoopTripCount(VmModule *module, VmBlock *preheader, VmBlock *header, VmBlock *body, VmInstruction *condition)
+{
+	// Condition has to compare the loop counter against a constant
+	VmInstruction *counter = getType<VmInstruction>(condition->arguments[0]);
+	VmConstant *limit = getType<VmConstant>(condition->arguments[1]);
+
+	if(!counter || counter->cmd != VM_INST_PHI || counter->parent != header || counter->type != VmType::Int || !limit || limit->type != VmType::Int)
+		return ~0u;
+
+	VmInstruction *start = getType<VmInstruction>(GetPhiIncomingValue(counter, preheader));
+
+	if(!start || start->cmd != VM_INST_LOAD_IMMEDIATE || start->type != VmType::Int)
+		return ~0u;
+
+	VmConstant *startValue = getType<VmConstant>(start->arguments[0]);
+
+	if(!startValue)
+		return ~0u;
+
+	// Counter has to be changed by a constant step
+	VmInstruction *next = getType<VmInstruction>(GetPhiIncomingValue(counter, body));
+
+	if(!next || next->parent != body || (next->cmd != VM_INST_ADD && next->cmd != VM_INST_SUB) || next->arguments[0] != counter)
+		return ~0u;
+
+	VmConstant *step = getType<VmConstant>(next->arguments[1]);
+
+	if(!step || step->type != VmType::Int)
+		return ~0u;
+
+	long long value = startValue->iValue;
+	long long change = next->cmd == VM_INST_ADD ? step->iValue : -(long long)step->iValue;
+
+	unsigned count = 0;
+
+	while(EvaluateLoopCondition(condition->cmd, value, limit->iValue))
+	{
+		if(++count > module->unrollTripCountLimit)
+			return ~0u;
+
+		value += change;
+
+		// Don't rely on counter overflow behavior
+		if(value != (long long)(int)value)
+			return ~0u;
+	}
+
+	return count;
+}
+
+bool TryUnrollLoop(VmModule *module, VmBlock *header)
+{
+	// Header has to contain only phi instructions, the loop condition and a branch into the loop body
+	VmInstruction *branch = header->lastInstruction;
+
+	if(!branch || branch->cmd != VM_INST_JUMP_NZ)
+		return false;
+
+	VmInstruction *condition = getType<VmInstruction>(branch->arguments[0]);
+
+	if(!condition || condition->parent != header || condition->nextSibling != branch || condition->users.size() != 1)
+		return false;
+
+	if(condition->cmd != VM_INST_LESS && condition->cmd != VM_INST_GREATER && condition->cmd != VM_INST_LESS_EQUAL && condition->cmd != VM_INST_GREATER_EQUAL && condition->cmd != VM_INST_NOT_EQUAL)
+		return false;
+
+	for(VmInstruction *curr = header->firstInstruction; curr != condition; curr = curr->nextSibling)
+	{
+		if(curr->cmd != VM_INST_PHI || curr->arguments.size() != 4)
+			return false;
+	}
+
+	VmBlock *body = getType<VmBlock>(branch->arguments[1]);
+	VmBlock *exit = getType<VmBlock>(branch->arguments[2]);
+
+	if(body == header || exit == header || body == exit)
+		return false;
+
+	// Loop body is a single block that jumps back to the header
+	VmInstruction *backedge = body->lastInstruction;
+
+	if(!backedge || backedge->cmd != VM_INST_JUMP || backedge->arguments[0] != header)
+		return false;
+
+	for(unsigned i = 0; i < body->users.size(); i++)
+	{
+		VmInstruction *user = getType<VmInstruction>(body->users[i]);
+
+		if(!user || (user != branch && (user->cmd != VM_INST_PHI || user->parent != header)))
+			return false;
+	}
+
+	// Header is entered from the preheader and the loop body only
+	VmInstruction *entry = NULL;
+
+	for(unsigned i = 0; i < header->users.size(); i++)
+	{
+		VmInstruction *user = getType<VmInstruction>(header->users[i]);
+
+		if(!user)
+			return false;
+
+		if(user == backedge || user->cmd == VM_INST_PHI)
+			continue;
+
+		if(entry || user->cmd != VM_INST_JUMP)
+			return false;
+
+		entry = user;
+	}
+
+	if(!entry)
+		return false;
+
+	VmBlock *preheader = entry->parent;
+
+	if(preheader == body || preheader->lastInstruction != entry)
+		return false;
+
+	VmFunction *function = header->parent;
+
+	for(unsigned i = 0; i < function->restoreBlocks.size(); i++)
+	{
+		if(function->restoreBlocks[i] == header || function->restoreBlocks[i] == body)
+			return false;
+	}
+
+	unsigned bodySize = 0;
+
+	for(VmInstruction *curr = body->firstInstruction; curr != backedge; curr = curr->nextSibling)
+	{
+		if(curr->cmd == VM_INST_PHI)
+			return false;
+
+		// Values computed in the body can only be used in the loop
+		for(unsigned i = 0; i < curr->users.size(); i++)
+		{
+			VmInstruction *user = getType<VmInstruction>(curr->users[i]);
+
+			if(!user || (user->parent != body && user->parent != header))
+				return false;
+		}
+
+		bodySize++;
+	}
+
+	unsigned tripCount = GetLoopTripCount(module, preheader, header, body, condition);
+
+	if(tripCount == ~0u || tripCount * bodySize > module->unrollSizeLimit)
+		return false;
+
+	// Start with phi values coming from the preheader
+	SmallDenseMap<VmInstruction*, VmValue*, VmInstructionHasher, 16> valueRemap;
+
+	SmallArray<VmInstruction*, 16> phis(module->allocator);
+	SmallArray<VmValue*, 16> phiValues(module->allocator);
+
+	for(VmInstruction *curr = header->firstInstruction; curr != condition; curr = curr->nextSibling)
+	{
+		VmValue *start = GetPhiIncomingValue(curr, preheader);
+		VmValue *next = GetPhiIncomingValue(curr, body);
+
+		if(!start || !next)
+			return false;
+
+		phis.push_back(curr);
+		phiValues.push_back(start);
+
+		valueRemap.insert(curr, start);
+	}
+
+	module->currentBlock = preheader;
+
+	preheader->insertPoint = entry->prevSibling;
+
+	for(unsigned iteration = 0; iteration < tripCount; iteration++)
+	{
+		for(VmInstruction *instOrig = body->firstInstruction; instOrig != backedge; instOrig = instOrig->nextSibling)
+		{
+			VmInstruction *instCopy = CreateInstruction(module, instOrig->source, instOrig->type, instOrig->cmd);
+
+			if(!instOrig->comment.empty())
+				instCopy->comment = instOrig->comment;
+
+			for(unsigned i = 0; i < instOrig->arguments.size(); i++)
+				instCopy->AddArgument(CloneLoopInstructionArgument(module, instOrig->arguments[i], valueRemap));
+
+			valueRemap.insert(instOrig, instCopy);
+		}
+
+		// Phi instructions are updated together
+		for(unsigned i = 0; i < phis.size(); i++)
+			phiValues[i] = CloneLoopInstructionArgument(module, GetPhiIncomingValue(phis[i], body), valueRemap);
+
+		for(unsigned i = 0; i < phis.size(); i++)
+			valueRemap.insert(phis[i], phiValues[i]);
+	}
+
+	preheader->insertPoint = preheader->lastInstruction;
+
+	module->currentBlock = NULL;
+
+	// Users after the loop receive the final values
+	for(unsigned i = 0; i < phis.size(); i++)
+		ReplaceValueUsersWith(module, phis[i], phiValues[i], NULL);
+
+	// Exit block is now entered from the preheader
+	for(unsigned i = 0; i < header->users.size(); i++)
+	{
+		VmInstruction *user = getType<VmInstruction>(header->users[i]);
+
+		if(user->cmd == VM_INST_PHI && user->parent != header)
+		{
+			ReplaceValue(module, user, header, preheader);
+			i--;
+		}
+	}
+
+	ChangeInstructionTo(module, entry, VM_INST_JUMP, exit, NULL, NULL, NULL, NULL, &module->loopUnrolls);
+
+	return true;
+}
+
+void RunLoopUnrolling(VmModule *module, VmValue* value)
+{
+	if(VmFunction *function = getType<VmFunction>(value))
+	{
+		module->currentFunction = function;
+
+		for(VmBlock *curr = function->firstBlock; curr; curr = curr->nextSibling)
+			TryUnrollLoop(module, curr);
+
+		module->currentFunction = NULL;
+	}
+}
+
+MemberHandle* FindScalarReplacementMember(ExpressionContext &ctx, TypeStruct *structType, unsigned offset, VmType type)
+{
+	for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+	{
+		if(curr->variable->offset == offset && GetVmType(ctx, curr->variable->type) == type)
+			return curr;
+	}
+
+	return NULL;
+}
+
+// Only struct locals are split, arguments stay in memory and locals that are returned or passed to calls are reassembled in memory first
+bool CheckScalarReplacement(ExpressionContext &ctx, VmFunction *function, VariableData *variable)
+{
+	TypeStruct *structType = getType<TypeStruct>(variable->type);
+
+	if(!structType || variable->type->size == 0)
+		return false;
+
+	if(IsArgumentVariable(function->function, variable) || HasAddressTaken(variable))
+		return false;
+
+	// Each member gets its own register, so only small aggregates of simple types are split
+	unsigned memberCount = 0;
+
+	for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+	{
+		VmType vmType = GetVmType(ctx, curr->variable->type);
+
+		if(vmType != VmType::Int && vmType != VmType::Double && vmType != VmType::Long && vmType.type != VM_TYPE_POINTER)
+			return false;
+
+		memberCount++;
+	}
+
+	if(memberCount == 0 || memberCount > 8)
+		return false;
+
+	for(unsigned userPos = 0; userPos < variable->users.size(); userPos++)
+	{
+		VmConstant *user = variable->users[userPos];
+
+		for(unsigned i = 0; i < user->users.size(); i++)
+		{
+			VmInstruction *inst = getType<VmInstruction>(user->users[i]);
+
+			if(!inst || inst->arguments[0] != user)
+				return false;
+
+			switch(inst->cmd)
+			{
+			case VM_INST_LOAD_INT:
+			case VM_INST_LOAD_DOUBLE:
+			case VM_INST_LOAD_LONG:
+				if(!FindScalarReplacementMember(ctx, structType, unsigned(user->iValue + getType<VmConstant>(inst->arguments[1])->iValue), inst->type))
+					return false;
+				break;
+			case VM_INST_STORE_INT:
+			case VM_INST_STORE_DOUBLE:
+			case VM_INST_STORE_LONG:
+				if(!FindScalarReplacementMember(ctx, structType, unsigned(user->iValue + getType<VmConstant>(inst->arguments[1])->iValue), inst->arguments[2]->type))
+					return false;
+				break;
+			case VM_INST_LOAD_STRUCT:
+				// Whole aggregate is assembled in memory before it is loaded
+				if(user->iValue + getType<VmConstant>(inst->arguments[1])->iValue != 0 || inst->type.size != variable->type->size)
+					return false;
+				break;
+			case VM_INST_SET_RANGE:
+				// Zero initialization is replaced with member stores
+				if(user->iValue != 0 || !IsConstantZero(inst->arguments[2]) || getType<VmConstant>(inst->arguments[1])->iValue * getType<VmConstant>(inst->arguments[3])->iValue != variable->type->size)
+					return false;
+				break;
+			default:
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+VmConstant* CreateScalarReplacementZero(ExpressionContext &ctx, VmModule *module, SynBase *source, TypeBase *type)
+{
+	VmType vmType = GetVmType(ctx, type);
+
+	if(vmType == VmType::Int)
+		return CreateConstantInt(module->allocator, source, 0);
+
+	if(vmType == VmType::Double)
+		return CreateConstantDouble(module->allocator, source, 0.0);
+
+	if(vmType == VmType::Long)
+		return CreateConstantLong(module->allocator, source, 0);
+
+	return CreateConstantPointer(module->allocator, source, 0, NULL, type, false);
+}
+
+void RunScalarReplacement(ExpressionContext &ctx, VmModule *module, VmValue* value)
+{
+	if(VmFunction *function = getType<VmFunction>(value))
+	{
+		// Skip global code
+		if(!function->function)
+			return;
+
+		ScopeData *scope = function->scope;
+
+		if(!scope || scope == ctx.globalScope)
+			return;
+
+		module->currentFunction = function;
+
+		for(unsigned i = 0; i < scope->allVariables.size(); i++)
+		{
+			VariableData *variable = scope->allVariables[i];
+
+			if(variable->users.empty() || !CheckScalarReplacement(ctx, function, variable))
+				continue;
+
+			TypeStruct *structType = getType<TypeStruct>(variable->type);
+
+			// Padding bytes are only cleared by the zero initialization of the whole object
+			long long memberSize = 0;
+
+			for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+				memberSize += curr->variable->type->size;
+
+			bool hasPadding = memberSize != structType->size;
+
+			// Each member is placed in a separate alloca that can later be promoted to a register
+			SmallDenseMap<VariableData*, VmConstant*, VariableDataHasher, 16> memberRemap;
+
+			for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+			{
+				VmConstant *memberAddress = CreateAlloca(ctx, module, variable->source, curr->variable->type, "member", false);
+
+				function->memberAllocas.push_back(memberAddress->container);
+
+				memberRemap.insert(curr->variable, memberAddress);
+			}
+
+			SmallArray<VmInstruction*, 32> accesses(module->allocator);
+
+			for(unsigned userPos = 0; userPos < variable->users.size(); userPos++)
+			{
+				VmConstant *user = variable->users[userPos];
+
+				for(unsigned k = 0; k < user->users.size(); k++)
+					accesses.push_back(getType<VmInstruction>(user->users[k]));
+			}
+
+			for(unsigned k = 0; k < accesses.size(); k++)
+			{
+				VmInstruction *inst = accesses[k];
+
+				VmConstant *address = getType<VmConstant>(inst->arguments[0]);
+
+				VmBlock *block = inst->parent;
+
+				module->currentBlock = block;
+
+				if(inst->cmd == VM_INST_LOAD_STRUCT)
+				{
+					block->insertPoint = inst->prevSibling;
+
+					for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+					{
+						TypeBase *memberType = curr->variable->type;
+
+						VmValue *member = CreateLoad(ctx, module, inst->source, memberType, CloneRemappedPointer(ctx, *memberRemap.find(curr->variable)), 0);
+
+						CreateStore(ctx, module, inst->source, memberType, CreateConstantPointer(module->allocator, inst->source, int(curr->variable->offset), variable, ctx.GetReferenceType(memberType), true), member, 0);
+					}
+				}
+				else if(inst->cmd == VM_INST_SET_RANGE)
+				{
+					block->insertPoint = inst;
+
+					for(MemberHandle *curr = structType->members.head; curr; curr = curr->next)
+					{
+						TypeBase *memberType = curr->variable->type;
+
+						CreateStore(ctx, module, inst->source, memberType, CloneRemappedPointer(ctx, *memberRemap.find(curr->variable)), CreateScalarReplacementZero(ctx, module, inst->source, memberType), 0);
+					}
+
+					if(!hasPadding)
+						block->RemoveInstruction(inst);
+				}
+				else
+				{
+					VmType accessType = inst->cmd >= VM_INST_STORE_BYTE && inst->cmd <= VM_INST_STORE_STRUCT ? inst->arguments[2]->type : inst->type;
+
+					MemberHandle *member = FindScalarReplacementMember(ctx, structType, unsigned(address->iValue + getType<VmConstant>(inst->arguments[1])->iValue), accessType);
+
+					VmConstant *memberAddress = CloneRemappedPointer(ctx, *memberRemap.find(member->variable));
+					VmConstant *memberOffset = CreateConstantInt(module->allocator, inst->source, 0);
+
+					if(inst->cmd >= VM_INST_STORE_BYTE && inst->cmd <= VM_INST_STORE_STRUCT)
+						ChangeInstructionTo(module, inst, inst->cmd, memberAddress, memberOffset, inst->arguments[2], NULL, NULL, NULL);
+					else
+						ChangeInstructionTo(module, inst, inst->cmd, memberAddress, memberOffset, NULL, NULL, NULL, NULL);
+				}
+
+				block->insertPoint = block->lastInstruction;
+
+				module->currentBlock = NULL;
+			}
+
+			module->scalarReplacements++;
+		}
+
+		module->currentFunction = NULL;
+	}
+}
+
 void RunUpdateLiveSets(ExpressionContext &ctx, VmModule *module, VmValue* value)
 {
 	(void)ctx;
@@ -7872,8 +8612,11 @@ void RunLegalizeExtracts(ExpressionContext &ctx, VmModule *module, VmValue* valu
 	{
 		module->currentBlock = block;
 
-		for(VmInstruction *curr = block->firstInstruction; curr; curr = curr->nextSibling)
+		for(VmInstruction *curr = block->firstInstruction; curr;)
 		{
+			// Legalized instruction might be removed
+			VmInstruction *next = curr->nextSibling;
+
 			if(curr->cmd == VM_INST_EXTRACT)
 			{
 				VmValue *target = curr->arguments[0];
@@ -7912,7 +8655,10 @@ void RunLegalizeExtracts(ExpressionContext &ctx, VmModule *module, VmValue* valu
 					}
 
 					if(replaced)
+					{
+						curr = next;
 						continue;
+					}
 				}
 
 				VmConstant *address = CreateAlloca(ctx, module, curr->source, GetBaseType(ctx, target->type), "construct", true);
@@ -7929,6 +8675,8 @@ void RunLegalizeExtracts(ExpressionContext &ctx, VmModule *module, VmValue* valu
 
 				block->insertPoint = block->lastInstruction;
 			}
+
+			curr = next;
 		}
 
 		module->currentBlock = NULL;
@@ -7974,6 +8722,12 @@ void RunVmPass(ExpressionContext &ctx, VmModule *module, VmPassType type)
 	case VM_PASS_OPT_FUNCION_INLINING:
 		TRACE_LABEL("VM_PASS_OPT_FUNCION_INLINING");
 		break;
+	case VM_PASS_OPT_LOOP_UNROLLING:
+		TRACE_LABEL("VM_PASS_OPT_LOOP_UNROLLING");
+		break;
+	case VM_PASS_OPT_SCALAR_REPLACEMENT:
+		TRACE_LABEL("VM_PASS_OPT_SCALAR_REPLACEMENT");
+		break;
 	case VM_PASS_UPDATE_LIVE_SETS:
 		TRACE_LABEL("VM_PASS_UPDATE_LIVE_SETS");
 		break;
@@ -8034,6 +8788,12 @@ void RunVmPass(ExpressionContext &ctx, VmModule *module, VmPassType type)
 		case VM_PASS_OPT_FUNCION_INLINING:
 			RunFunctionInlining(ctx, module, value);
 			break;
+		case VM_PASS_OPT_LOOP_UNROLLING:
+			RunLoopUnrolling(module, value);
+			break;
+		case VM_PASS_OPT_SCALAR_REPLACEMENT:
+			RunScalarReplacement(ctx, module, value);
+			break;
 		case VM_PASS_UPDATE_LIVE_SETS:
 			RunUpdateLiveSets(ctx, module, value);
 			break;
@@ -8099,6 +8859,12 @@ void RunVmPass(ExpressionContext &ctx, VmModule *module, VmFunction *function, V
 	case VM_PASS_OPT_FUNCION_INLINING:
 		RunFunctionInlining(ctx, module, function);
 		break;
+	case VM_PASS_OPT_LOOP_UNROLLING:
+		RunLoopUnrolling(module, function);
+		break;
+	case VM_PASS_OPT_SCALAR_REPLACEMENT:
+		RunScalarReplacement(ctx, module, function);
+		break;
 	case VM_PASS_UPDATE_LIVE_SETS:
 		RunUpdateLiveSets(ctx, module, function);
 		break;
@@ -155,6 +155,8 @@ enum VmPassType
 	VM_PASS_OPT_LATE_PEEPHOLE,
 
 	VM_PASS_OPT_FUNCION_INLINING,
+	VM_PASS_OPT_LOOP_UNROLLING,
+	VM_PASS_OPT_SCALAR_REPLACEMENT,
 
 	VM_PASS_UPDATE_LIVE_SETS,
 	VM_PASS_PREPARE_SSA_EXIT,
@@ -467,7 +469,7 @@ struct VmBlock: VmValue
 
 struct VmFunction: VmValue
 {
-	VmFunction(Allocator *allocator, VmType type, SynBase *source, FunctionData *function, ScopeData *scope, VmType returnType): VmValue(myTypeID, allocator, type, source), function(function), scope(scope), returnType(returnType), allocas(allocator), restoreBlocks(allocator)
+	VmFunction(Allocator *allocator, VmType type, SynBase *source, FunctionData *function, ScopeData *scope, VmType returnType): VmValue(myTypeID, allocator, type, source), function(function), scope(scope), returnType(returnType), allocas(allocator), memberAllocas(allocator), restoreBlocks(allocator)
 	{
 		firstBlock = NULL;
 		lastBlock = NULL;
@@ -481,6 +483,9 @@ struct VmFunction: VmValue
 		checkedInline = false;
 		canInline = false;
 
+		inlineSize = 0;
+		inlinedInstructions = 0;
+
 		vmAddress = ~0u;
 		vmCodeSize = 0;
 
@@ -520,6 +525,9 @@ struct VmFunction: VmValue
 	bool checkedInline;
 	bool canInline;
 
+	unsigned inlineSize;
+	unsigned inlinedInstructions;
+
 	unsigned vmAddress;
 	unsigned vmCodeSize;
 
@@ -529,6 +537,9 @@ struct VmFunction: VmValue
 
 	SmallArray<VariableData*, 4> allocas;
 
+	// Allocas created by scalar replacement of struct locals
+	SmallArray<VariableData*, 4> memberAllocas;
+
 	unsigned nextRestoreBlock;
 	SmallArray<VmBlock*, 4> restoreBlocks;
 
@@ -558,6 +569,14 @@ struct VmModule
 		commonSubexprEliminations = 0;
 		deadAllocaStoreEliminations = 0;
 		functionInlines = 0;
+		loopUnrolls = 0;
+		scalarReplacements = 0;
+
+		inlineCalleeSizeLimit = NULLC_MAX_INLINE_CALLEE_SIZE;
+		inlineCallerGrowthLimit = NULLC_MAX_INLINE_CALLER_GROWTH;
+
+		unrollTripCountLimit = NULLC_MAX_UNROLL_TRIP_COUNT;
+		unrollSizeLimit = NULLC_MAX_UNROLL_SIZE;
 	}
 
 	const char *code;
@@ -596,6 +615,16 @@ struct VmModule
 	unsigned commonSubexprEliminations;
 	unsigned deadAllocaStoreEliminations;
 	unsigned functionInlines;
+	unsigned loopUnrolls;
+	unsigned scalarReplacements;
+
+	// Function inlining budget, in instructions
+	unsigned inlineCalleeSizeLimit;
+	unsigned inlineCallerGrowthLimit;
+
+	// Loop unrolling limits, in iterations and instructions
+	unsigned unrollTripCountLimit;
+	unsigned unrollSizeLimit;
 
 	struct LoadStoreInfo
 	{
@@ -824,7 +824,7 @@ VmConstant* EvaluateInstruction(InstructionVMEvalContext &ctx, VmInstruction *in
 		assert(arguments[1]->type == VmType::Block && arguments[1]->bValue);
 		assert(arguments[2]->type == VmType::Block && arguments[2]->bValue);
 
-		*nextBlock = arguments[0]->iValue == 0 ? arguments[1]->bValue : arguments[2]->bValue;
+		*nextBlock = !arguments[0]->iValue && !arguments[0]->fValue ? arguments[1]->bValue : arguments[2]->bValue;
 
 		return NULL;
 	case VM_INST_JUMP_NZ:
@@ -832,7 +832,7 @@ VmConstant* EvaluateInstruction(InstructionVMEvalContext &ctx, VmInstruction *in
 		assert(arguments[1]->type == VmType::Block && arguments[1]->bValue);
 		assert(arguments[2]->type == VmType::Block && arguments[2]->bValue);
 
-		*nextBlock = arguments[0]->iValue != 0 ? arguments[1]->bValue : arguments[2]->bValue;
+		*nextBlock = arguments[0]->iValue || arguments[0]->fValue ? arguments[1]->bValue : arguments[2]->bValue;
 
 		return NULL;
 	case VM_INST_CALL:
@@ -719,6 +719,8 @@ void PrintGraph(InstructionVMGraphContext &ctx, VmModule *module)
 	PrintLine(ctx, "// Common subexpression eliminations: %d", module->commonSubexprEliminations);
 	PrintLine(ctx, "// Dead alloca store eliminations: %d", module->deadAllocaStoreEliminations);
 	PrintLine(ctx, "// Function inlines: %d", module->functionInlines);
+	PrintLine(ctx, "// Loop unrolls: %d", module->loopUnrolls);
+	PrintLine(ctx, "// Scalar replacements: %d", module->scalarReplacements);
 
 	ctx.output.Flush();
 }
@@ -1,5 +1,141 @@
 #include "Lexer.h"
 
+#if defined(NULLC_LEXER_SSE2)
+	#include <emmintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+namespace
+{
+#if defined(NULLC_LEXER_SSE2)
+	inline unsigned FindFirstSet(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return unsigned(index);
+#else
+		return unsigned(__builtin_ctz(mask));
+#endif
+	}
+
+	// Mask of bytes in [first, first + count) range
+	inline __m128i CharRangeMask(__m128i data, char first, char count)
+	{
+		return _mm_cmplt_epi8(_mm_add_epi8(data, _mm_set1_epi8(char(-128 - first))), _mm_set1_epi8(char(-128 + count)));
+	}
+#endif
+
+	// Skip spaces, tabs and other control characters except for line breaks
+	const char* SkipSpaces(const char *pos, const char *end)
+	{
+#if defined(NULLC_LEXER_SSE2)
+		while(end - pos >= 16)
+		{
+			__m128i data = _mm_loadu_si128((const __m128i*)pos);
+
+			__m128i space = CharRangeMask(data, 1, ' ');
+			__m128i lineBreak = _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\n')));
+
+			if(unsigned mask = unsigned(_mm_movemask_epi8(_mm_andnot_si128(lineBreak, space))) ^ 0xffff)
+				return pos + FindFirstSet(mask);
+
+			pos += 16;
+		}
+#else
+		(void)end;
+#endif
+
+		while((unsigned char)(pos[0] - 1) < ' ' && *pos != '\r' && *pos != '\n')
+			pos++;
+
+		return pos;
+	}
+
+	// Skip characters that have ct_symbol flag
+	const char* SkipSymbol(const char *pos, const char *end)
+	{
+#if defined(NULLC_LEXER_SSE2)
+		while(end - pos >= 16)
+		{
+			__m128i data = _mm_loadu_si128((const __m128i*)pos);
+
+			__m128i letter = CharRangeMask(_mm_or_si128(data, _mm_set1_epi8(0x20)), 'a', 26);
+			__m128i digit = CharRangeMask(data, '0', 10);
+			__m128i other = _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('_')), _mm_cmplt_epi8(data, _mm_setzero_si128()));
+
+			if(unsigned mask = unsigned(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), other))) ^ 0xffff)
+				return pos + FindFirstSet(mask);
+
+			pos += 16;
+		}
+#else
+		(void)end;
+#endif
+
+		while(chartype_table[(unsigned char)*pos] & ct_symbol)
+			pos++;
+
+		return pos;
+	}
+
+	// Skip string literal contents up to the closing quote, escape sequence or line break
+	const char* SkipQuotedText(const char *pos, const char *end, char quote)
+	{
+#if defined(NULLC_LEXER_SSE2)
+		while(end - pos >= 16)
+		{
+			__m128i data = _mm_loadu_si128((const __m128i*)pos);
+
+			__m128i special = _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8(quote)), _mm_cmpeq_epi8(data, _mm_set1_epi8('\\')));
+			special = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\n'))));
+
+			if(unsigned mask = unsigned(_mm_movemask_epi8(special)))
+				return pos + FindFirstSet(mask);
+
+			pos += 16;
+		}
+#else
+		(void)end;
+#endif
+
+		while(*pos && *pos != quote && *pos != '\\' && *pos != '\r' && *pos != '\n')
+			pos++;
+
+		return pos;
+	}
+
+	// Skip block comment contents up to the possible comment start or end, string literal or line break
+	const char* SkipCommentText(const char *pos, const char *end)
+	{
+#if defined(NULLC_LEXER_SSE2)
+		while(end - pos >= 16)
+		{
+			__m128i data = _mm_loadu_si128((const __m128i*)pos);
+
+			__m128i special = _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('*')), _mm_cmpeq_epi8(data, _mm_set1_epi8('/')));
+			special = _mm_or_si128(special, _mm_cmpeq_epi8(data, _mm_set1_epi8('\"')));
+			special = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\n'))));
+
+			if(unsigned mask = unsigned(_mm_movemask_epi8(special)))
+				return pos + FindFirstSet(mask);
+
+			pos += 16;
+		}
+#else
+		(void)end;
+#endif
+
+		while(*pos && *pos != '*' && *pos != '/' && *pos != '\"' && *pos != '\r' && *pos != '\n')
+			pos++;
+
+		return pos;
+	}
+}
+
 Lexer::Lexer(Allocator *allocator): lexems(allocator)
 {
 }
@@ -14,7 +150,10 @@ void Lexer::Clear(unsigned count)
 
 void Lexer::Lexify(const char* code)
 {
-	lexems.reserve(2048);
+	const char *end = code + strlen(code);
+
+	// Lexeme count is estimated from an average lexeme size in a source that includes whitespace and comments
+	lexems.reserve(lexems.size() + unsigned(end - code) / 4 + 32);
 
 	const char *lineStart = code;
 	line = 0;
@@ -45,9 +184,7 @@ void Lexer::Lexify(const char* code)
 			continue;
 		case ' ':
 		case '\t':
-			code++;
-			while((unsigned char)(code[0] - 1) < ' ' && *code != '\r' && *code != '\n')
-				code++;
+			code = SkipSpaces(code + 1, end);
 			continue;
 		case '\"':
 			lType = lex_quotedstring;
@@ -80,7 +217,7 @@ void Lexer::Lexify(const char* code)
 					}
 					else
 					{
-						pos += 1;
+						pos = SkipQuotedText(pos + 1, end, '\"');
 					}
 				}
 
@@ -121,7 +258,7 @@ void Lexer::Lexify(const char* code)
 					}
 					else
 					{
-						pos += 1;
+						pos = SkipQuotedText(pos + 1, end, '\'');
 					}
 				}
 
@@ -181,8 +318,10 @@ void Lexer::Lexify(const char* code)
 				lType = lex_divset;
 				lLength = 2;
 			}else if(code[1] == '/'){
-				while(code[0] != '\n' && code[0] != '\0')
-					code++;
+				if(const char *lineEnd = (const char*)memchr(code, '\n', end - code))
+					code = lineEnd;
+				else
+					code = end;
 				continue;
 			}else if(code[1] == '*'){
 				code += 2;
@@ -228,7 +367,7 @@ void Lexer::Lexify(const char* code)
 							}
 							else
 							{
-								code += 1;
+								code = SkipQuotedText(code + 1, end, '\"');
 							}
 						}
 
@@ -254,7 +393,7 @@ void Lexer::Lexify(const char* code)
 					}
 					else
 					{
-						code++;
+						code = SkipCommentText(code + 1, end);
 					}
 				}
 				continue;
@@ -413,9 +552,7 @@ void Lexer::Lexify(const char* code)
 					pos++;
 				lLength = (int)(pos - code);
 			}else if(chartype_table[(unsigned char)*code] & ct_start_symbol){
-				const char *pos = code;
-				while(chartype_table[(unsigned char)*pos] & ct_symbol)
-					pos++;
+				const char *pos = SkipSymbol(code, end);
 				lLength = (int)(pos - code);
 
 				if(!(chartype_table[(unsigned char)*pos] & ct_symbol))
@@ -43,12 +43,85 @@ namespace NULLC
 
 		return size;
 	}
+
+	template<typename T>
+	void WriteImageArray(FastVector<char> &image, const FastVector<T> &arr)
+	{
+		image.push_back((const char*)&arr.count, sizeof(unsigned));
+		image.push_back((const char*)arr.data, arr.count * sizeof(arr.data[0]));
+	}
+
+	template<typename T>
+	bool ReadImageArray(const char *&pos, const char *end, FastVector<T> &arr)
+	{
+		unsigned count = 0;
+
+		if(unsigned(end - pos) < sizeof(unsigned))
+			return false;
+
+		memcpy(&count, pos, sizeof(unsigned));
+		pos += sizeof(unsigned);
+
+		if(unsigned(end - pos) / sizeof(arr.data[0]) < count)
+			return false;
+
+		arr.resize(count);
+
+		if(count)
+			memcpy(arr.data, pos, count * sizeof(arr.data[0]));
+		pos += count * sizeof(arr.data[0]);
+
+		return true;
+	}
+
+	// Addresses of the bound external functions belong to the process and are not included in the hash
+	unsigned GetModuleBinaryHash(ByteCode *bCode)
+	{
+		FastVector<char> binary;
+		binary.push_back((const char*)bCode, bCode->size);
+
+		ExternFuncInfo *fInfo = FindFirstFunc((ByteCode*)binary.data);
+
+		for(unsigned i = 0; i < bCode->functionCount - bCode->moduleFunctionCount; i++)
+		{
+			fInfo[i].funcPtrRaw = NULL;
+			fInfo[i].funcPtrWrapTarget = NULL;
+			fInfo[i].funcPtrWrap = NULL;
+		}
+
+		return GetStringHash(binary.data, binary.data + binary.size());
+	}
+
+	// Linked modules only keep a hash of the path that was used to find them, which doesn't include the import path
+	ByteCode* FindModuleBytecodeByHash(unsigned nameHash)
+	{
+		for(unsigned i = 0; const char *name = BinaryCache::EnumerateModules(i); i++)
+		{
+			if(GetStringHash(name) == nameHash)
+				return (ByteCode*)BinaryCache::GetBytecode(name);
+
+			for(unsigned k = 0; const char *importPath = BinaryCache::EnumImportPath(k); k++)
+			{
+				unsigned length = unsigned(strlen(importPath));
+
+				if(strncmp(name, importPath, length) == 0 && GetStringHash(name + length) == nameHash)
+					return (ByteCode*)BinaryCache::GetBytecode(name);
+			}
+		}
+
+		return NULL;
+	}
 }
 
 Linker::Linker(): exTypes(128), exTypeExtra(256), exTypeConstants(256), exVariables(128), exFunctions(256), exLocals(1024), exSymbols(8192), regVmJumpTargets(1024)
 {
 	globalVarSize = 0;
 
+	keptGlobalVarSize = 0;
+	keptRegVmCodeSize = 0;
+
+	codeVersion = 0;
+
 	typeMap.init();
 	funcMap.init();
 
@@ -110,6 +183,15 @@ void Linker::CleanCode()
 
 	globalVarSize = 0;
 
+	keptGlobalVarSize = 0;
+	keptRegVmCodeSize = 0;
+
+	codeVersion++;
+
+	moduleStates.clear();
+	typeRestores.clear();
+	moduleNameRestores.clear();
+
 	typeRemap.clear();
 	funcRemap.clear();
 	moduleRemap.clear();
@@ -125,6 +207,8 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 {
 	linkError[0] = 0;
 
+	codeVersion++;
+
 #ifdef VERBOSE_DEBUG_OUTPUT
 	for(unsigned indent = 0; indent < debugOutputIndent; indent++)
 		printf("  ");
@@ -136,6 +220,13 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 
 	ByteCode *bCode = (ByteCode*)code;
 
+	if(bCode->version != NULLC_BYTECODE_VERSION)
+	{
+		NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "Link Error: module binary version %d doesn't match the expected version %d", bCode->version, NULLC_BYTECODE_VERSION);
+		debugOutputIndent--;
+		return false;
+	}
+
 	ExternTypeInfo *tInfo = FindFirstType(bCode), *tStart = tInfo;
 	ExternMemberInfo *memberList = FindFirstMember(bCode);
 	ExternConstantInfo *constantList = FindFirstConstant(bCode);
@@ -242,6 +333,41 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 	printf("Function remap table is extended to %d functions (%d modules, %d new)\n", bCode->functionCount, moduleFuncCount, bCode->functionCount - moduleFuncCount);
 #endif
 
+	// All dependencies are linked, remember the state so that this module can be unlinked later
+	LinkerModuleState &state = *moduleStates.push_back();
+
+	state.moduleIndex = rootModule ? ~0u : exModules.size();
+
+	state.typeCount = exTypes.size();
+	state.typeExtraCount = exTypeExtra.size();
+	state.typeConstantCount = exTypeConstants.size();
+	state.variableCount = exVariables.size();
+	state.functionCount = exFunctions.size();
+	state.functionExplicitTypeArrayOffsetCount = exFunctionExplicitTypeArrayOffsets.size();
+	state.functionExplicitTypeCount = exFunctionExplicitTypes.size();
+	state.localCount = exLocals.size();
+	state.moduleCount = exModules.size();
+	state.symbolCount = exSymbols.size();
+	state.sourceCount = exSource.size();
+
+	state.regVmCodeCount = exRegVmCode.size();
+	state.regVmSourceInfoCount = exRegVmSourceInfo.size();
+	state.regVmConstantCount = exRegVmConstants.size();
+	state.regVmRegKillInfoCount = exRegVmRegKillInfo.size();
+	state.regVmJumpTargetCount = regVmJumpTargets.size();
+
+	state.globalVarSize = globalVarSize;
+
+	state.typeRestoreCount = typeRestores.size();
+	state.moduleNameRestoreCount = moduleNameRestores.size();
+
+#ifdef NULLC_LLVM_SUPPORT
+	state.llvmModuleCount = llvmModuleSizes.size();
+	state.llvmModuleCodeCount = llvmModuleCodes.size();
+	state.llvmTypeRemapValueCount = llvmTypeRemapValues.size();
+	state.llvmFuncRemapValueCount = llvmFuncRemapValues.size();
+#endif
+
 	funcRemap.resize(bCode->functionCount);
 	for(unsigned int i = moduleFuncCount; i < bCode->functionCount; i++)
 		funcRemap[i] = (exFunctions.size() ? exFunctions.size() - moduleFuncCount : 0) + i;
@@ -306,8 +432,12 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 		for(unsigned int n = mInfo->funcStart; n < mInfo->funcStart + mInfo->funcCount; n++)
 			funcRemap[n] = rInfo->funcStart + n - mInfo->funcStart;
 		if(!rInfo->nameOffset)
+		{
 			rInfo->nameOffset = mInfo->nameOffset + oldSymbolSize;
 
+			moduleNameRestores.push_back(loadedId);
+		}
+
 		moduleRemap[i] = loadedId;
 
 #ifdef VERBOSE_DEBUG_OUTPUT
@@ -368,6 +498,11 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 			{
 				assert(tInfo->subCat == ExternTypeInfo::CAT_CLASS);
 
+				LinkerTypeRestore &restore = *typeRestores.push_back();
+
+				restore.index = *lastType;
+				restore.info = lastTypeInfo;
+
 				lastTypeInfo = *tInfo;
 				lastTypeInfo.offsetToName += oldSymbolSize;
 
@@ -587,6 +722,9 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 			// It is allowed for generic base function and generic function instances
 			if(fInfo->isGenericInstance || fInfo->funcType == 0)
 			{
+				// Attributes recorded by any module, like inlining of the instance, apply to every copy
+				exFunctions[index].attributes |= fInfo->attributes;
+
 				exFunctions.push_back(exFunctions[index]);
 				funcMap.insert(exFunctions.back().nameHash, exFunctions.size()-1);
 
@@ -683,12 +821,15 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 
 	assert((fInfo = FindFirstFunc(bCode)) != NULL); // this is fine, we need this assignment only in debug configuration
 
-	// Fix register VM command arguments
-	unsigned pos = oldRegVmCodeSize;
-	while(pos < exRegVmCode.size())
+	// Fix register VM command arguments, module lists all instructions that have to be adjusted
+	unsigned *regVmRelocations = FindRegVmRelocations(bCode);
+
+	for(unsigned i = 0; i < bCode->regVmRelocationCount; i++)
 	{
-		RegVmCmd &cmd = exRegVmCode[pos];
-		pos++;
+		assert(regVmRelocations[i] < bCode->regVmCodeSize);
+
+		RegVmCmd &cmd = exRegVmCode[oldRegVmCodeSize + regVmRelocations[i]];
+
 		switch(cmd.code)
 		{
 		case rviLoadByte:
@@ -800,6 +941,7 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 			exRegVmConstants[cmd.argument] = typeRemap[exRegVmConstants[cmd.argument]];
 			break;
 		case rviConvertPtr:
+		case rviNewObject:
 			cmd.argument = typeRemap[cmd.argument];
 			break;
 		case rviFuncAddr:
@@ -881,6 +1023,121 @@ bool Linker::LinkCode(const char *code, const char *moduleName, bool rootModule)
 	return true;
 }
 
+unsigned Linker::FindModuleState(const char *moduleName)
+{
+	linkError[0] = 0;
+
+	// Find the state before the module (or the last main module) was linked
+	unsigned stateIndex = ~0u;
+
+	if(moduleName)
+	{
+		unsigned nameHash = NULLC::GetStringHash(moduleName);
+
+		for(unsigned i = 0; i < moduleStates.size() && stateIndex == ~0u; i++)
+		{
+			unsigned moduleIndex = moduleStates[i].moduleIndex;
+
+			if(moduleIndex != ~0u && moduleIndex < exModules.size() && exModules[moduleIndex].nameHash == nameHash)
+				stateIndex = i;
+		}
+	}
+	else
+	{
+		for(unsigned i = moduleStates.size(); i > 0 && stateIndex == ~0u; i--)
+		{
+			if(moduleStates[i - 1].moduleIndex == ~0u)
+				stateIndex = i - 1;
+		}
+	}
+
+	if(stateIndex == ~0u)
+	{
+		if(moduleName)
+			NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "Link Error: module '%s' is not linked", moduleName);
+		else
+			NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "Link Error: main module is not linked");
+	}
+
+	return stateIndex;
+}
+
+bool Linker::UnlinkModule(const char *moduleName)
+{
+	unsigned stateIndex = FindModuleState(moduleName);
+
+	if(stateIndex == ~0u)
+		return false;
+
+	codeVersion++;
+
+	LinkerModuleState state = moduleStates[stateIndex];
+
+	// Undo modifications of the data that is kept
+	for(unsigned i = typeRestores.size(); i > state.typeRestoreCount; i--)
+	{
+		LinkerTypeRestore &restore = typeRestores[i - 1];
+
+		exTypes[restore.index] = restore.info;
+	}
+
+	for(unsigned i = state.moduleNameRestoreCount; i < moduleNameRestores.size(); i++)
+	{
+		if(moduleNameRestores[i] < state.moduleCount)
+			exModules[moduleNameRestores[i]].nameOffset = 0;
+	}
+
+	exTypes.shrink(state.typeCount);
+	exTypeExtra.shrink(state.typeExtraCount);
+	exTypeConstants.shrink(state.typeConstantCount);
+	exVariables.shrink(state.variableCount);
+	exFunctions.shrink(state.functionCount);
+	exFunctionExplicitTypeArrayOffsets.shrink(state.functionExplicitTypeArrayOffsetCount);
+	exFunctionExplicitTypes.shrink(state.functionExplicitTypeCount);
+	exLocals.shrink(state.localCount);
+	exModules.shrink(state.moduleCount);
+	exSymbols.shrink(state.symbolCount);
+	exSource.shrink(state.sourceCount);
+
+	// Code memory is not released, it might be referenced from the executor call stack
+	exRegVmCode.shrink(state.regVmCodeCount);
+	exRegVmExecCount.shrink(state.regVmCodeCount);
+	exRegVmSourceInfo.shrink(state.regVmSourceInfoCount);
+	exRegVmConstants.shrink(state.regVmConstantCount);
+	exRegVmRegKillInfo.shrink(state.regVmRegKillInfoCount);
+	regVmJumpTargets.shrink(state.regVmJumpTargetCount);
+
+	globalVarSize = state.globalVarSize;
+
+	keptGlobalVarSize = state.globalVarSize;
+	keptRegVmCodeSize = state.regVmCodeCount;
+
+	typeRestores.shrink(state.typeRestoreCount);
+	moduleNameRestores.shrink(state.moduleNameRestoreCount);
+
+	moduleStates.shrink(stateIndex);
+
+#ifdef NULLC_LLVM_SUPPORT
+	llvmModuleSizes.shrink(state.llvmModuleCount);
+	llvmModuleCodes.shrink(state.llvmModuleCodeCount);
+
+	llvmTypeRemapSizes.shrink(state.llvmModuleCount);
+	llvmTypeRemapOffsets.shrink(state.llvmModuleCount);
+	llvmTypeRemapValues.shrink(state.llvmTypeRemapValueCount);
+
+	llvmFuncRemapSizes.shrink(state.llvmModuleCount);
+	llvmFuncRemapOffsets.shrink(state.llvmModuleCount);
+	llvmFuncRemapValues.shrink(state.llvmFuncRemapValueCount);
+#endif
+
+	funcMap.clear();
+
+	for(unsigned i = 0; i < exFunctions.size(); i++)
+		funcMap.insert(exFunctions[i].nameHash, i);
+
+	return true;
+}
+
 bool Linker::SaveRegVmListing(OutputContext &output, bool withProfileInfo)
 {
 	unsigned line = 0, lastLine = ~0u;
@@ -985,7 +1242,7 @@ bool Linker::SaveRegVmListing(OutputContext &output, bool withProfileInfo)
 
 		if(cmd.code == rviCall || cmd.code == rviFuncAddr)
 			output.Printf(" (%s)", exSymbols.data + exFunctions[exRegVmCode[i].argument].offsetToName);
-		else if(cmd.code == rviConvertPtr)
+		else if(cmd.code == rviConvertPtr || cmd.code == rviNewObject)
 			output.Printf(" (%s)", exSymbols.data + exTypes[exRegVmCode[i].argument].offsetToName);
 
 		output.Printf("\n");
@@ -1009,6 +1266,241 @@ bool Linker::SaveRegVmListing(OutputContext &output, bool withProfileInfo)
 	return true;
 }
 
+void Linker::SaveLinkedData(FastVector<char> &data)
+{
+	NULLC::WriteImageArray(data, exTypes);
+	NULLC::WriteImageArray(data, exTypeExtra);
+	NULLC::WriteImageArray(data, exTypeConstants);
+	NULLC::WriteImageArray(data, exVariables);
+	NULLC::WriteImageArray(data, exFunctions);
+	NULLC::WriteImageArray(data, exFunctionExplicitTypeArrayOffsets);
+	NULLC::WriteImageArray(data, exFunctionExplicitTypes);
+	NULLC::WriteImageArray(data, exLocals);
+	NULLC::WriteImageArray(data, exModules);
+	NULLC::WriteImageArray(data, exSymbols);
+	NULLC::WriteImageArray(data, exSource);
+	NULLC::WriteImageArray(data, exImportPaths);
+	NULLC::WriteImageArray(data, exMainModuleName);
+	NULLC::WriteImageArray(data, exRegVmCode);
+	NULLC::WriteImageArray(data, exRegVmSourceInfo);
+	NULLC::WriteImageArray(data, exRegVmConstants);
+	NULLC::WriteImageArray(data, exRegVmRegKillInfo);
+	NULLC::WriteImageArray(data, regVmJumpTargets);
+
+	data.push_back((const char*)&globalVarSize, sizeof(globalVarSize));
+}
+
+bool Linker::LoadLinkedData(const char *&pos, const char *end)
+{
+	bool success = true;
+
+	success = success && NULLC::ReadImageArray(pos, end, exTypes);
+	success = success && NULLC::ReadImageArray(pos, end, exTypeExtra);
+	success = success && NULLC::ReadImageArray(pos, end, exTypeConstants);
+	success = success && NULLC::ReadImageArray(pos, end, exVariables);
+	success = success && NULLC::ReadImageArray(pos, end, exFunctions);
+	success = success && NULLC::ReadImageArray(pos, end, exFunctionExplicitTypeArrayOffsets);
+	success = success && NULLC::ReadImageArray(pos, end, exFunctionExplicitTypes);
+	success = success && NULLC::ReadImageArray(pos, end, exLocals);
+	success = success && NULLC::ReadImageArray(pos, end, exModules);
+	success = success && NULLC::ReadImageArray(pos, end, exSymbols);
+	success = success && NULLC::ReadImageArray(pos, end, exSource);
+	success = success && NULLC::ReadImageArray(pos, end, exImportPaths);
+	success = success && NULLC::ReadImageArray(pos, end, exMainModuleName);
+	success = success && NULLC::ReadImageArray(pos, end, exRegVmCode);
+	success = success && NULLC::ReadImageArray(pos, end, exRegVmSourceInfo);
+	success = success && NULLC::ReadImageArray(pos, end, exRegVmConstants);
+	success = success && NULLC::ReadImageArray(pos, end, exRegVmRegKillInfo);
+	success = success && NULLC::ReadImageArray(pos, end, regVmJumpTargets);
+
+	if(!success || unsigned(end - pos) < sizeof(globalVarSize))
+		return false;
+
+	memcpy(&globalVarSize, pos, sizeof(globalVarSize));
+	pos += sizeof(globalVarSize);
+
+	return true;
+}
+
+void Linker::SaveImage(FastVector<char> &image)
+{
+	SaveLinkedData(image);
+
+	// Program image can only be loaded with the same module binaries
+	FastVector<unsigned> moduleBinaryHashes;
+
+	for(unsigned i = 0; i < exModules.size(); i++)
+	{
+		ByteCode *bCode = NULLC::FindModuleBytecodeByHash(exModules[i].nameHash);
+
+		moduleBinaryHashes.push_back(bCode ? NULLC::GetModuleBinaryHash(bCode) : 0);
+	}
+
+	NULLC::WriteImageArray(image, moduleBinaryHashes);
+}
+
+void Linker::SaveState(FastVector<char> &state)
+{
+	SaveLinkedData(state);
+
+	NULLC::WriteImageArray(state, exRegVmExecCount);
+
+	NULLC::WriteImageArray(state, moduleStates);
+	NULLC::WriteImageArray(state, typeRestores);
+	NULLC::WriteImageArray(state, moduleNameRestores);
+
+#ifdef NULLC_LLVM_SUPPORT
+	NULLC::WriteImageArray(state, llvmModuleSizes);
+	NULLC::WriteImageArray(state, llvmModuleCodes);
+	NULLC::WriteImageArray(state, llvmTypeRemapSizes);
+	NULLC::WriteImageArray(state, llvmTypeRemapOffsets);
+	NULLC::WriteImageArray(state, llvmTypeRemapValues);
+	NULLC::WriteImageArray(state, llvmFuncRemapSizes);
+	NULLC::WriteImageArray(state, llvmFuncRemapOffsets);
+	NULLC::WriteImageArray(state, llvmFuncRemapValues);
+#endif
+
+	state.push_back((const char*)&keptGlobalVarSize, sizeof(keptGlobalVarSize));
+	state.push_back((const char*)&keptRegVmCodeSize, sizeof(keptRegVmCodeSize));
+}
+
+void Linker::RestoreState(const char *pos, const char *end)
+{
+	// Data is copied back into the existing array storage
+	bool success = LoadLinkedData(pos, end);
+
+	success = success && NULLC::ReadImageArray(pos, end, exRegVmExecCount);
+
+	success = success && NULLC::ReadImageArray(pos, end, moduleStates);
+	success = success && NULLC::ReadImageArray(pos, end, typeRestores);
+	success = success && NULLC::ReadImageArray(pos, end, moduleNameRestores);
+
+#ifdef NULLC_LLVM_SUPPORT
+	success = success && NULLC::ReadImageArray(pos, end, llvmModuleSizes);
+	success = success && NULLC::ReadImageArray(pos, end, llvmModuleCodes);
+	success = success && NULLC::ReadImageArray(pos, end, llvmTypeRemapSizes);
+	success = success && NULLC::ReadImageArray(pos, end, llvmTypeRemapOffsets);
+	success = success && NULLC::ReadImageArray(pos, end, llvmTypeRemapValues);
+	success = success && NULLC::ReadImageArray(pos, end, llvmFuncRemapSizes);
+	success = success && NULLC::ReadImageArray(pos, end, llvmFuncRemapOffsets);
+	success = success && NULLC::ReadImageArray(pos, end, llvmFuncRemapValues);
+#endif
+
+	assert(success && unsigned(end - pos) == sizeof(keptGlobalVarSize) + sizeof(keptRegVmCodeSize));
+	(void)success;
+
+	memcpy(&keptGlobalVarSize, pos, sizeof(keptGlobalVarSize));
+	pos += sizeof(keptGlobalVarSize);
+
+	memcpy(&keptRegVmCodeSize, pos, sizeof(keptRegVmCodeSize));
+	pos += sizeof(keptRegVmCodeSize);
+
+	codeVersion++;
+
+	funcMap.clear();
+
+	for(unsigned i = 0; i < exFunctions.size(); i++)
+		funcMap.insert(exFunctions[i].nameHash, i);
+}
+
+bool Linker::LoadImage(const char *&pos, const char *end)
+{
+	CleanCode();
+
+	linkError[0] = 0;
+
+	FastVector<unsigned> moduleBinaryHashes;
+
+	if(!LoadLinkedData(pos, end) || !NULLC::ReadImageArray(pos, end, moduleBinaryHashes) || moduleBinaryHashes.size() != exModules.size())
+	{
+		CleanCode();
+
+		NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "ERROR: program image is corrupted");
+		return false;
+	}
+
+	exRegVmExecCount.resize(exRegVmCode.size());
+	memset(exRegVmExecCount.data, 0, exRegVmExecCount.size() * sizeof(exRegVmExecCount[0]));
+
+	for(unsigned i = 0; i < exFunctions.size(); i++)
+		funcMap.insert(exFunctions[i].nameHash, i);
+
+	// External function addresses belong to the process that saved the image, take them from the module binaries bound in this process
+	FastVector<bool> resolved;
+	resolved.resize(exFunctions.size());
+	memset(resolved.data, 0, resolved.size() * sizeof(resolved[0]));
+
+	for(unsigned i = 0; i < exModules.size(); i++)
+	{
+		ExternModuleInfo &moduleInfo = exModules[i];
+
+		ByteCode *bCode = NULLC::FindModuleBytecodeByHash(moduleInfo.nameHash);
+
+		if(moduleBinaryHashes[i] && (!bCode || NULLC::GetModuleBinaryHash(bCode) != moduleBinaryHashes[i]))
+		{
+			CleanCode();
+
+			NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "ERROR: program image module binary doesn't match the loaded module");
+			return false;
+		}
+
+		if(!bCode || bCode->functionCount - bCode->moduleFunctionCount != moduleInfo.funcCount)
+			continue;
+
+		ExternFuncInfo *fInfo = FindFirstFunc(bCode);
+
+		for(unsigned k = 0; k < moduleInfo.funcCount; k++)
+		{
+			ExternFuncInfo &function = exFunctions[moduleInfo.funcStart + k];
+
+			if((!function.funcPtrRaw && !function.funcPtrWrap) || function.nameHash != fInfo[k].nameHash)
+				continue;
+
+			if(!fInfo[k].funcPtrRaw && !fInfo[k].funcPtrWrap)
+				continue;
+
+			function.funcPtrRaw = fInfo[k].funcPtrRaw;
+			function.funcPtrWrapTarget = fInfo[k].funcPtrWrapTarget;
+			function.funcPtrWrap = fInfo[k].funcPtrWrap;
+
+			resolved[moduleInfo.funcStart + k] = true;
+		}
+	}
+
+	for(unsigned i = 0; i < exFunctions.size(); i++)
+	{
+		ExternFuncInfo &function = exFunctions[i];
+
+		if((!function.funcPtrRaw && !function.funcPtrWrap) || resolved[i])
+			continue;
+
+		// Generic function instances can be bound to an external function from another module
+		for(unsigned k = 0; k < i && !resolved[i]; k++)
+		{
+			ExternFuncInfo &source = exFunctions[k];
+
+			if(resolved[k] && source.nameHash == function.nameHash && source.funcType == function.funcType)
+			{
+				function.funcPtrRaw = source.funcPtrRaw;
+				function.funcPtrWrapTarget = source.funcPtrWrapTarget;
+				function.funcPtrWrap = source.funcPtrWrap;
+
+				resolved[i] = true;
+			}
+		}
+
+		if(!resolved[i])
+		{
+			NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "Link Error: External function '%s' '%s' doesn't have implementation", exSymbols.data + function.offsetToName, exSymbols.data + exTypes[function.funcType].offsetToName);
+
+			CleanCode();
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void Linker::CollectDebugInfo(FastVector<unsigned char*> *instAddress)
 {
 	nullcModuleBytecodeSize = 0;
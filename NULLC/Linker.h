@@ -12,6 +12,49 @@ struct OutputContext;
 
 const int LINK_ERROR_BUFFER_SIZE = 512;
 
+// Sizes of linker arrays before a module was linked, used to unlink it together with everything that was linked after it
+struct LinkerModuleState
+{
+	unsigned	moduleIndex; // ~0u for the main module
+
+	unsigned	typeCount;
+	unsigned	typeExtraCount;
+	unsigned	typeConstantCount;
+	unsigned	variableCount;
+	unsigned	functionCount;
+	unsigned	functionExplicitTypeArrayOffsetCount;
+	unsigned	functionExplicitTypeCount;
+	unsigned	localCount;
+	unsigned	moduleCount;
+	unsigned	symbolCount;
+	unsigned	sourceCount;
+
+	unsigned	regVmCodeCount;
+	unsigned	regVmSourceInfoCount;
+	unsigned	regVmConstantCount;
+	unsigned	regVmRegKillInfoCount;
+	unsigned	regVmJumpTargetCount;
+
+	unsigned	globalVarSize;
+
+	unsigned	typeRestoreCount;
+	unsigned	moduleNameRestoreCount;
+
+#ifdef NULLC_LLVM_SUPPORT
+	unsigned	llvmModuleCount;
+	unsigned	llvmModuleCodeCount;
+	unsigned	llvmTypeRemapValueCount;
+	unsigned	llvmFuncRemapValueCount;
+#endif
+};
+
+// Previous state of a type that was completed by a module
+struct LinkerTypeRestore
+{
+	unsigned		index;
+	ExternTypeInfo	info;
+};
+
 class Linker
 {
 public:
@@ -20,8 +63,20 @@ public:
 
 	void	CleanCode();
 	bool	LinkCode(const char *bytecode, const char *moduleName, bool rootModule);
+	unsigned	FindModuleState(const char *moduleName);
+	bool	UnlinkModule(const char *moduleName);
 	bool	SaveRegVmListing(OutputContext &output, bool withProfileInfo);
 
+	void	SaveLinkedData(FastVector<char> &data);
+	bool	LoadLinkedData(const char *&pos, const char *end);
+
+	void	SaveImage(FastVector<char> &image);
+	bool	LoadImage(const char *&pos, const char *end);
+
+	// Copy of all linked data, a failed relink restores it
+	void	SaveState(FastVector<char> &state);
+	void	RestoreState(const char *pos, const char *end);
+
 	void	CollectDebugInfo(FastVector<unsigned char*> *instAddress);
 
 	const char*	GetLinkError();
@@ -58,6 +113,17 @@ public:
 
 	unsigned int					globalVarSize;
 
+	// Global variables and code of the modules that were kept by the last unlink, global code execution skips them
+	unsigned int					keptGlobalVarSize;
+	unsigned int					keptRegVmCodeSize;
+
+	// Incremented on every change of the linked code, data that is derived from it can be rebuilt on a version change
+	unsigned int					codeVersion;
+
+	FastVector<LinkerModuleState>	moduleStates;
+	FastVector<LinkerTypeRestore>	typeRestores;
+	FastVector<unsigned>			moduleNameRestores;
+
 #ifdef NULLC_LLVM_SUPPORT
 	FastVector<unsigned int>	llvmModuleSizes;
 	FastVector<char>			llvmModuleCodes;
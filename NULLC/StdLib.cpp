@@ -8,6 +8,7 @@
 #include "stdafx.h"
 #include "Pool.h"
 #include "Tree.h"
+#include "HashMap.h"
 
 #include "Executor_Common.h"
 #include "Linker.h"
@@ -40,14 +41,21 @@ namespace
 namespace NULLC
 {
 	static Linker	*linker = NULL;
+
+	// Objects waiting for their finalizers to run, they are kept alive by the collector until the finalizer is called
+	FastVector<NULLCRef>	finalizeQueue;
+	// Objects that are finalized by the active __finalizeObjects call
 	FastVector<NULLCRef>	finalizeList;
 
+	// When finalization is deferred, collections only fill the queue and the host runs the finalizers later
+	bool deferFinalization = false;
+	bool finalizersRunning = false;
+
 	static uintptr_t OBJECT_VISIBLE		= 1 << 0;
 	static uintptr_t OBJECT_FREED		= 1 << 1;
 	static uintptr_t OBJECT_FINALIZABLE	= 1 << 2;
 	static uintptr_t OBJECT_FINALIZED	= 1 << 3;
 	static uintptr_t OBJECT_ARRAY		= 1 << 4;
-	static uintptr_t OBJECT_MASK		= OBJECT_VISIBLE | OBJECT_FREED;
 
 	void FinalizeObject(markerType& marker, char* base)
 	{
@@ -62,25 +70,201 @@ namespace NULLC
 
 			for(unsigned i = 0; i < count; i++)
 			{
-				NULLC::finalizeList.push_back(r);
+				NULLC::finalizeQueue.push_back(r);
 				r.ptr += typeInfo.size;
 			}
 		}
 		else
 		{
 			NULLCRef r = { (unsigned)marker >> 8, base + sizeof(markerType) }; // skip over marker
-			NULLC::finalizeList.push_back(r);
+			NULLC::finalizeQueue.push_back(r);
 		}
 		marker |= NULLC::OBJECT_FINALIZED;
 	}
 }
 
+namespace NULLC
+{
+	// Pool pages are allocated at an alignment equal to their size, so the page that holds a pointer is found by masking off the low address bits
+	const unsigned poolPageShift = 17;
+	const unsigned poolPageSize = 1u << poolPageShift;
+
+	// Header at the start of each pool page
+	struct PoolPageHeader
+	{
+		char		*start;
+		char		*end;
+		unsigned	elemSize;
+	};
+
+	// Space reserved for the header is a multiple of 16 to keep the block alignment
+	const unsigned poolPageHeaderSize = 32;
+
+	// Space left for blocks after the header, block alignment padding and the page list link
+	const unsigned poolPageBlockSpace = poolPageSize - poolPageHeaderSize - 16 - sizeof(void*);
+
+	// Pages are carved out of larger chunks, chunk has an additional page of space to align the first page
+	// When chunks are reserved from the system in huge pages, chunk is aligned to the huge page size and every page of it is used
+	const unsigned poolChunkPages = 8;
+
+	struct PoolChunk
+	{
+		char		*data;
+		unsigned	size;
+	};
+
+	FastVector<PoolChunk>	poolChunks;
+
+	char	*poolChunkNext = NULL;
+	char	*poolChunkEnd = NULL;
+
+	// Open addressing set of page numbers that belong to the pools, since a pointer can't be dereferenced before it is known to point into a page
+	uintptr_t	*poolPageSet = NULL;
+	unsigned	poolPageSetSize = 0;
+	unsigned	poolPageSetCount = 0;
+
+	unsigned PoolPageHash(uintptr_t page)
+	{
+		unsigned hash = unsigned(page) * 2654435769u;
+
+		return hash ^ (hash >> 16);
+	}
+
+	void InsertPoolPage(uintptr_t page)
+	{
+		// Keep occupancy at <50%
+		if((poolPageSetCount + 1) * 2 > poolPageSetSize)
+		{
+			uintptr_t *oldSet = poolPageSet;
+			unsigned oldSize = poolPageSetSize;
+
+			poolPageSetSize = oldSize ? oldSize * 2 : 64;
+			poolPageSet = (uintptr_t*)NULLC::alloc(sizeof(uintptr_t) * poolPageSetSize);
+			memset(poolPageSet, 0, sizeof(uintptr_t) * poolPageSetSize);
+
+			poolPageSetCount = 0;
+
+			for(unsigned i = 0; i < oldSize; i++)
+			{
+				if(oldSet[i])
+					InsertPoolPage(oldSet[i]);
+			}
+
+			if(oldSet)
+				NULLC::dealloc(oldSet);
+		}
+
+		unsigned mask = poolPageSetSize - 1;
+		unsigned bucket = PoolPageHash(page) & mask;
+
+		while(poolPageSet[bucket])
+			bucket = (bucket + 1) & mask;
+
+		poolPageSet[bucket] = page;
+		poolPageSetCount++;
+	}
+
+	bool ContainsPoolPage(uintptr_t page)
+	{
+		if(!poolPageSetCount)
+			return false;
+
+		unsigned mask = poolPageSetSize - 1;
+		unsigned bucket = PoolPageHash(page) & mask;
+
+		while(uintptr_t item = poolPageSet[bucket])
+		{
+			if(item == page)
+				return true;
+
+			bucket = (bucket + 1) & mask;
+		}
+
+		return false;
+	}
+
+	void* AllocPoolPage()
+	{
+		if(poolChunkNext == poolChunkEnd)
+		{
+			PoolChunk chunk;
+
+			chunk.size = NULLC::pageAllocationSize(poolPageSize * (poolChunkPages + 1));
+			chunk.data = (char*)(NULLC::pageAllocation ? NULLC::allocPages(chunk.size) : NULLC::alloc(chunk.size));
+
+			if(!chunk.data)
+				return NULL;
+
+			poolChunks.push_back(chunk);
+
+			poolChunkNext = (char*)((uintptr_t(chunk.data) + poolPageSize - 1) & ~uintptr_t(poolPageSize - 1));
+			poolChunkEnd = (char*)((uintptr_t(chunk.data) + chunk.size) & ~uintptr_t(poolPageSize - 1));
+		}
+
+		char *page = poolChunkNext;
+
+		poolChunkNext += poolPageSize;
+
+		InsertPoolPage(uintptr_t(page) >> poolPageShift);
+
+		return page;
+	}
+
+	void ClearPoolPages()
+	{
+		for(unsigned i = 0; i < poolChunks.size(); i++)
+		{
+			if(NULLC::pageAllocation)
+				NULLC::deallocPages(poolChunks[i].data, poolChunks[i].size);
+			else
+				NULLC::dealloc(poolChunks[i].data);
+		}
+
+		poolChunks.clear();
+
+		poolChunkNext = NULL;
+		poolChunkEnd = NULL;
+
+		if(poolPageSet)
+			memset(poolPageSet, 0, sizeof(uintptr_t) * poolPageSetSize);
+
+		poolPageSetCount = 0;
+	}
+
+	void ResetPoolPages()
+	{
+		ClearPoolPages();
+
+		poolChunks.reset();
+
+		if(poolPageSet)
+			NULLC::dealloc(poolPageSet);
+
+		poolPageSet = NULL;
+		poolPageSetSize = 0;
+	}
+
+	PoolPageHeader* FindPoolPage(void *ptr)
+	{
+		uintptr_t page = uintptr_t(ptr) >> poolPageShift;
+
+		if(!ContainsPoolPage(page))
+			return NULL;
+
+		PoolPageHeader *header = (PoolPageHeader*)(page << poolPageShift);
+
+		if(ptr < header->start || ptr >= header->end)
+			return NULL;
+
+		return header;
+	}
+}
+
 template<int elemSize>
 union SmallBlock
 {
 	char			data[elemSize];
 	markerType		marker;
-	SmallBlock		*next;
 };
 
 #pragma pack(push, 1)
@@ -89,25 +273,64 @@ struct LargeBlock
 {
 	typedef SmallBlock<elemSize> Block;
 
+	NULLC::PoolPageHeader	header;
+
 	// Padding is used to break the 16 byte alignment of pages in a way that after a marker offset is added to the block, the object pointer will be correctly aligned
-	char padding[16 - sizeof(markerType)];
+	char padding[NULLC::poolPageHeaderSize - sizeof(NULLC::PoolPageHeader) + 16 - sizeof(markerType)];
 	Block		page[countInBlock];
 
 	LargeBlock	*next;
 };
 #pragma pack(pop)
 
+class ObjectBlockPoolBase
+{
+public:
+	ObjectBlockPoolBase(unsigned blockSize, unsigned blocksInPage): blockSize(blockSize), blocksInPage(blocksInPage), pageCount(0)
+	{
+		buffer.current = NULL;
+		buffer.end = NULL;
+		buffer.blockSize = blockSize;
+	}
+
+	virtual ~ObjectBlockPoolBase()
+	{
+	}
+
+	virtual void* Alloc() = 0;
+
+	virtual void Reset() = 0;
+
+	virtual void Mark(unsigned int number) = 0;
+	virtual void CollectUnmarked() = 0;
+	virtual void FinalizePending() = 0;
+	virtual unsigned FreePending(unsigned &usedMemory) = 0;
+
+	virtual unsigned UsedCount() = 0;
+
+	unsigned	blockSize;
+	unsigned	blocksInPage;
+
+	unsigned	pageCount;
+
+	// Run of free zeroed blocks that allocations are bumped from, generated code reads and advances it directly
+	NULLC::AllocationBuffer	buffer;
+};
+
 template<int elemSize, int countInBlock>
-class ObjectBlockPool
+class ObjectBlockPool: public ObjectBlockPoolBase
 {
 	typedef SmallBlock<elemSize> MySmallBlock;
 	typedef LargeBlock<elemSize, countInBlock> MyLargeBlock;
 public:
-	ObjectBlockPool()
+	ObjectBlockPool(): ObjectBlockPoolBase(elemSize, countInBlock)
 	{
-		freeBlocks = &lastBlock;
+		assert(sizeof(MyLargeBlock) <= NULLC::poolPageSize);
+
 		activePages = NULL;
-		lastNum = countInBlock;
+
+		sweepPage = NULL;
+		sweepIndex = 0;
 	}
 
 	~ObjectBlockPool()
@@ -119,102 +342,95 @@ public:
 	{
 		if(!activePages)
 			return;
-		do
-		{
-			MyLargeBlock* following = activePages->next;
-			NULLC::alignedDealloc(activePages);
-			activePages = following;
-		}while(activePages != NULL);
-
-		freeBlocks = &lastBlock;
+		// Page memory is owned by the page chunks
 		activePages = NULL;
-		lastNum = countInBlock;
 
-		sortedPages.reset();
+		sweepPage = NULL;
+		sweepIndex = 0;
+
+		buffer.current = NULL;
+		buffer.end = NULL;
+
+		pageCount = 0;
+
 		objectsToFinalize.reset();
 		objectsToFree.reset();
 	}
 
+	// Returned block is zeroed, except for the marker
 	void* Alloc()
 	{
-		MySmallBlock*	result;
-		if(freeBlocks && freeBlocks != &lastBlock)
-		{
-			result = freeBlocks;
-			freeBlocks = (MySmallBlock*)((intptr_t)freeBlocks->next & ~NULLC::OBJECT_MASK);
-		}else{
-			if(lastNum == countInBlock)
-			{
-				MyLargeBlock* newPage = new(NULLC::alignedAlloc(sizeof(MyLargeBlock))) MyLargeBlock;
-				memset(newPage, 0, sizeof(MyLargeBlock));
-				newPage->next = activePages;
-				activePages = newPage;
-				lastNum = 0;
-				sortedPages.push_back(newPage);
-				int index = sortedPages.size() - 1;
-				while(index > 0 && sortedPages[index] < sortedPages[index - 1])
-				{
-					MyLargeBlock *tmp = sortedPages[index];
-					sortedPages[index] = sortedPages[index - 1];
-					sortedPages[index - 1] = tmp;
-					index--;
-				}
-			}
-			result = &activePages->page[lastNum++];
-		}
-		return result;
-	}
+		if(buffer.current == buffer.end)
+			Refill();
 
-	void Free(void* ptr)
-	{
-		if(!ptr)
-			return;
-		MySmallBlock* freedBlock = static_cast<MySmallBlock*>(static_cast<void*>(ptr));
-		freedBlock->next = (MySmallBlock*)((intptr_t)freeBlocks | NULLC::OBJECT_FREED);
-		freeBlocks = freedBlock;
+		void *result = buffer.current;
+		buffer.current += elemSize;
+		return result;
 	}
 
-	bool IsBasePointer(void* ptr)
+	void Refill()
 	{
-		MyLargeBlock *curr = activePages;
-		while(curr)
+		// Continue the sweep to the next run of freed blocks
+		while(sweepPage)
 		{
-			if((char*)ptr >= (char*)curr->page && (char*)ptr <= (char*)curr->page + sizeof(curr->page))
+			while(sweepIndex < countInBlock && !(sweepPage->page[sweepIndex].marker & NULLC::OBJECT_FREED))
+				sweepIndex++;
+
+			unsigned start = sweepIndex;
+
+			while(sweepIndex < countInBlock && (sweepPage->page[sweepIndex].marker & NULLC::OBJECT_FREED))
+				sweepIndex++;
+
+			if(start != sweepIndex)
 			{
-				if(((unsigned int)(intptr_t)((char*)ptr - (char*)curr->page) & (elemSize - 1)) == sizeof(markerType))
-					return true;
+				MySmallBlock *first = &sweepPage->page[start];
+
+				memset(first, 0, (sweepIndex - start) * sizeof(MySmallBlock));
+
+				for(unsigned i = start; i < sweepIndex; i++)
+					sweepPage->page[i].marker = NULLC::OBJECT_FREED;
+
+				buffer.current = first->data;
+				buffer.end = first->data + (sweepIndex - start) * sizeof(MySmallBlock);
+				return;
 			}
-			curr = curr->next;
+
+			sweepPage = sweepPage->next;
+			sweepIndex = 0;
 		}
-		return false;
+
+		MyLargeBlock* newPage = new(NULLC::AllocPoolPage()) MyLargeBlock;
+		memset(newPage, 0, sizeof(MyLargeBlock));
+
+		newPage->header.start = newPage->page[0].data;
+		newPage->header.end = newPage->page[0].data + countInBlock * sizeof(MySmallBlock);
+		newPage->header.elemSize = elemSize;
+
+		for(unsigned i = 0; i < countInBlock; i++)
+			newPage->page[i].marker = NULLC::OBJECT_FREED;
+
+		newPage->next = activePages;
+		activePages = newPage;
+		pageCount++;
+
+		buffer.current = newPage->page[0].data;
+		buffer.end = newPage->page[0].data + countInBlock * sizeof(MySmallBlock);
 	}
 
-	void* GetBasePointer(void* ptr)
+	unsigned UsedCount()
 	{
-		if(sortedPages.count == 0 || ptr < sortedPages.data[0] || ptr > (char*)sortedPages.data[sortedPages.count - 1] + sizeof(MyLargeBlock))
-			return NULL;
-		// Binary search
-		unsigned int lowerBound = 0;
-		unsigned int upperBound = sortedPages.count - 1;
-		unsigned int pointer = 0;
-		while(upperBound - lowerBound > 1)
+		unsigned count = 0;
+
+		for(MyLargeBlock *curr = activePages; curr; curr = curr->next)
 		{
-			pointer = (lowerBound + upperBound) >> 1;
-			if(ptr < sortedPages.data[pointer])
-				upperBound = pointer;
-			if(ptr > sortedPages.data[pointer])
-				lowerBound = pointer;
+			for(unsigned int i = 0; i < countInBlock; i++)
+			{
+				if(!(curr->page[i].marker & NULLC::OBJECT_FREED))
+					count++;
+			}
 		}
-		if(ptr < sortedPages.data[pointer])
-			pointer--;
-		if(ptr > (char*)sortedPages.data[pointer]  + sizeof(MyLargeBlock))
-			pointer++;
-		MyLargeBlock *best = sortedPages.data[pointer];
 
-		if(ptr < best->page || ptr > (char*)best + sizeof(best->page))
-			return NULL;
-		unsigned int fromBase = (unsigned int)(intptr_t)((char*)ptr - (char*)best->page);
-		return (char*)best->page + (fromBase & ~(elemSize - 1)) + sizeof(markerType);
+		return count;
 	}
 
 	void Mark(unsigned int number)
@@ -223,7 +439,7 @@ public:
 		MyLargeBlock *curr = activePages;
 		while(curr)
 		{
-			for(unsigned int i = 0; i < (curr == activePages ? lastNum : countInBlock); i++)
+			for(unsigned int i = 0; i < countInBlock; i++)
 			{
 				curr->page[i].marker = (curr->page[i].marker & ~NULLC::OBJECT_VISIBLE) | number;
 			}
@@ -235,7 +451,7 @@ public:
 	{
 		for(MyLargeBlock *curr = activePages; curr; curr = curr->next)
 		{
-			for(unsigned int i = 0; i < (curr == activePages ? lastNum : countInBlock); i++)
+			for(unsigned int i = 0; i < countInBlock; i++)
 			{
 				markerType &marker = curr->page[i].marker;
 
@@ -301,7 +517,7 @@ public:
 			// Check flags again, finalizers might have some objects reachable
 			if(!(marker & (NULLC::OBJECT_VISIBLE | NULLC::OBJECT_FREED)))
 			{
-				Free(block);
+				marker = NULLC::OBJECT_FREED;
 
 				freed++;
 			}
@@ -311,16 +527,20 @@ public:
 
 		usedMemory -= freed * elemSize;
 
+		// Restart the sweep so that freed blocks are reused
+		if(freed)
+		{
+			sweepPage = activePages;
+			sweepIndex = 0;
+		}
+
 		return freed;
 	}
 
-	MySmallBlock	lastBlock;
-
-	MySmallBlock	*freeBlocks;
 	MyLargeBlock	*activePages;
-	unsigned int	lastNum;
 
-	FastVector<MyLargeBlock*> sortedPages;
+	MyLargeBlock	*sweepPage;
+	unsigned int	sweepIndex;
 
 	FastVector<MySmallBlock*> objectsToFinalize;
 	FastVector<MySmallBlock*> objectsToFree;
@@ -328,22 +548,88 @@ public:
 
 namespace NULLC
 {
-	const unsigned int poolBlockSize = 64 * 1024;
-
 	bool collectionEnabled = true;
 
 	unsigned int usedMemory = 0;
+	unsigned int bigBlockMemory = 0;
 
 	unsigned int collectableMinimum = 1024 * 1024;
 	unsigned int globalMemoryLimit = 1024 * 1024 * 1024;
 
-	ObjectBlockPool<8, poolBlockSize / 8>		pool8;
-	ObjectBlockPool<16, poolBlockSize / 16>		pool16;
-	ObjectBlockPool<32, poolBlockSize / 32>		pool32;
-	ObjectBlockPool<64, poolBlockSize / 64>		pool64;
-	ObjectBlockPool<128, poolBlockSize / 128>	pool128;
-	ObjectBlockPool<256, poolBlockSize / 256>	pool256;
-	ObjectBlockPool<512, poolBlockSize / 512>	pool512;
+	// Collection policy, threshold starts at the initial value and grows when the memory that survived a collection exceeds the target utilization of it
+	unsigned int initialCollectableMinimum = 1024 * 1024;
+	double collectionGrowthFactor = 2.0;
+	double targetHeapUtilization = 2.0 / 3.0;
+	double maxPauseTime = 0.0;
+
+	// Next collection pause is estimated from the last one
+	double lastPauseTime = 0.0;
+	unsigned int lastScannedMemory = 0;
+	unsigned int lastLiveMemory = 0;
+
+	void *statsCallbackContext = NULL;
+	void (*statsCallback)(void *context, const NULLCGCStats *stats) = NULL;
+
+	// Smallest of the two limits above, allocations that stay below it can skip the collection checks
+	unsigned int allocationLimit = 1024 * 1024;
+
+	// When heap profiling is enabled, all allocations have to go through AllocObject
+	bool heapProfiling = false;
+
+	void UpdateAllocationLimit()
+	{
+		allocationLimit = collectableMinimum < globalMemoryLimit ? collectableMinimum : globalMemoryLimit;
+
+		if(heapProfiling)
+			allocationLimit = 0;
+	}
+
+	ObjectBlockPool<8, poolPageBlockSpace / 8>		pool8;
+	ObjectBlockPool<16, poolPageBlockSpace / 16>		pool16;
+	ObjectBlockPool<32, poolPageBlockSpace / 32>		pool32;
+	ObjectBlockPool<48, poolPageBlockSpace / 48>		pool48;
+	ObjectBlockPool<64, poolPageBlockSpace / 64>		pool64;
+	ObjectBlockPool<96, poolPageBlockSpace / 96>		pool96;
+	ObjectBlockPool<128, poolPageBlockSpace / 128>	pool128;
+	ObjectBlockPool<192, poolPageBlockSpace / 192>	pool192;
+	ObjectBlockPool<256, poolPageBlockSpace / 256>	pool256;
+	ObjectBlockPool<384, poolPageBlockSpace / 384>	pool384;
+	ObjectBlockPool<512, poolPageBlockSpace / 512>	pool512;
+
+	// Mid-size objects and arrays are placed in pages of a large object space instead of getting a separate allocation each
+	ObjectBlockPool<768, poolPageBlockSpace / 768>		pool768;
+	ObjectBlockPool<1024, poolPageBlockSpace / 1024>	pool1024;
+	ObjectBlockPool<1536, poolPageBlockSpace / 1536>	pool1536;
+	ObjectBlockPool<2048, poolPageBlockSpace / 2048>	pool2048;
+	ObjectBlockPool<3072, poolPageBlockSpace / 3072>	pool3072;
+	ObjectBlockPool<4096, poolPageBlockSpace / 4096>	pool4096;
+	ObjectBlockPool<6144, poolPageBlockSpace / 6144>	pool6144;
+	ObjectBlockPool<8192, poolPageBlockSpace / 8192>	pool8192;
+
+	ObjectBlockPoolBase* pools[] = { &pool8, &pool16, &pool32, &pool48, &pool64, &pool96, &pool128, &pool192, &pool256, &pool384, &pool512, &pool768, &pool1024, &pool1536, &pool2048, &pool3072, &pool4096, &pool6144, &pool8192 };
+
+	const unsigned poolCount = sizeof(pools) / sizeof(pools[0]);
+
+	const unsigned maxPoolObjectSize = 8192;
+
+	// Pool lookup by object size in 8 byte steps
+	ObjectBlockPoolBase* poolBySize[maxPoolObjectSize / 8 + 1];
+
+	struct PoolBySizeInit
+	{
+		PoolBySizeInit()
+		{
+			unsigned pool = 0;
+
+			for(unsigned i = 0; i <= maxPoolObjectSize / 8; i++)
+			{
+				while(pools[pool]->blockSize < i * 8)
+					pool++;
+
+				poolBySize[i] = pools[pool];
+			}
+		}
+	} poolBySizeInit;
 
 	struct Range
 	{
@@ -385,8 +671,82 @@ namespace NULLC
 	void CollectUnmarkedBlock(Range& curr);
 	void ClearBlock(Range& curr);
 
+	// Big blocks of this size are reserved from the system when page allocation is enabled, starting at an offset that aligns the object data
+	// With huge pages, only blocks that fill at least one huge page are reserved, smaller ones would waste most of it
+	const unsigned bigBlockPageMinimum = 256 * 1024;
+	const unsigned bigBlockPageOffset = (16 - ((4 + sizeof(markerType)) & 15)) & 15;
+
+	bool IsPageBigBlock(unsigned size)
+	{
+		return NULLC::pageAllocation && size >= bigBlockPageMinimum && size >= NULLC::pageAllocationGranularity();
+	}
+
+	void* AllocBigBlock(unsigned size)
+	{
+		if(IsPageBigBlock(size))
+		{
+			char *base = (char*)NULLC::allocPages(size + 4 + bigBlockPageOffset);
+
+			return base ? base + bigBlockPageOffset : NULL;
+		}
+
+		void *ptr = NULLC::alignedAlloc(size - sizeof(markerType), 4 + sizeof(markerType));
+
+		if(ptr)
+			memset((char*)ptr + 4, 0, size);
+
+		return ptr;
+	}
+
+	void FreeBigBlock(void *block)
+	{
+		unsigned size = *(unsigned*)block;
+
+		if(IsPageBigBlock(size))
+			NULLC::deallocPages((char*)block - bigBlockPageOffset, size + 4 + bigBlockPageOffset);
+		else
+			NULLC::alignedDealloc(block);
+	}
+
 	double	markTime = 0.0;
 	double	collectTime = 0.0;
+
+	// Heap profile entry for each allocation site instruction and allocated type
+	struct HeapProfileSite
+	{
+		unsigned	instruction;
+		unsigned	type;
+		bool		isArray;
+
+		unsigned	allocCount;
+		unsigned long long	allocBytes;
+
+		unsigned	liveCount;
+		unsigned long long	liveBytes;
+
+		// Bytes allocated since the last collection and between the last two collections
+		unsigned long long	pendingBytes;
+		unsigned long long	cycleBytes;
+	};
+
+	struct HeapProfileObject
+	{
+		void		*ptr;
+		unsigned	size;
+		unsigned	site;
+	};
+
+	FastVector<HeapProfileSite>		heapProfileSites;
+	HashMap<unsigned>				heapProfileSiteMap;
+
+	// Objects allocated while profiling was enabled that were alive after the last collection
+	FastVector<HeapProfileObject>	heapProfileObjects;
+
+	FastVector<char>	heapProfileReport;
+
+	void HeapProfileAlloc(void *ptr, unsigned size, unsigned type, bool isArray);
+	void HeapProfileCollect();
+	void HeapProfileClear();
 }
 
 void NULLC::SetLinker(Linker *linker)
@@ -395,6 +755,11 @@ void NULLC::SetLinker(Linker *linker)
 }
 
 void* NULLC::AllocObject(int size, unsigned type)
+{
+	return AllocTypedObject(size, type, false);
+}
+
+void* NULLC::AllocTypedObject(int size, unsigned type, bool isArray)
 {
 	if(size < 0)
 	{
@@ -420,59 +785,29 @@ void* NULLC::AllocObject(int size, unsigned type)
 	}
 
 	unsigned int realSize = size;
-	if(size <= 64)
+	if(unsigned(size) <= maxPoolObjectSize)
+	{
+		ObjectBlockPoolBase *pool = poolBySize[(size + 7) >> 3];
+
+		data = pool->Alloc();
+		realSize = pool->blockSize;
+	}
+	else
 	{
-		if(size <= 16)
+		void *ptr = AllocBigBlock(size);
+		if(ptr == NULL)
 		{
-			if(size <= 8)
-			{
-				data = pool8.Alloc();
-				realSize = 8;
-			}else{
-				data = pool16.Alloc();
-				realSize = 16;
-			}
-		}else{
-			if(size <= 32)
-			{
-				data = pool32.Alloc();
-				realSize = 32;
-			}else{
-				data = pool64.Alloc();
-				realSize = 64;
-			}
+			nullcThrowError("Allocation failed.");
+			return NULL;
 		}
-	}else{
-		if(size <= 256)
-		{
-			if(size <= 128)
-			{
-				data = pool128.Alloc();
-				realSize = 128;
-			}else{
-				data = pool256.Alloc();
-				realSize = 256;
-			}
-		}else{
-			if(size <= 512)
-			{
-				data = pool512.Alloc();
-				realSize = 512;
-			}else{
-				void *ptr = NULLC::alignedAlloc(size - sizeof(markerType), 4 + sizeof(markerType));
-				if(ptr == NULL)
-				{
-					nullcThrowError("Allocation failed.");
-					return NULL;
-				}
 
-				Range range(ptr, (char*)ptr + size + 4);
-				bigBlocks.insert(range);
+		Range range(ptr, (char*)ptr + size + 4);
+		bigBlocks.insert(range);
 
-				realSize = *(int*)ptr = size;
-				data = (char*)ptr + 4;
-			}
-		}
+		realSize = *(int*)ptr = size;
+		data = (char*)ptr + 4;
+
+		bigBlockMemory += realSize;
 	}
 	usedMemory += realSize;
 
@@ -485,11 +820,58 @@ void* NULLC::AllocObject(int size, unsigned type)
 	if(type && (linker->exTypes[type].typeFlags & ExternTypeInfo::TYPE_HAS_FINALIZER))
 		finalize = (int)OBJECT_FINALIZABLE;
 
-	memset(data, 0, size);
-	*(markerType*)data = finalize | (type << 8);
+	*(markerType*)data = finalize | (isArray ? OBJECT_ARRAY : 0) | (type << 8);
+
+	if(heapProfiling)
+		HeapProfileAlloc((char*)data + sizeof(markerType), realSize, type, isArray);
+
 	return (char*)data + sizeof(markerType);
 }
 
+void* NULLC::AllocObjectFast(int size, unsigned type)
+{
+	size += sizeof(markerType);
+
+	if(unsigned(size) > maxPoolObjectSize)
+		return NULL;
+
+	if(type && (linker->exTypes[type].typeFlags & ExternTypeInfo::TYPE_HAS_FINALIZER))
+		return NULL;
+
+	AllocationBuffer &buffer = poolBySize[(size + 7) >> 3]->buffer;
+
+	if(buffer.current == buffer.end || usedMemory + buffer.blockSize > allocationLimit)
+		return NULL;
+
+	char *data = buffer.current;
+
+	buffer.current += buffer.blockSize;
+	usedMemory += buffer.blockSize;
+
+	*(markerType*)data = type << 8;
+	return data + sizeof(markerType);
+}
+
+NULLC::AllocationBuffer* NULLC::GetAllocationBuffer(unsigned size)
+{
+	size += sizeof(markerType);
+
+	if(size > maxPoolObjectSize)
+		return NULL;
+
+	return &poolBySize[(size + 7) >> 3]->buffer;
+}
+
+unsigned* NULLC::GetUsedMemoryCounter()
+{
+	return &usedMemory;
+}
+
+unsigned* NULLC::GetAllocationLimit()
+{
+	return &allocationLimit;
+}
+
 unsigned int NULLC::UsedMemory()
 {
 	return usedMemory;
@@ -517,7 +899,7 @@ NULLCArray NULLC::AllocArray(unsigned size, unsigned count, unsigned type)
 	if(bytes == 0)
 		bytes += 4;
 
-	char *ptr = (char*)AllocObject(bytes + arrayPadding, type);
+	char *ptr = (char*)AllocTypedObject(bytes + arrayPadding, type, true);
 
 	if(!ptr)
 		return ret;
@@ -527,9 +909,6 @@ NULLCArray NULLC::AllocArray(unsigned size, unsigned count, unsigned type)
 
 	((unsigned*)ret.ptr)[-1] = count;
 
-	markerType *marker = (markerType*)(ptr - sizeof(markerType));
-	*marker |= OBJECT_ARRAY;
-
 	return ret;
 }
 
@@ -547,26 +926,16 @@ void NULLC::MarkMemory(unsigned int number)
 
 	bigBlocks.for_each(MarkBlock);
 
-	pool8.Mark(number);
-	pool16.Mark(number);
-	pool32.Mark(number);
-	pool64.Mark(number);
-	pool128.Mark(number);
-	pool256.Mark(number);
-	pool512.Mark(number);
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->Mark(number);
 }
 
 void NULLC::CollectUnmarked()
 {
 	bigBlocks.for_each(CollectUnmarkedBlock);
 
-	pool8.CollectUnmarked();
-	pool16.CollectUnmarked();
-	pool32.CollectUnmarked();
-	pool64.CollectUnmarked();
-	pool128.CollectUnmarked();
-	pool256.CollectUnmarked();
-	pool512.CollectUnmarked();
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->CollectUnmarked();
 }
 
 void NULLC::FinalizePending()
@@ -604,20 +973,17 @@ void NULLC::FinalizePending()
 
 	blocksToFinalize.clear();
 
-	pool8.FinalizePending();
-	pool16.FinalizePending();
-	pool32.FinalizePending();
-	pool64.FinalizePending();
-	pool128.FinalizePending();
-	pool256.FinalizePending();
-	pool512.FinalizePending();
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->FinalizePending();
 
 	// Mark new roots
 	GC::MarkPendingRoots();
 }
 
-void NULLC::FreePending()
+unsigned NULLC::FreePending()
 {
+	unsigned freed = 0;
+
 	for(unsigned i = 0; i < blocksToFree.size(); i++)
 	{
 		Range &curr = blocksToFree[i];
@@ -632,41 +998,29 @@ void NULLC::FreePending()
 			unsigned size = *(unsigned int*)block;
 
 			usedMemory -= size;
+			bigBlockMemory -= size;
 
-			NULLC::alignedDealloc(block);
+			FreeBigBlock(block);
 
 			bigBlocks.erase(curr);
+
+			freed++;
 		}
 	}
 
 	blocksToFree.clear();
 
-	pool8.FreePending(usedMemory);
-	pool16.FreePending(usedMemory);
-	pool32.FreePending(usedMemory);
-	pool64.FreePending(usedMemory);
-	pool128.FreePending(usedMemory);
-	pool256.FreePending(usedMemory);
-	pool512.FreePending(usedMemory);
+	for(unsigned i = 0; i < poolCount; i++)
+		freed += pools[i]->FreePending(usedMemory);
+
+	return freed;
 }
 
 bool NULLC::IsBasePointer(void* ptr)
 {
-	// Search in range of every pool
-	if(pool8.IsBasePointer(ptr))
-		return true;
-	if(pool16.IsBasePointer(ptr))
-		return true;
-	if(pool32.IsBasePointer(ptr))
-		return true;
-	if(pool64.IsBasePointer(ptr))
-		return true;
-	if(pool128.IsBasePointer(ptr))
-		return true;
-	if(pool256.IsBasePointer(ptr))
-		return true;
-	if(pool512.IsBasePointer(ptr))
-		return true;
+	// Search in pool pages
+	if(PoolPageHeader *page = FindPoolPage(ptr))
+		return unsigned((char*)ptr - page->start) % page->elemSize == sizeof(markerType);
 
 	// Search in global pool
 	if(BigBlockIterator it = bigBlocks.find(Range(ptr, ptr)))
@@ -682,21 +1036,13 @@ bool NULLC::IsBasePointer(void* ptr)
 
 void* NULLC::GetBasePointer(void* ptr)
 {
-	// Search in range of every pool
-	if(void *base = pool8.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool16.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool32.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool64.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool128.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool256.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool512.GetBasePointer(ptr))
-		return base;
+	// Search in pool pages
+	if(PoolPageHeader *page = FindPoolPage(ptr))
+	{
+		unsigned fromBase = unsigned((char*)ptr - page->start);
+
+		return page->start + (fromBase - fromBase % page->elemSize) + sizeof(markerType);
+	}
 
 	// Search in global pool
 	if(BigBlockIterator it = bigBlocks.find(Range(ptr, ptr)))
@@ -710,6 +1056,18 @@ void* NULLC::GetBasePointer(void* ptr)
 	return NULL;
 }
 
+unsigned NULLC::GetObjectSize(void* base)
+{
+	// Object storage size includes the unused space at the end of the pool block
+	if(PoolPageHeader *page = FindPoolPage(base))
+		return page->elemSize - sizeof(markerType);
+
+	if(BigBlockIterator it = bigBlocks.find(Range(base, base)))
+		return *(unsigned int*)it->key.start - sizeof(markerType);
+
+	return 0;
+}
+
 void NULLC::CollectUnmarkedBlock(Range& curr)
 {
 	void *block = curr.start;
@@ -739,6 +1097,8 @@ void NULLC::CollectMemory()
 	if(!collectionEnabled)
 		return;
 
+	unsigned usedMemoryBefore = usedMemory;
+
 	double time = (double(clock()) / CLOCKS_PER_SEC);
 
 	// All memory blocks are marked with 0
@@ -747,25 +1107,58 @@ void NULLC::CollectMemory()
 	// Used memory blocks are marked with 1
 	GC::MarkUsedBlocks();
 
+	// Objects with finalizers that haven't run yet are still referenced by the queue
+	MarkFinalizationQueue();
+
 	// Collect sets of objects to finalize and to potentially free
 	CollectUnmarked();
 
-	markTime += (double(clock()) / CLOCKS_PER_SEC) - time;
+	double markDuration = (double(clock()) / CLOCKS_PER_SEC) - time;
+	markTime += markDuration;
 	time = (double(clock()) / CLOCKS_PER_SEC);
 
 	// Ressurect objects and register finalizers
 	FinalizePending();
 
 	// Free memory that remains unreachable
-	FreePending();
+	unsigned freedObjects = FreePending();
 
-	collectTime += (double(clock()) / CLOCKS_PER_SEC) - time;
+	double collectDuration = (double(clock()) / CLOCKS_PER_SEC) - time;
+	collectTime += collectDuration;
 
-	if(usedMemory + (usedMemory >> 1) >= collectableMinimum)
-		collectableMinimum <<= 1;
+	if(double(usedMemory) >= double(collectableMinimum) * targetHeapUtilization)
+	{
+		double next = double(collectableMinimum) * collectionGrowthFactor;
 
-	(void)nullcRunFunction("__finalizeObjects");
-	finalizeList.clear();
+		collectableMinimum = next < double(globalMemoryLimit) ? unsigned(next) : globalMemoryLimit;
+	}
+
+	UpdateAllocationLimit();
+
+	lastPauseTime = markDuration + collectDuration;
+	lastScannedMemory = usedMemoryBefore;
+	lastLiveMemory = usedMemory;
+
+	if(heapProfileSites.size())
+		HeapProfileCollect();
+
+	if(statsCallback)
+	{
+		NULLCGCStats stats;
+
+		stats.usedMemoryBefore = usedMemoryBefore;
+		stats.usedMemoryAfter = usedMemory;
+		stats.markedObjects = GC::MarkedObjectCount();
+		stats.freedObjects = freedObjects;
+		stats.nextThreshold = collectableMinimum;
+		stats.markTime = markDuration;
+		stats.pauseTime = markDuration + collectDuration;
+
+		statsCallback(statsCallbackContext, &stats);
+	}
+
+	if(!deferFinalization)
+		RunPendingFinalizers(~0u);
 }
 
 double NULLC::MarkTime()
@@ -778,6 +1171,477 @@ double NULLC::CollectTime()
 	return collectTime;
 }
 
+unsigned int NULLC::ReservedMemory()
+{
+	unsigned int reserved = bigBlockMemory;
+
+	for(unsigned i = 0; i < poolCount; i++)
+		reserved += pools[i]->pageCount * pools[i]->blocksInPage * pools[i]->blockSize;
+
+	return reserved;
+}
+
+double NULLC::HeapFragmentation()
+{
+	unsigned int reserved = ReservedMemory();
+
+	if(!reserved)
+		return 0.0;
+
+	return double(reserved - usedMemory) / reserved;
+}
+
+int NULLC::SizeClassCount()
+{
+	return int(poolCount);
+}
+
+int NULLC::SizeClassSize(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->blockSize);
+}
+
+int NULLC::SizeClassUsedMemory(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->UsedCount() * pools[index]->blockSize);
+}
+
+int NULLC::SizeClassReservedMemory(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->pageCount * pools[index]->blocksInPage * pools[index]->blockSize);
+}
+
+void NULLC::SetHeapProfiling(bool enabled)
+{
+	if(enabled && !heapProfiling)
+	{
+		HeapProfileClear();
+
+		heapProfileSiteMap.init();
+	}
+
+	heapProfiling = enabled;
+
+	UpdateAllocationLimit();
+}
+
+const char* NULLC::CheckGCPolicy(const NULLCGCPolicy &policy)
+{
+	if(policy.initialThreshold == 0)
+		return "ERROR: initial collection threshold must be positive";
+
+	if(!(policy.growthFactor >= 1.0))
+		return "ERROR: collection threshold growth factor must be at least 1";
+
+	if(!(policy.targetUtilization > 0.0 && policy.targetUtilization <= 1.0))
+		return "ERROR: target heap utilization must be in (0, 1] range";
+
+	if(!(policy.maxPauseTime >= 0.0))
+		return "ERROR: collection pause budget can't be negative";
+
+	return NULL;
+}
+
+void NULLC::SetGCPolicy(const NULLCGCPolicy &policy)
+{
+	initialCollectableMinimum = policy.initialThreshold;
+	collectionGrowthFactor = policy.growthFactor;
+	targetHeapUtilization = policy.targetUtilization;
+	maxPauseTime = policy.maxPauseTime;
+
+	collectableMinimum = initialCollectableMinimum < globalMemoryLimit ? initialCollectableMinimum : globalMemoryLimit;
+
+	UpdateAllocationLimit();
+}
+
+NULLCGCPolicy NULLC::GetGCPolicy()
+{
+	NULLCGCPolicy policy;
+
+	policy.initialThreshold = initialCollectableMinimum;
+	policy.growthFactor = collectionGrowthFactor;
+	policy.targetUtilization = targetHeapUtilization;
+	policy.maxPauseTime = maxPauseTime;
+
+	return policy;
+}
+
+void NULLC::SetGCStatsCallback(void *context, void (*callback)(void *context, const NULLCGCStats *stats))
+{
+	statsCallbackContext = context;
+	statsCallback = callback;
+}
+
+void NULLC::SetCollectionPolicy(int initialThreshold, double growthFactor, double targetUtilization, double maxPauseTime)
+{
+	if(initialThreshold <= 0)
+	{
+		nullcThrowError("ERROR: initial collection threshold must be positive");
+		return;
+	}
+
+	NULLCGCPolicy policy;
+
+	policy.initialThreshold = unsigned(initialThreshold);
+	policy.growthFactor = growthFactor;
+	policy.targetUtilization = targetUtilization;
+	policy.maxPauseTime = maxPauseTime;
+
+	if(const char *error = CheckGCPolicy(policy))
+	{
+		nullcThrowError("%s", error);
+		return;
+	}
+
+	SetGCPolicy(policy);
+}
+
+bool NULLC::CollectMemoryIfCheap()
+{
+	if(!collectionEnabled)
+		return false;
+
+	// Nothing was allocated since the last collection
+	if(usedMemory <= lastLiveMemory)
+		return false;
+
+	// Pause is expected to grow with the amount of memory that has to be scanned
+	if(maxPauseTime > 0.0 && lastScannedMemory)
+	{
+		if(lastPauseTime * usedMemory / lastScannedMemory > maxPauseTime)
+			return false;
+	}
+
+	CollectMemory();
+
+	return true;
+}
+
+void NULLC::SetDeferredFinalization(bool enabled)
+{
+	deferFinalization = enabled;
+}
+
+int NULLC::PendingFinalizers()
+{
+	return int(finalizeQueue.size());
+}
+
+int NULLC::RunFinalizers(int maxCount)
+{
+	return int(RunPendingFinalizers(maxCount < 0 ? ~0u : unsigned(maxCount)));
+}
+
+unsigned NULLC::RunPendingFinalizers(unsigned maxCount)
+{
+	// Collection triggered from a finalizer leaves the new objects to the call that is already running
+	if(finalizersRunning)
+		return 0;
+
+	finalizersRunning = true;
+
+	unsigned count = 0;
+
+	while(count < maxCount && finalizeQueue.size())
+	{
+		unsigned batch = finalizeQueue.size() < maxCount - count ? finalizeQueue.size() : maxCount - count;
+
+		// Objects are moved to the list in the order of their discovery, they remain marked as roots while the finalizers run
+		finalizeList.clear();
+		finalizeList.push_back(finalizeQueue.data, batch);
+
+		unsigned remaining = finalizeQueue.size() - batch;
+
+		memmove(finalizeQueue.data, finalizeQueue.data + batch, remaining * sizeof(NULLCRef));
+		finalizeQueue.shrink(remaining);
+
+		count += batch;
+
+		bool success = nullcRunFunction("__finalizeObjects");
+
+		finalizeList.clear();
+
+		if(!success)
+			break;
+	}
+
+	finalizersRunning = false;
+
+	return count;
+}
+
+void NULLC::MarkFinalizationQueue()
+{
+	for(unsigned i = 0; i < finalizeQueue.size(); i++)
+		GC::CheckPointer((char*)&finalizeQueue[i].ptr);
+
+	for(unsigned i = 0; i < finalizeList.size(); i++)
+		GC::CheckPointer((char*)&finalizeList[i].ptr);
+
+	GC::MarkPendingRoots();
+}
+
+bool NULLC::HeapProfiling()
+{
+	return heapProfiling;
+}
+
+void NULLC::HeapProfileAlloc(void *ptr, unsigned size, unsigned type, bool isArray)
+{
+	// Innermost call stack frame is the instruction that requested the allocation
+	unsigned instruction = 0;
+
+	if(unsigned frames = nullcDebugGetStackFrameCount())
+		instruction = nullcDebugEnumStackFrame(frames - 1);
+
+	unsigned hash = instruction * 2654435761u + type * 2 + (isArray ? 1 : 0);
+
+	unsigned index = ~0u;
+
+	for(HashMap<unsigned>::Node *curr = heapProfileSiteMap.first(hash); curr; curr = heapProfileSiteMap.next(curr))
+	{
+		HeapProfileSite &site = heapProfileSites[curr->value];
+
+		if(site.instruction == instruction && site.type == type && site.isArray == isArray)
+		{
+			index = curr->value;
+			break;
+		}
+	}
+
+	if(index == ~0u)
+	{
+		index = heapProfileSites.size();
+
+		HeapProfileSite &site = *heapProfileSites.push_back();
+
+		memset(&site, 0, sizeof(site));
+
+		site.instruction = instruction;
+		site.type = type;
+		site.isArray = isArray;
+
+		heapProfileSiteMap.insert(hash, index);
+	}
+
+	HeapProfileSite &site = heapProfileSites[index];
+
+	site.allocCount++;
+	site.allocBytes += size;
+
+	site.liveCount++;
+	site.liveBytes += size;
+
+	site.pendingBytes += size;
+
+	HeapProfileObject &object = *heapProfileObjects.push_back();
+
+	object.ptr = ptr;
+	object.size = size;
+	object.site = index;
+}
+
+void NULLC::HeapProfileCollect()
+{
+	for(unsigned i = 0; i < heapProfileSites.size(); i++)
+	{
+		HeapProfileSite &site = heapProfileSites[i];
+
+		site.liveCount = 0;
+		site.liveBytes = 0;
+
+		site.cycleBytes = site.pendingBytes;
+		site.pendingBytes = 0;
+	}
+
+	// Freed pool blocks can't be reused before this point, so the block marker tells if the object is still alive
+	unsigned liveObjects = 0;
+
+	for(unsigned i = 0; i < heapProfileObjects.size(); i++)
+	{
+		HeapProfileObject &object = heapProfileObjects[i];
+
+		bool alive = false;
+
+		if(FindPoolPage(object.ptr))
+			alive = !(*(markerType*)((char*)object.ptr - sizeof(markerType)) & OBJECT_FREED);
+		else
+			alive = bigBlocks.find(Range(object.ptr, object.ptr)) != NULL;
+
+		if(!alive)
+			continue;
+
+		HeapProfileSite &site = heapProfileSites[object.site];
+
+		site.liveCount++;
+		site.liveBytes += object.size;
+
+		heapProfileObjects[liveObjects++] = object;
+	}
+
+	heapProfileObjects.count = liveObjects;
+}
+
+void NULLC::HeapProfileClear()
+{
+	// Site map storage is only created when profiling is enabled
+	if(heapProfileSites.size())
+		heapProfileSiteMap.clear();
+
+	heapProfileSites.clear();
+	heapProfileObjects.clear();
+}
+
+namespace
+{
+	int HeapProfileSiteCompare(const void *lhs, const void *rhs)
+	{
+		const NULLC::HeapProfileSite &a = *(const NULLC::HeapProfileSite*)lhs;
+		const NULLC::HeapProfileSite &b = *(const NULLC::HeapProfileSite*)rhs;
+
+		if(a.liveBytes != b.liveBytes)
+			return a.liveBytes > b.liveBytes ? -1 : 1;
+
+		if(a.allocBytes != b.allocBytes)
+			return a.allocBytes > b.allocBytes ? -1 : 1;
+
+		return 0;
+	}
+
+	void HeapProfilePrint(FastVector<char> &output, const char *format, ...)
+	{
+		char buf[1024];
+
+		va_list args;
+		va_start(args, format);
+
+		int length = vsnprintf(buf, sizeof(buf), format, args);
+
+		va_end(args);
+
+		if(length < 0)
+			return;
+
+		if(unsigned(length) >= sizeof(buf))
+			length = sizeof(buf) - 1;
+
+		output.push_back(buf, length);
+	}
+}
+
+const char* NULLC::HeapProfileReport(bool byType)
+{
+	FastVector<HeapProfileSite> rows;
+
+	for(unsigned i = 0; i < heapProfileSites.size(); i++)
+	{
+		HeapProfileSite &site = heapProfileSites[i];
+
+		if(!byType)
+		{
+			rows.push_back(site);
+			continue;
+		}
+
+		// Merge sites that allocate the same type
+		HeapProfileSite *target = NULL;
+
+		for(unsigned k = 0; k < rows.size() && !target; k++)
+		{
+			if(rows[k].type == site.type && rows[k].isArray == site.isArray)
+				target = &rows[k];
+		}
+
+		if(!target)
+		{
+			target = rows.push_back();
+
+			memset(target, 0, sizeof(HeapProfileSite));
+
+			target->type = site.type;
+			target->isArray = site.isArray;
+		}
+
+		target->allocCount += site.allocCount;
+		target->allocBytes += site.allocBytes;
+		target->liveCount += site.liveCount;
+		target->liveBytes += site.liveBytes;
+		target->cycleBytes += site.cycleBytes;
+	}
+
+	if(rows.size())
+		qsort(rows.data, rows.size(), sizeof(HeapProfileSite), HeapProfileSiteCompare);
+
+	heapProfileReport.clear();
+
+	HeapProfilePrint(heapProfileReport, "%12s %8s %14s %10s %12s  %s\n", "live bytes", "live", "alloc bytes", "allocs", "cycle bytes", byType ? "type" : "site");
+
+	char *symbols = linker->exSymbols.data;
+
+	for(unsigned i = 0; i < rows.size(); i++)
+	{
+		HeapProfileSite &row = rows[i];
+
+		HeapProfilePrint(heapProfileReport, "%12llu %8u %14llu %10u %12llu  ", row.liveBytes, row.liveCount, row.allocBytes, row.allocCount, row.cycleBytes);
+
+		if(!byType)
+		{
+			if(const char *location = row.instruction ? nullcDebugGetVmAddressLocation(row.instruction, false) : NULL)
+				HeapProfilePrint(heapProfileReport, "%s, ", location);
+			else
+				HeapProfilePrint(heapProfileReport, "external, ");
+		}
+
+		HeapProfilePrint(heapProfileReport, "%s%s\n", symbols + linker->exTypes[row.type].offsetToName, row.isArray ? "[]" : "");
+	}
+
+	heapProfileReport.push_back(0);
+
+	return heapProfileReport.data;
+}
+
+NULLCArray NULLC::HeapProfileBySite()
+{
+	const char *report = HeapProfileReport(false);
+
+	NULLCArray result = AllocArray(1, unsigned(strlen(report)) + 1, NULLC_TYPE_CHAR);
+
+	if(result.ptr)
+		memcpy(result.ptr, report, result.len);
+
+	return result;
+}
+
+NULLCArray NULLC::HeapProfileByType()
+{
+	const char *report = HeapProfileReport(true);
+
+	NULLCArray result = AllocArray(1, unsigned(strlen(report)) + 1, NULLC_TYPE_CHAR);
+
+	if(result.ptr)
+		memcpy(result.ptr, report, result.len);
+
+	return result;
+}
+
 void NULLC::FinalizeMemory()
 {
 	MarkMemory(0);
@@ -785,13 +1649,12 @@ void NULLC::FinalizeMemory()
 	CollectUnmarked();
 	FinalizePending();
 
-	(void)nullcRunFunction("__finalizeObjects");
-	finalizeList.clear();
+	RunPendingFinalizers(~0u);
 }
 
 void NULLC::ClearBlock(Range& curr)
 {
-	NULLC::alignedDealloc(curr.start);
+	FreeBigBlock(curr.start);
 }
 
 void NULLC::ClearMemory()
@@ -799,14 +1662,12 @@ void NULLC::ClearMemory()
 	collectionEnabled = true;
 
 	usedMemory = 0;
+	bigBlockMemory = 0;
+
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->Reset();
 
-	pool8.Reset();
-	pool16.Reset();
-	pool32.Reset();
-	pool64.Reset();
-	pool128.Reset();
-	pool256.Reset();
-	pool512.Reset();
+	ClearPoolPages();
 
 	bigBlocks.for_each(ClearBlock);
 	bigBlocks.clear();
@@ -814,7 +1675,18 @@ void NULLC::ClearMemory()
 	blocksToFinalize.clear();
 	blocksToFree.clear();
 
+	finalizeQueue.clear();
 	finalizeList.clear();
+	finalizersRunning = false;
+
+	collectableMinimum = initialCollectableMinimum < globalMemoryLimit ? initialCollectableMinimum : globalMemoryLimit;
+	UpdateAllocationLimit();
+
+	lastPauseTime = 0.0;
+	lastScannedMemory = 0;
+	lastLiveMemory = 0;
+
+	HeapProfileClear();
 }
 
 void NULLC::ResetMemory()
@@ -823,10 +1695,33 @@ void NULLC::ResetMemory()
 
 	bigBlocks.reset();
 
+	heapProfileSites.reset();
+	heapProfileSiteMap.reset();
+	heapProfileObjects.reset();
+	heapProfileReport.reset();
+
+	heapProfiling = false;
+	UpdateAllocationLimit();
+
+	ResetPoolPages();
+
 	blocksToFinalize.reset();
 	blocksToFree.reset();
 
+	finalizeQueue.reset();
 	finalizeList.reset();
+	deferFinalization = false;
+
+	initialCollectableMinimum = 1024 * 1024;
+	collectionGrowthFactor = 2.0;
+	targetHeapUtilization = 2.0 / 3.0;
+	maxPauseTime = 0.0;
+
+	statsCallbackContext = NULL;
+	statsCallback = NULL;
+
+	collectableMinimum = initialCollectableMinimum < globalMemoryLimit ? initialCollectableMinimum : globalMemoryLimit;
+	UpdateAllocationLimit();
 
 	GC::ResetGC();
 }
@@ -834,7 +1729,9 @@ void NULLC::ResetMemory()
 void NULLC::SetGlobalLimit(unsigned int limit)
 {
 	globalMemoryLimit = limit;
-	collectableMinimum = limit < 1024 * 1024 ? limit : 1024 * 1024;
+	collectableMinimum = limit < initialCollectableMinimum ? limit : initialCollectableMinimum;
+
+	UpdateAllocationLimit();
 }
 
 void NULLC::Assert(int val)
@@ -45,6 +45,22 @@ namespace NULLC
 	NULLCArray	DoubleToStr(int precision, bool exponent, double* r);
 	
 	void*		AllocObject(int size, unsigned type);
+	void*		AllocTypedObject(int size, unsigned type, bool isArray);
+
+	// Bump allocation buffer of a size class
+	struct AllocationBuffer
+	{
+		char		*current;
+		char		*end;
+		unsigned	blockSize;
+	};
+
+	// Allocates an object from the size class buffer without collection checks, returns NULL if AllocObject has to be used instead
+	void*		AllocObjectFast(int size, unsigned type);
+
+	AllocationBuffer*	GetAllocationBuffer(unsigned size);
+	unsigned*	GetUsedMemoryCounter();
+	unsigned*	GetAllocationLimit();
 	NULLCArray	AllocArray(unsigned size, unsigned count, unsigned type);
 	NULLCRef	CopyObject(NULLCRef ptr);
 	void		CopyArray(NULLCAutoArray* dst, NULLCAutoArray src);
@@ -56,10 +72,11 @@ namespace NULLC
 	void		MarkMemory(unsigned int number);
 	void		CollectUnmarked();
 	void		FinalizePending();
-	void		FreePending();
+	unsigned	FreePending();
 
 	bool		IsBasePointer(void* ptr);
 	void*		GetBasePointer(void* ptr);
+	unsigned	GetObjectSize(void* base);
 
 	void		SetCollectMemory(bool enabled);
 	void		CollectMemory();
@@ -67,6 +84,37 @@ namespace NULLC
 	double		MarkTime();
 	double		CollectTime();
 
+	unsigned int	ReservedMemory();
+	double		HeapFragmentation();
+
+	int			SizeClassCount();
+	int			SizeClassSize(int index);
+	int			SizeClassUsedMemory(int index);
+	int			SizeClassReservedMemory(int index);
+
+	// Heap profiling attributes every allocation to the allocation site instruction and type, live memory of each site is updated by every collection
+	void		SetHeapProfiling(bool enabled);
+	bool		HeapProfiling();
+	const char*	HeapProfileReport(bool byType);
+	NULLCArray	HeapProfileBySite();
+	NULLCArray	HeapProfileByType();
+
+	// Deferred finalization only queues the finalizers of unreachable objects, RunFinalizers runs up to maxCount of them (all if maxCount is negative)
+	void		SetDeferredFinalization(bool enabled);
+	int			PendingFinalizers();
+	int			RunFinalizers(int maxCount);
+	unsigned	RunPendingFinalizers(unsigned maxCount);
+	void		MarkFinalizationQueue();
+
+	// Collection policy replaces the heuristics used by the allocations, statistics callback is called after every collection
+	const char*	CheckGCPolicy(const NULLCGCPolicy &policy);
+	void		SetGCPolicy(const NULLCGCPolicy &policy);
+	NULLCGCPolicy	GetGCPolicy();
+	void		SetGCStatsCallback(void *context, void (*callback)(void *context, const NULLCGCStats *stats));
+
+	void		SetCollectionPolicy(int initialThreshold, double growthFactor, double targetUtilization, double maxPauseTime);
+	bool		CollectMemoryIfCheap();
+
 	void		FinalizeMemory();
 	void		ClearMemory();
 	void		ResetMemory();
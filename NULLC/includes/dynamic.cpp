@@ -26,7 +26,8 @@ namespace NULLCDynamic
 			return;
 		}
 
-		nullcRedirectFunction(((NULLCFuncPtr*)dest.ptr)->id, ((NULLCFuncPtr*)src.ptr)->id);
+		if(!nullcRedirectFunction(((NULLCFuncPtr*)dest.ptr)->id, ((NULLCFuncPtr*)src.ptr)->id))
+			nullcThrowError("%s", nullcGetLastError());
 	}
 
 	void Override(NULLCRef dest, NULLCArray code)
@@ -66,7 +67,8 @@ namespace NULLCDynamic
 		}
 		delete[] bytecode;
 
-		nullcRedirectFunction(((NULLCFuncPtr*)dest.ptr)->id, linker->exFunctions.size() - 1);
+		if(!nullcRedirectFunction(((NULLCFuncPtr*)dest.ptr)->id, linker->exFunctions.size() - 1))
+			nullcThrowError("%s", nullcGetLastError());
 	}
 }
 
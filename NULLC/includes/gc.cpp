@@ -12,5 +12,24 @@ bool	nullcInitGCModule()
 	REGISTER_FUNC(MarkTime, "NamespaceGC::MarkTime", 0);
 	REGISTER_FUNC(CollectTime, "NamespaceGC::CollectTime", 0);
 
+	REGISTER_FUNC(ReservedMemory, "NamespaceGC::ReservedMemory", 0);
+	REGISTER_FUNC(HeapFragmentation, "NamespaceGC::HeapFragmentation", 0);
+
+	REGISTER_FUNC(SizeClassCount, "NamespaceGC::SizeClassCount", 0);
+	REGISTER_FUNC(SizeClassSize, "NamespaceGC::SizeClassSize", 0);
+	REGISTER_FUNC(SizeClassUsedMemory, "NamespaceGC::SizeClassUsedMemory", 0);
+	REGISTER_FUNC(SizeClassReservedMemory, "NamespaceGC::SizeClassReservedMemory", 0);
+
+	REGISTER_FUNC(SetHeapProfiling, "NamespaceGC::SetHeapProfiling", 0);
+	REGISTER_FUNC(HeapProfileBySite, "NamespaceGC::HeapProfileBySite", 0);
+	REGISTER_FUNC(HeapProfileByType, "NamespaceGC::HeapProfileByType", 0);
+
+	REGISTER_FUNC(SetDeferredFinalization, "NamespaceGC::SetDeferredFinalization", 0);
+	REGISTER_FUNC(PendingFinalizers, "NamespaceGC::PendingFinalizers", 0);
+	REGISTER_FUNC(RunFinalizers, "NamespaceGC::RunFinalizers", 0);
+
+	REGISTER_FUNC(SetCollectionPolicy, "NamespaceGC::SetCollectionPolicy", 0);
+	REGISTER_FUNC(CollectMemoryIfCheap, "NamespaceGC::CollectIfCheap", 0);
+
 	return true;
 }
@@ -22,6 +22,15 @@
 #include "includes/typeinfo.h"
 #include "includes/dynamic.h"
 
+#if !defined(NULLC_NO_EXECUTOR)
+	#if defined(_WIN32)
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+	#elif defined(__linux)
+		#include <dlfcn.h>
+	#endif
+#endif
+
 class ExecutorX86;
 class ExecutorLLVM;
 class ExecutorRegVm;
@@ -57,12 +66,22 @@ namespace NULLC
 	bool enableLogFiles = false;
 	bool enableExternalDebugger = false;
 
+	bool globalCodeExecuted = false;
+
 	void* (*openStream)(const char* name) = OutputContext::FileOpen;
 	void (*writeStream)(void *stream, const char *data, unsigned size) = OutputContext::FileWrite;
 	void (*closeStream)(void* stream) = OutputContext::FileClose;
 
 	int optimizationLevel = 2;
 
+#if defined(NULLC_LLVM_SUPPORT)
+	int compileStage = NULLC_STAGE_LLVM;
+#else
+	int compileStage = NULLC_STAGE_REG_VM;
+#endif
+
+	bool enableVectorFriendlyTranslation = false;
+
 	unsigned moduleAnalyzeMemoryLimit = 128 * 1024 * 1024;
 
 	TraceContext *traceContext = NULL;
@@ -72,6 +91,7 @@ namespace NULLC
 
 unsigned nullcFindFunctionIndex(const char* name);
 nullres	nullcCompileWithModuleRoot(const char* code, const char *moduleRoot);
+void nullcGetNativeModuleMainName(char *buf, unsigned bufSize, const char* moduleName);
 
 #define NULLC_CHECK_INITIALIZED(retval) if(!initialized){ nullcLastError = "ERROR: NULLC is not initialized"; return retval; }
 
@@ -149,6 +169,25 @@ nullres nullcInitCustomAlloc(void* (*allocFunc)(int), void (*deallocFunc)(void*)
 	return 1;
 }
 
+nullres nullcSetPageAllocation(int enable, int hugePages)
+{
+	using namespace NULLC;
+
+	if(initialized)
+	{
+		nullcLastError = "ERROR: page allocation can't be changed after initialization";
+		return 0;
+	}
+
+	if(!NULLC::setPageAllocation(enable != 0, hugePages))
+	{
+		nullcLastError = "ERROR: page allocation mode is not supported";
+		return 0;
+	}
+
+	return 1;
+}
+
 void nullcClearImportPaths()
 {
 	BinaryCache::ClearImportPaths();
@@ -212,6 +251,31 @@ void nullcSetGlobalMemoryLimit(unsigned limit)
 {
 	NULLC::SetGlobalLimit(limit);
 }
+
+nullres nullcSetGCPolicy(const NULLCGCPolicy *policy)
+{
+	using namespace NULLC;
+
+	if(const char *error = NULLC::CheckGCPolicy(*policy))
+	{
+		nullcLastError = error;
+		return 0;
+	}
+
+	NULLC::SetGCPolicy(*policy);
+
+	return 1;
+}
+
+void nullcGetGCPolicy(NULLCGCPolicy *policy)
+{
+	*policy = NULLC::GetGCPolicy();
+}
+
+void nullcSetGCStatsCallback(void *context, void (*callback)(void *context, const NULLCGCStats *stats))
+{
+	NULLC::SetGCStatsCallback(context, callback);
+}
 #endif
 
 void nullcSetEnableLogFiles(int enable, void* (*openStream)(const char* name), void (*writeStream)(void *stream, const char *data, unsigned size), void (*closeStream)(void* stream))
@@ -237,12 +301,28 @@ void nullcSetOptimizationLevel(int level)
 	if(level < 0)
 		level = 0;
 
-	if(level > 2)
-		level = 2;
+	if(level > 3)
+		level = 3;
 
 	NULLC::optimizationLevel = level;
 }
 
+void nullcSetCompileStage(int stage)
+{
+	if(stage < NULLC_STAGE_ANALYZE)
+		stage = NULLC_STAGE_ANALYZE;
+
+	if(stage > NULLC_STAGE_LLVM)
+		stage = NULLC_STAGE_LLVM;
+
+	NULLC::compileStage = stage;
+}
+
+void nullcSetEnableVectorFriendlyTranslation(int enable)
+{
+	NULLC::enableVectorFriendlyTranslation = enable != 0;
+}
+
 void nullcSetEnableTimeTrace(int enable)
 {
 	NULLC::traceContext = NULLC::TraceGetContext();
@@ -290,6 +370,92 @@ nullres	nullcBindModuleFunction(const char* module, void (*ptr)(), const char* n
 #endif
 }
 
+nullres nullcBindNativeModule(const char* module, const char* libraryPath)
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(false);
+
+	TRACE_SCOPE("nullc", "nullcBindNativeModule");
+	TRACE_LABEL(module);
+
+#if !defined(NULLC_NO_EXECUTOR) && (defined(_WIN32) || defined(__linux))
+	typedef int (*NativeModuleEntry)(const char *module, nullres (*bind)(const char *module, void *func, void (*wrap)(void *func, char *retBuf, char *argBuf), const char *name, int index));
+
+	char entryName[NULLC_MAX_VARIABLE_NAME_LENGTH];
+	nullcGetNativeModuleMainName(entryName, NULLC_MAX_VARIABLE_NAME_LENGTH - 8, module);
+	strcat(entryName, "_native");
+
+	// Library stays loaded until the process exits, bound functions might still be referenced from linked code
+#if defined(_WIN32)
+	HMODULE handle = LoadLibraryA(libraryPath);
+	NativeModuleEntry entry = handle ? (NativeModuleEntry)GetProcAddress(handle, entryName) : NULL;
+#else
+	void *handle = dlopen(libraryPath, RTLD_NOW | RTLD_LOCAL);
+	NativeModuleEntry entry = handle ? (NativeModuleEntry)dlsym(handle, entryName) : NULL;
+#endif
+
+	if(!handle)
+	{
+		NULLC::SafeSprintf(errorBuf, NULLC_ERROR_BUFFER_SIZE, "ERROR: failed to load native module library '%s'", libraryPath);
+		nullcLastError = errorBuf;
+		return false;
+	}
+
+	if(!entry)
+	{
+		NULLC::SafeSprintf(errorBuf, NULLC_ERROR_BUFFER_SIZE, "ERROR: native module library '%s' doesn't export '%s'", libraryPath, entryName);
+		nullcLastError = errorBuf;
+
+#if defined(_WIN32)
+		FreeLibrary(handle);
+#else
+		dlclose(handle);
+#endif
+		return false;
+	}
+
+	// Error from the failed binding is kept in nullcLastError
+	if(!entry(module, nullcBindModuleFunctionWrapper))
+	{
+		// Functions bound before the failure point into the library, so the module is removed from the cache before the library is released
+		const unsigned pathLength = 1024;
+		char path[pathLength];
+
+		unsigned importPathPos = 0;
+		while(const char *importPath = BinaryCache::EnumImportPath(importPathPos++))
+		{
+			char *pathNoImport = path + NULLC::SafeSprintf(path, pathLength, "%s", importPath);
+			char *pathEnd = pathNoImport + NULLC::SafeSprintf(pathNoImport, pathLength - unsigned(pathNoImport - path), "%s", module);
+
+			for(char *pos = pathNoImport; pos != pathEnd; pos++)
+			{
+				if(*pos == '.')
+					*pos = '/';
+			}
+
+			NULLC::SafeSprintf(pathEnd, pathLength - unsigned(pathEnd - path), ".nc");
+
+			BinaryCache::RemoveBytecode(path);
+		}
+
+#if defined(_WIN32)
+		FreeLibrary(handle);
+#else
+		dlclose(handle);
+#endif
+		return false;
+	}
+
+	return true;
+#else
+	(void)module;
+	(void)libraryPath;
+
+	nullcLastError = "ERROR: native modules are not supported on this platform";
+	return false;
+#endif
+}
+
 nullres nullcBindModuleFunctionWrapper(const char* module, void *func, void (*ptr)(void *func, char* retBuf, char* argBuf), const char* name, int index)
 {
 	using namespace NULLC;
@@ -473,8 +639,15 @@ nullres nullcLoadModuleByBinary(const char* module, const char* binary)
 		nullcLastError = "ERROR: module already loaded";
 		return false;
 	}
-	// Duplicate binary
-	char *copy = (char*)NULLC::alloc(((ByteCode*)binary)->size);
+
+	if(((ByteCode*)binary)->version != NULLC_BYTECODE_VERSION)
+	{
+		nullcLastError = "ERROR: module binary version mismatch";
+		return false;
+	}
+
+	// Duplicate binary (cache releases it with delete[])
+	char *copy = new char[((ByteCode*)binary)->size];
 	memcpy(copy, binary, ((ByteCode*)binary)->size);
 	binary = copy;
 	// Load it into cache
@@ -591,6 +764,8 @@ nullres	nullcCompileWithModuleRoot(const char* code, const char *moduleRoot)
 	compilerCtx->outputCtx.tempBuf = tempOutputBuf;
 	compilerCtx->outputCtx.tempBufSize = NULLC_TEMP_OUTPUT_BUFFER_SIZE;
 
+	compilerCtx->compileStage = compileStage;
+
 	compilerCtx->code = code;
 	compilerCtx->moduleRoot = moduleRoot;
 
@@ -620,6 +795,12 @@ unsigned nullcGetBytecode(char **bytecode)
 		return 0;
 	}
 
+	if(!compilerCtx->regVmLoweredModule)
+	{
+		nullcLastError = "ERROR: module was not compiled to RegVm";
+		return 0;
+	}
+
 	unsigned size = GetBytecode(*compilerCtx, bytecode);
 
 	// Load it into cache
@@ -640,6 +821,12 @@ unsigned nullcGetBytecodeNoCache(char **bytecode)
 		return 0;
 	}
 
+	if(!compilerCtx->regVmLoweredModule)
+	{
+		nullcLastError = "ERROR: module was not compiled to RegVm";
+		return 0;
+	}
+
 	return GetBytecode(*compilerCtx, bytecode);
 }
 
@@ -656,6 +843,12 @@ nullres nullcSaveListing(const char *fileName)
 		return 0;
 	}
 
+	if(!compilerCtx->regVmLoweredModule)
+	{
+		nullcLastError = "ERROR: module was not compiled to RegVm";
+		return 0;
+	}
+
 	if(!SaveListing(*compilerCtx, fileName))
 	{
 		nullcLastError = compilerCtx->errorBuf;
@@ -678,7 +871,43 @@ nullres	nullcTranslateToC(const char *fileName, const char *mainName, void (*add
 		return 0;
 	}
 
-	if(!TranslateToC(*compilerCtx, fileName, mainName, addDependency))
+	if(!TranslateToC(*compilerCtx, fileName, mainName, addDependency, false, enableVectorFriendlyTranslation))
+	{
+		nullcLastError = compilerCtx->errorBuf;
+		return 0;
+	}
+
+	return 1;
+}
+
+void nullcGetNativeModuleMainName(char *buf, unsigned bufSize, const char* moduleName)
+{
+	NULLC::SafeSprintf(buf, bufSize, "__init_%s_nc", moduleName);
+
+	for(char *pos = buf; *pos; pos++)
+	{
+		if(*pos == '.' || *pos == '/')
+			*pos = '_';
+	}
+}
+
+nullres	nullcTranslateToNativeModule(const char *fileName, const char *moduleName, void (*addDependency)(const char *fileName))
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(0);
+
+	TRACE_SCOPE("nullc", "nullcTranslateToNativeModule");
+
+	if(!compilerCtx)
+	{
+		nullcLastError = "ERROR: there is no active compiler context";
+		return 0;
+	}
+
+	char mainName[NULLC_MAX_VARIABLE_NAME_LENGTH];
+	nullcGetNativeModuleMainName(mainName, NULLC_MAX_VARIABLE_NAME_LENGTH, moduleName);
+
+	if(!TranslateToC(*compilerCtx, fileName, mainName, addDependency, true, enableVectorFriendlyTranslation))
 	{
 		nullcLastError = compilerCtx->errorBuf;
 		return 0;
@@ -697,6 +926,8 @@ void nullcClean()
 #ifndef NULLC_NO_EXECUTOR
 	linker->CleanCode();
 
+	globalCodeExecuted = false;
+
 	#ifdef NULLC_BUILD_X86_JIT
 	executorX86->ClearNative();
 	#endif
@@ -725,6 +956,8 @@ nullres nullcLinkCodeWithModuleName(const char *bytecode, const char *moduleName
 	TRACE_SCOPE("nullc", "nullcLinkCode");
 
 #ifndef NULLC_NO_EXECUTOR
+	globalCodeExecuted = false;
+
 	if(!linker->LinkCode(bytecode, moduleName, true))
 	{
 		nullcLastError = linker->GetLinkError();
@@ -813,6 +1046,106 @@ nullres nullcLinkCodeWithModuleName(const char *bytecode, const char *moduleName
 #endif
 }
 
+nullres nullcRelinkCode(const char *bytecode, const char *changedModule)
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(false);
+
+	TRACE_SCOPE("nullc", "nullcRelinkCode");
+
+#ifndef NULLC_NO_EXECUTOR
+	if(currExec == NULLC_LLVM)
+	{
+		nullcLastError = "ERROR: code relink is not supported by NULLC_LLVM executor";
+		return false;
+	}
+
+	// Main module name storage is reused during link
+	const unsigned moduleNameLength = 1024;
+	char moduleName[moduleNameLength];
+	NULLC::SafeSprintf(moduleName, moduleNameLength, "%.*s", linker->exMainModuleName.size(), linker->exMainModuleName.data);
+
+	unsigned stateIndex = linker->FindModuleState(changedModule);
+
+	if(stateIndex == ~0u)
+	{
+		nullcLastError = linker->GetLinkError();
+		return false;
+	}
+
+	// Unreachable objects are finalized while the code they belong to is still linked
+	NULLC::CollectMemory();
+
+	if(NULLC::PendingFinalizers())
+	{
+		nullcLastError = "ERROR: pending finalizers have to run before code relink";
+		return false;
+	}
+
+	// Type and function indices of the unlinked modules will be reused, kept data can't reference them
+	LinkerModuleState &state = linker->moduleStates[stateIndex];
+
+	unsigned globalSize = 0;
+	char *globals = (char*)nullcGetVariableData(&globalSize);
+
+	CommonSetLinker(linker);
+
+	if(globals && globalSize >= linker->globalVarSize && HasUnlinkedReferences(globals, linker->globalVarSize, state.variableCount, state.globalVarSize, state.typeCount, state.functionCount))
+	{
+		nullcLastError = "ERROR: global data of the kept modules references types or functions of the unlinked modules";
+		return false;
+	}
+
+	executorRegVm->ClearBreakpoints();
+
+	FastVector<char> linkState;
+	linker->SaveState(linkState);
+
+	bool lastGlobalCodeExecuted = globalCodeExecuted;
+
+	linker->UnlinkModule(changedModule);
+
+#ifdef NULLC_BUILD_X86_JIT
+	executorX86->TruncateNative();
+#endif
+
+	if(nullcLinkCodeWithModuleName(bytecode, *moduleName ? moduleName : NULL))
+		return true;
+
+	// Previous program is restored if the new code fails to link
+	char linkError[LINK_ERROR_BUFFER_SIZE];
+	NULLC::SafeSprintf(linkError, LINK_ERROR_BUFFER_SIZE, "%s", nullcLastError);
+
+	linker->RestoreState(linkState.data, linkState.data + linkState.size());
+
+	globalCodeExecuted = lastGlobalCodeExecuted;
+
+#ifdef NULLC_BUILD_X86_JIT
+	if(currExec == NULLC_X86)
+	{
+		OutputContext outputCtx;
+
+		executorX86->ClearNative();
+		executorX86->TranslateToNative(false, outputCtx);
+	}
+#endif
+
+	if(currExec == NULLC_REG_VM)
+		executorRegVm->UpdateInstructionPointer();
+
+	NULLC::SafeSprintf(linker->linkError, LINK_ERROR_BUFFER_SIZE, "%s", linkError);
+	nullcLastError = linker->linkError;
+
+	return false;
+#else
+	(void)bytecode;
+	(void)changedModule;
+
+	nullcLastError = "No executor available, compile library without NULLC_NO_EXECUTOR";
+	return false;
+#endif
+}
+
 nullres nullcBuild(const char* code)
 {
 	return nullcBuildWithModuleName(code, NULL);
@@ -859,6 +1192,133 @@ nullres	nullcRun()
 #endif
 }
 
+#ifndef NULLC_NO_EXECUTOR
+namespace
+{
+	const unsigned programImageMagic = 0x4d49434e; // 'NCIM'
+	const unsigned programImageVersion = 1;
+}
+#endif
+
+unsigned nullcSaveProgramImage(char **image)
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(0);
+
+	TRACE_SCOPE("nullc", "nullcSaveProgramImage");
+
+#ifndef NULLC_NO_EXECUTOR
+	if(currExec != NULLC_REG_VM)
+	{
+		nullcLastError = "ERROR: program image can only be saved from NULLC_REG_VM executor";
+		return 0;
+	}
+
+	if(!globalCodeExecuted)
+	{
+		nullcLastError = "ERROR: global code has to be executed before the program image is saved";
+		return 0;
+	}
+
+	CommonSetLinker(linker);
+
+	FastVector<char> data;
+
+	unsigned header[] = { programImageMagic, programImageVersion, unsigned(sizeof(void*)) };
+	data.push_back((const char*)header, sizeof(header));
+
+	linker->SaveImage(data);
+
+	const char *error = NULL;
+
+	if(!SaveProgramImageData(data, executorRegVm->GetVariableData(NULL), linker->globalVarSize, error))
+	{
+		nullcLastError = error;
+		return 0;
+	}
+
+	*image = new char[data.size()];
+	memcpy(*image, data.data, data.size());
+
+	return data.size();
+#else
+	(void)image;
+
+	nullcLastError = "No executor available, compile library without NULLC_NO_EXECUTOR";
+	return 0;
+#endif
+}
+
+nullres nullcLoadProgramImage(const char *image, unsigned size)
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(false);
+
+	TRACE_SCOPE("nullc", "nullcLoadProgramImage");
+
+#ifndef NULLC_NO_EXECUTOR
+	if(currExec != NULLC_REG_VM)
+	{
+		nullcLastError = "ERROR: program image can only be loaded into NULLC_REG_VM executor";
+		return false;
+	}
+
+	unsigned header[3];
+
+	if(size < sizeof(header))
+	{
+		nullcLastError = "ERROR: program image is corrupted";
+		return false;
+	}
+
+	memcpy(header, image, sizeof(header));
+
+	if(header[0] != programImageMagic || header[1] != programImageVersion || header[2] != sizeof(void*))
+	{
+		nullcLastError = "ERROR: program image format is not supported";
+		return false;
+	}
+
+	const char *pos = image + sizeof(header);
+	const char *end = image + size;
+
+	globalCodeExecuted = false;
+
+	if(!linker->LoadImage(pos, end))
+	{
+		nullcLastError = linker->GetLinkError();
+		return false;
+	}
+
+	char *globals = executorRegVm->InitVariableData();
+
+	const char *error = NULL;
+
+	if(!LoadProgramImageData(pos, end, globals, linker->globalVarSize, error))
+	{
+		linker->CleanCode();
+
+		nullcLastError = error ? error : "ERROR: program image is corrupted";
+		return false;
+	}
+
+	globalCodeExecuted = true;
+
+	nullcLastError = "";
+
+	if(enableExternalDebugger)
+		linker->CollectDebugInfo(NULL);
+
+	return true;
+#else
+	(void)image;
+	(void)size;
+
+	nullcLastError = "No executor available, compile library without NULLC_NO_EXECUTOR";
+	return false;
+#endif
+}
+
 #ifndef NULLC_NO_EXECUTOR
 const char*	nullcGetArgumentVector(unsigned functionID, uintptr_t extra, va_list args)
 {
@@ -1063,6 +1523,9 @@ nullres nullcRunFunctionInternal(unsigned functionID, const char* argBuf)
 			good = false;
 			nullcLastError = executorRegVm->GetErrorMessage();
 		}
+
+		if(functionID == ~0u)
+			globalCodeExecuted = good;
 #else
 		good = false;
 		nullcLastError = "VM execution engine is not available";
@@ -1077,6 +1540,15 @@ nullres nullcRunFunctionInternal(unsigned functionID, const char* argBuf)
 		nullcLastError = "Unknown executor code";
 	}
 
+#ifndef NULLC_NO_EXECUTOR
+	// Global code of the relinked modules was executed, next run resets all global variables
+	if(functionID == ~0u)
+	{
+		linker->keptGlobalVarSize = 0;
+		linker->keptRegVmCodeSize = 0;
+	}
+#endif
+
 #if !defined(NULLC_NO_EXECUTOR) && defined(NULLC_REG_VM_PROFILE_INSTRUCTIONS)
 	if(currExec == NULLC_REG_VM && functionID == ~0u && enableLogFiles)
 	{
@@ -1383,14 +1855,20 @@ nullres nullcRedirectFunction(unsigned sourceId, unsigned targetId)
 	using namespace NULLC;
 	NULLC_CHECK_INITIALIZED(false);
 
+	ExternFuncInfo &destFunc = linker->exFunctions[sourceId];
+	ExternFuncInfo &srcFunc = linker->exFunctions[targetId];
+
+	if(destFunc.attributes & (1 << NULLC_ATTRIBUTE_INLINED))
+	{
+		nullcLastError = "ERROR: function was inlined and can't be redirected";
+		return false;
+	}
+
 #ifdef NULLC_BUILD_X86_JIT
 	if(currExec == NULLC_X86)
 		executorX86->UpdateFunctionPointer(sourceId, targetId);
 #endif
 
-	ExternFuncInfo &destFunc = linker->exFunctions[sourceId];
-	ExternFuncInfo &srcFunc = linker->exFunctions[targetId];
-
 	destFunc.regVmAddress = srcFunc.regVmAddress;
 	destFunc.regVmCodeSize = srcFunc.regVmCodeSize;
 	destFunc.regVmRegisters = srcFunc.regVmRegisters;
@@ -1414,6 +1892,32 @@ nullres nullcIsManagedPointer(void* ptr)
 	return NULLC::IsBasePointer(ptr);
 }
 
+void nullcSetDeferredFinalization(int enable)
+{
+	NULLC::SetDeferredFinalization(enable != 0);
+}
+
+unsigned nullcGetPendingFinalizerCount()
+{
+	return NULLC::PendingFinalizers();
+}
+
+unsigned nullcRunPendingFinalizers(unsigned maxCount)
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(0);
+
+	return NULLC::RunPendingFinalizers(maxCount);
+}
+
+nullres nullcCollectMemoryIfCheap()
+{
+	using namespace NULLC;
+	NULLC_CHECK_INITIALIZED(0);
+
+	return NULLC::CollectMemoryIfCheap();
+}
+
 #endif
 
 unsigned nullcGetResultType()
@@ -2351,6 +2855,16 @@ const char* nullcDebugGetNativeAddressLocation(void *address, unsigned full)
 	return nullcDebugGetVmAddressLocation(instruction, full);
 }
 
+void nullcDebugEnableHeapProfiling(int enable)
+{
+	NULLC::SetHeapProfiling(enable != 0);
+}
+
+const char* nullcDebugGetHeapProfile(int byType)
+{
+	return NULLC::HeapProfileReport(byType != 0);
+}
+
 #endif
 
 CompilerContext* nullcGetCompilerContext()
@@ -13,6 +13,8 @@ extern "C"
 
 nullres		nullcInit();
 nullres		nullcInitCustomAlloc(void* (*allocFunc)(int), void (*deallocFunc)(void*));
+/*	Reserve heap pages, big objects and executor stacks directly from the system, zeroing them lazily on first access, hugePages is one of NULLC_HUGE_PAGES_*. Must be called before initialization, returns 0 if the mode is not supported on the platform	*/
+nullres		nullcSetPageAllocation(int enable, int hugePages);
 
 void		nullcClearImportPaths();
 void		nullcAddImportPath(const char* importPath);
@@ -21,8 +23,17 @@ nullres		nullcHasImportPath(const char* importPath);
 
 void		nullcSetFileReadHandler(const char* (*fileLoadFunc)(const char* name, unsigned* size), void (*fileFreeFunc)(const char* data));
 void		nullcSetGlobalMemoryLimit(unsigned limit);
+/*	Set heuristics that decide when an allocation triggers a garbage collection, defaults are a 1Mb initial threshold that is doubled when more than 2/3 of it survives a collection	*/
+nullres		nullcSetGCPolicy(const NULLCGCPolicy *policy);
+void		nullcGetGCPolicy(NULLCGCPolicy *policy);
+/*	Callback is called with the statistics of every garbage collection	*/
+void		nullcSetGCStatsCallback(void *context, void (*callback)(void *context, const NULLCGCStats *stats));
 void		nullcSetEnableLogFiles(int enable, void* (*openStream)(const char* name), void (*writeStream)(void *stream, const char *data, unsigned size), void (*closeStream)(void* stream));
 void		nullcSetOptimizationLevel(int level);
+/*	Set the last stage performed by nullcCompile to one of NULLC_STAGE_ANALYZE/NULLC_STAGE_VM/NULLC_STAGE_REG_VM/NULLC_STAGE_LLVM. Bytecode is only available from NULLC_STAGE_REG_VM	*/
+void		nullcSetCompileStage(int stage);
+/*	Translate counted loops over arrays to C++ with hoisted bounds checks and raw element pointers, so that a C++ compiler can vectorize them	*/
+void		nullcSetEnableVectorFriendlyTranslation(int enable);
 void		nullcSetEnableTimeTrace(int enable);
 void		nullcSetModuleAnalyzeMemoryLimit(unsigned bytes);
 void		nullcSetEnableExternalDebugger(int enable);
@@ -42,6 +53,10 @@ nullres		nullcBindModuleFunction(const char* module, void (*ptr)(), const char*
 
 nullres		nullcBindModuleFunctionWrapper(const char* module, void *func, void (*ptr)(void *func, char* retBuf, char* argBuf), const char* name, int index);
 
+/*	Binds module functions to native code from a shared library built from nullcTranslateToNativeModule output. Only global functions with basic type arguments are bound.
+	Native code keeps its own copy of module global variables, so functions that access module state must not be translated	*/
+nullres		nullcBindNativeModule(const char* module, const char* libraryPath);
+
 /*	Builds module and saves its binary into binary cache	*/
 nullres		nullcLoadModuleBySource(const char* module, const char* code);
 
@@ -91,6 +106,13 @@ nullres		nullcRun();
 nullres		nullcRunFunction(const char* funcName, ...);
 nullres		nullcRunFunctionInternal(unsigned functionID, const char* argBuf);
 
+/*	Saves linked code, global variables and heap objects after global code was executed by NULLC_REG_VM executor into a relocatable image.
+	Returns image size, image must be deleted with delete[]. Native module state is not saved, modules must be initialized in the same way before the image is loaded.
+	Saving fails if global data references memory that is not owned by the program and loading fails if module binaries differ from the ones the image was saved with	*/
+unsigned	nullcSaveProgramImage(char **image);
+/*	Replaces linked code with the program image contents, global code is not executed again	*/
+nullres		nullcLoadProgramImage(const char *image, unsigned size);
+
 /*	Retrieve result	*/
 unsigned	nullcGetResultType();
 NULLCRef	nullcGetResultObject();
@@ -147,7 +169,7 @@ nullres		nullcGetFunction(const char* name, NULLCFuncPtr* func);
 /*	Set function using function pointer	*/
 nullres		nullcSetFunction(const char* name, NULLCFuncPtr func);
 
-/*	Change one function to target another	*/
+/*	Change one function to target another. Functions that were inlined by optimization level 3 can't be changed	*/
 nullres		nullcRedirectFunction(unsigned sourceId, unsigned targetId);
 
 /*	Function returns 1 if passed pointer points to NULLC stack; otherwise, the return value is 0	*/
@@ -156,6 +178,16 @@ nullres		nullcIsStackPointer(void* ptr);
 /*	Function returns 1 if passed pointer points to a memory managed by NULLC GC; otherwise, the return value is 0	*/
 nullres		nullcIsManagedPointer(void* ptr);
 
+/*	When finalization is deferred, collections only queue the finalizers of unreachable objects, so that a collection triggered by an allocation doesn't run user code	*/
+void		nullcSetDeferredFinalization(int enable);
+/*	Get the number of objects waiting for their finalizers	*/
+unsigned	nullcGetPendingFinalizerCount();
+/*	Run up to maxCount queued finalizers, returns the number of finalized objects	*/
+unsigned	nullcRunPendingFinalizers(unsigned maxCount);
+
+/*	Collect memory if anything was allocated after the last collection and the estimated pause fits the pause budget of the collection policy. Returns 1 if collection was performed	*/
+nullres		nullcCollectMemoryIfCheap();
+
 #endif
 
 /************************************************************************/
@@ -184,6 +216,9 @@ nullres		nullcSaveListing(const char *fileName);
 /*	This function saved analog of C++ code of last compiled code into file	*/
 nullres		nullcTranslateToC(const char *fileName, const char *mainName, void (*addDependency)(const char *fileName));
 
+/*	This function saves C++ code of last compiled module with an entry point for nullcBindNativeModule	*/
+nullres		nullcTranslateToNativeModule(const char *fileName, const char *moduleName, void (*addDependency)(const char *fileName));
+
 /*	Clean all accumulated bytecode	*/
 void		nullcClean();
 
@@ -195,6 +230,14 @@ nullres		nullcLinkCode(const char *bytecode);
 /*	Link new chunk of code with an additional module name info	*/
 nullres		nullcLinkCodeWithModuleName(const char *bytecode, const char *moduleName);
 
+/*	Replace linked code after the main module or one of the modules was changed.
+	'changedModule' and everything linked after it (only the last main module if 'changedModule' is NULL) is unlinked and 'bytecode' is linked in its place, modules that are missing are taken from the module cache.
+	Global variables of the modules that are kept stay intact and the next nullcRun call executes only the global code of the relinked modules.
+	Relink fails if data reachable from the kept global variables references types, functions or global variables of the unlinked modules.
+	If 'bytecode' fails to link, the previously linked code is restored.
+	Changed module has to be loaded with nullcLoadModuleByBinary, because nullcLoadModuleBySource cleans all linked code. */
+nullres		nullcRelinkCode(const char *bytecode, const char *changedModule);
+
 /************************************************************************/
 /*							Internal testing functions					*/
 
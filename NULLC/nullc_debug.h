@@ -64,6 +64,11 @@ NULLC_DEBUG_EXPORT unsigned		nullcDebugGetReversedStackDataBase(unsigned framePo
 NULLC_DEBUG_EXPORT const char*	nullcDebugGetVmAddressLocation(unsigned instruction, unsigned full);
 NULLC_DEBUG_EXPORT const char*	nullcDebugGetNativeAddressLocation(void *address, unsigned full);
 
+// Heap profiling attributes every GC allocation to the instruction and type that requested it. Enabling the profiling clears the previous profile
+void				nullcDebugEnableHeapProfiling(int enable);
+// Get a table of live and allocated memory by allocation site or by type. Live memory is updated by every collection
+const char*			nullcDebugGetHeapProfile(int byType);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,7 @@ CompilerContext* nullcGetCompilerContext();
 nullres nullcBindModuleFunctionBuiltin(const char* module, const char* name, int index, unsigned builtinIndex);
 
 #define NULLC_ATTRIBUTE_NO_MEMORY_WRITE 0
+#define NULLC_ATTRIBUTE_INLINED 1
 
 nullres nullcSetModuleFunctionAttribute(const char* module, const char* name, int index, unsigned attribute, unsigned value);
 
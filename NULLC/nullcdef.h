@@ -34,6 +34,30 @@ struct NULLCAutoArray
 
 #pragma pack(pop)
 
+// Heuristics that decide when an allocation triggers a garbage collection
+struct NULLCGCPolicy
+{
+	// Memory usage in bytes that triggers the first collection
+	unsigned int	initialThreshold;
+	// Collection threshold is multiplied by the growth factor when memory that survived a collection exceeds the target utilization of the threshold
+	double			growthFactor;
+	double			targetUtilization;
+	// Longest estimated pause in seconds accepted by a collection that is only performed if it is cheap, 0 accepts any pause
+	double			maxPauseTime;
+};
+
+// Statistics of a single garbage collection
+struct NULLCGCStats
+{
+	unsigned int	usedMemoryBefore;
+	unsigned int	usedMemoryAfter;
+	unsigned int	markedObjects;
+	unsigned int	freedObjects;
+	unsigned int	nextThreshold;
+	double			markTime;
+	double			pauseTime;
+};
+
 #define NULLC_MAX_VARIABLE_NAME_LENGTH 2048
 #define NULLC_MAX_TYPE_NAME_LENGTH 8192
 #define NULLC_DEFAULT_GLOBAL_MEMORY_LIMIT 1024 * 1024 * 1024
@@ -43,6 +67,17 @@ struct NULLCAutoArray
 #define NULLC_MAX_GENERIC_INSTANCE_DEPTH 64
 #define NULLC_MAX_EXPRESSION_DEPTH 2048
 #define NULLC_MAX_TYPE_SIZE	256 * 1024 * 1024
+#define NULLC_MAX_INLINE_CALLEE_SIZE 16
+#define NULLC_MAX_INLINE_CALLER_GROWTH 256
+#define NULLC_MAX_UNROLL_TRIP_COUNT 8
+#define NULLC_MAX_UNROLL_SIZE 64
+
+// Has to be changed every time the module binary layout changes
+#define NULLC_BYTECODE_VERSION 1
+
+// Module pack starts with a 16 byte header: "ncm" magic, bytecode version and padding
+#define NULLC_MODULE_PACK_MAGIC "ncm"
+#define NULLC_MODULE_PACK_HEADER_SIZE 16
 
 //#define NULLC_STACK_TRACE_WITH_LOCALS
 
@@ -81,6 +116,10 @@ struct NULLCAutoArray
 
 //#define NULLC_LLVM_SUPPORT
 
+#if (defined(__SSE2__) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(NULLC_NO_SIMD)
+	#define NULLC_LEXER_SSE2
+#endif
+
 // Library will export some publicly visible functions and variables required for external debuggers to read debug information
 //#define NULLC_EXPORT_EXTERNAL_DEBUGGER_SYMBOLS
 
@@ -90,6 +129,17 @@ typedef unsigned char nullres;
 #define NULLC_X86		1
 #define NULLC_LLVM		2
 
+// Last compilation stage performed by nullcCompile
+#define NULLC_STAGE_ANALYZE	0
+#define NULLC_STAGE_VM		1
+#define NULLC_STAGE_REG_VM	2
+#define NULLC_STAGE_LLVM	3
+
+// Huge page usage for memory reserved from the system
+#define NULLC_HUGE_PAGES_NONE			0
+#define NULLC_HUGE_PAGES_TRANSPARENT	1
+#define NULLC_HUGE_PAGES_EXPLICIT		2
+
 #ifdef __x86_64__
 	#define _M_X64
 #endif
@@ -1,5 +1,12 @@
 #include "stdafx.h"
 
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(__linux)
+	#include <sys/mman.h>
+#endif
+
 void*	NULLC::defaultAlloc(int size)
 {
 	return ::new(std::nothrow) char[size];
@@ -39,6 +46,131 @@ void NULLC::alignedDealloc(void* ptr)
 	dealloc(unaligned);
 }
 
+bool	NULLC::pageAllocation = false;
+int		NULLC::pageAllocationHugePages = NULLC_HUGE_PAGES_NONE;
+
+namespace
+{
+	const unsigned smallPageSize = 4096;
+	const unsigned hugePageSize = 2 * 1024 * 1024;
+}
+
+bool NULLC::setPageAllocation(bool enable, int hugePages)
+{
+	if(hugePages < NULLC_HUGE_PAGES_NONE || hugePages > NULLC_HUGE_PAGES_EXPLICIT)
+		return false;
+
+#if defined(_WIN32)
+	// Large pages require a user privilege that can't be expected from the host application
+	if(hugePages != NULLC_HUGE_PAGES_NONE)
+		return false;
+#elif !defined(__linux)
+	if(enable)
+		return false;
+#endif
+
+	pageAllocation = enable;
+	pageAllocationHugePages = enable ? hugePages : NULLC_HUGE_PAGES_NONE;
+
+	return true;
+}
+
+unsigned NULLC::pageAllocationGranularity()
+{
+	return pageAllocationHugePages != NULLC_HUGE_PAGES_NONE ? hugePageSize : smallPageSize;
+}
+
+unsigned NULLC::pageAllocationSize(unsigned size)
+{
+	if(!pageAllocation)
+		return size;
+
+	unsigned granularity = pageAllocationGranularity();
+
+	return (size + granularity - 1) & ~(granularity - 1);
+}
+
+void* NULLC::allocPages(unsigned size)
+{
+	if(!pageAllocation)
+	{
+		void *ptr = alloc(size);
+
+		if(ptr)
+			memset(ptr, 0, size);
+
+		return ptr;
+	}
+
+	size = pageAllocationSize(size);
+
+#if defined(_WIN32)
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux)
+	if(pageAllocationHugePages == NULLC_HUGE_PAGES_NONE)
+	{
+		void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		return ptr == MAP_FAILED ? NULL : ptr;
+	}
+
+#if defined(MAP_HUGETLB)
+	// Explicit huge pages come from the reserved pool, when it's exhausted we fall back to transparent huge pages
+	if(pageAllocationHugePages == NULLC_HUGE_PAGES_EXPLICIT)
+	{
+		void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if(ptr != MAP_FAILED)
+			return ptr;
+	}
+#endif
+
+	// Transparent huge pages can only back ranges aligned to the huge page size, so the reservation is trimmed to an aligned range
+	char *reserved = (char*)mmap(NULL, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if(reserved == (char*)MAP_FAILED)
+		return NULL;
+
+	char *ptr = (char*)((uintptr_t(reserved) + hugePageSize - 1) & ~uintptr_t(hugePageSize - 1));
+
+	if(ptr != reserved)
+		munmap(reserved, ptr - reserved);
+
+	if(ptr + size != reserved + size + hugePageSize)
+		munmap(ptr + size, (reserved + size + hugePageSize) - (ptr + size));
+
+#if defined(MADV_HUGEPAGE)
+	madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+
+	return ptr;
+#else
+	return NULL;
+#endif
+}
+
+void NULLC::deallocPages(void* ptr, unsigned size)
+{
+	if(!ptr)
+		return;
+
+	if(!pageAllocation)
+	{
+		dealloc(ptr);
+		return;
+	}
+
+#if defined(_WIN32)
+	(void)size;
+
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(__linux)
+	munmap(ptr, pageAllocationSize(size));
+#else
+	(void)size;
+#endif
+}
+
 const char* NULLC::defaultFileLoad(const char* name, unsigned* size)
 {
 	assert(name);
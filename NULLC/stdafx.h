@@ -47,6 +47,23 @@ namespace NULLC
 	void*	alignedAlloc(int size, int extraSize);
 	void	alignedDealloc(void* ptr);
 
+	// Large blocks can be reserved directly from the system, bypassing the allocator
+	// Physical memory is committed on first access, which also places it on the NUMA node of the thread that touches it first
+	extern bool		pageAllocation;
+	extern int		pageAllocationHugePages;
+
+	bool		setPageAllocation(bool enable, int hugePages);
+
+	// Smallest block that is reserved from the system, huge page size when huge pages are enabled
+	unsigned	pageAllocationGranularity();
+
+	// Size of the block that is reserved for the requested size
+	unsigned	pageAllocationSize(unsigned size);
+
+	// Returned memory is zero-filled and at least 16 byte aligned
+	void*	allocPages(unsigned size);
+	void	deallocPages(void* ptr, unsigned size);
+
 	template<typename T>
 	static T*		construct()
 	{
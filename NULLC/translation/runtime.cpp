@@ -2085,13 +2085,40 @@ struct LargeBlock
 	LargeBlock	*next;
 };
 
+class ObjectBlockPoolBase
+{
+public:
+	ObjectBlockPoolBase(unsigned blockSize, unsigned blocksInPage): blockSize(blockSize), blocksInPage(blocksInPage), usedCount(0), pageCount(0)
+	{
+	}
+
+	virtual ~ObjectBlockPoolBase()
+	{
+	}
+
+	virtual void* Alloc() = 0;
+
+	virtual bool IsBasePointer(void* ptr) = 0;
+	virtual void* GetBasePointer(void* ptr) = 0;
+
+	virtual void Mark(unsigned int number) = 0;
+	virtual unsigned int FreeMarked() = 0;
+
+	unsigned	blockSize;
+	unsigned	blocksInPage;
+
+	// Number of blocks that are not in the free list and number of pages reserved by the pool
+	unsigned	usedCount;
+	unsigned	pageCount;
+};
+
 template<int elemSize, int countInBlock>
-class ObjectBlockPool
+class ObjectBlockPool: public ObjectBlockPoolBase
 {
 	typedef SmallBlock<elemSize> MySmallBlock;
 	typedef LargeBlock<elemSize, countInBlock> MyLargeBlock;
 public:
-	ObjectBlockPool()
+	ObjectBlockPool(): ObjectBlockPoolBase(elemSize, countInBlock)
 	{
 		freeBlocks = &lastBlock;
 		activePages = NULL;
@@ -2128,6 +2155,7 @@ public:
 				newPage->next = activePages;
 				activePages = newPage;
 				lastNum = 0;
+				pageCount++;
 				sortedPages.push_back(newPage);
 				int index = sortedPages.size() - 1;
 				while(index > 0 && sortedPages[index] < sortedPages[index - 1])
@@ -2140,6 +2168,7 @@ public:
 			}
 			result = &activePages->page[lastNum++];
 		}
+		usedCount++;
 		return result;
 	}
 
@@ -2150,6 +2179,7 @@ public:
 		MySmallBlock* freedBlock = static_cast<MySmallBlock*>(static_cast<void*>(ptr));
 		freedBlock->next = (MySmallBlock*)((intptr_t)freeBlocks | OBJECT_FREED);
 		freeBlocks = freedBlock;
+		usedCount--;
 	}
 	bool IsBasePointer(void* ptr)
 	{
@@ -2158,7 +2188,7 @@ public:
 		{
 			if((char*)ptr >= (char*)curr->page && (char*)ptr <= (char*)curr->page + sizeof(MyLargeBlock))
 			{
-				if(((unsigned int)(intptr_t)((char*)ptr - (char*)curr->page) & (elemSize - 1)) == 4)
+				if(((unsigned int)(intptr_t)((char*)ptr - (char*)curr->page) % elemSize) == 4)
 					return true;
 			}
 			curr = curr->next;
@@ -2190,7 +2220,7 @@ public:
 		if(ptr < best->page || ptr > (char*)best + sizeof(best->page))
 			return NULL;
 		unsigned int fromBase = (unsigned int)(intptr_t)((char*)ptr - (char*)best->page);
-		return (char*)best->page + (fromBase & ~(elemSize - 1)) + sizeof(markerType);
+		return (char*)best->page + (fromBase - fromBase % elemSize) + sizeof(markerType);
 	}
 	void Mark(unsigned int number)
 	{
@@ -2241,8 +2271,10 @@ public:
 namespace NULLC
 {
 	const unsigned int poolBlockSize = 64 * 1024;
+	const unsigned int largePoolBlockSize = 128 * 1024;
 
 	unsigned int usedMemory = 0;
+	unsigned int bigBlockMemory = 0;
 
 	unsigned int collectableMinimum = 1024 * 1024;
 	unsigned int globalMemoryLimit = 1024 * 1024 * 1024;
@@ -2250,11 +2282,50 @@ namespace NULLC
 	ObjectBlockPool<8, poolBlockSize / 8>		pool8;
 	ObjectBlockPool<16, poolBlockSize / 16>		pool16;
 	ObjectBlockPool<32, poolBlockSize / 32>		pool32;
+	ObjectBlockPool<48, poolBlockSize / 48>		pool48;
 	ObjectBlockPool<64, poolBlockSize / 64>		pool64;
+	ObjectBlockPool<96, poolBlockSize / 96>		pool96;
 	ObjectBlockPool<128, poolBlockSize / 128>	pool128;
+	ObjectBlockPool<192, poolBlockSize / 192>	pool192;
 	ObjectBlockPool<256, poolBlockSize / 256>	pool256;
+	ObjectBlockPool<384, poolBlockSize / 384>	pool384;
 	ObjectBlockPool<512, poolBlockSize / 512>	pool512;
 
+	// Mid-size objects and arrays are placed in pages of a large object space instead of getting a separate allocation each
+	ObjectBlockPool<768, largePoolBlockSize / 768>		pool768;
+	ObjectBlockPool<1024, largePoolBlockSize / 1024>	pool1024;
+	ObjectBlockPool<1536, largePoolBlockSize / 1536>	pool1536;
+	ObjectBlockPool<2048, largePoolBlockSize / 2048>	pool2048;
+	ObjectBlockPool<3072, largePoolBlockSize / 3072>	pool3072;
+	ObjectBlockPool<4096, largePoolBlockSize / 4096>	pool4096;
+	ObjectBlockPool<6144, largePoolBlockSize / 6144>	pool6144;
+	ObjectBlockPool<8192, largePoolBlockSize / 8192>	pool8192;
+
+	ObjectBlockPoolBase* pools[] = { &pool8, &pool16, &pool32, &pool48, &pool64, &pool96, &pool128, &pool192, &pool256, &pool384, &pool512, &pool768, &pool1024, &pool1536, &pool2048, &pool3072, &pool4096, &pool6144, &pool8192 };
+
+	const unsigned poolCount = sizeof(pools) / sizeof(pools[0]);
+
+	const unsigned maxPoolObjectSize = 8192;
+
+	// Pool lookup by object size in 16 byte steps
+	ObjectBlockPoolBase* poolBySize[maxPoolObjectSize / 16 + 1];
+
+	struct PoolBySizeInit
+	{
+		PoolBySizeInit()
+		{
+			unsigned pool = 1;
+
+			for(unsigned i = 0; i <= maxPoolObjectSize / 16; i++)
+			{
+				while(pools[pool]->blockSize < i * 16)
+					pool++;
+
+				poolBySize[i] = pools[pool];
+			}
+		}
+	} poolBySizeInit;
+
 	struct Range
 	{
 		Range(): start(NULL), end(NULL)
@@ -2321,59 +2392,34 @@ void* NULLC::AllocObject(int size, unsigned typeID)
 		CollectMemory();
 	}
 	unsigned int realSize = size;
-	if(size <= 64)
+	if(size <= 8)
+	{
+		data = pool8.Alloc();
+		realSize = 8;
+	}
+	else if(unsigned(size) <= maxPoolObjectSize)
+	{
+		ObjectBlockPoolBase *pool = poolBySize[(size + 15) >> 4];
+
+		data = pool->Alloc();
+		realSize = pool->blockSize;
+	}
+	else
 	{
-		if(size <= 16)
+		void *ptr = NULLC::alignedAlloc(size - sizeof(markerType), 4 + sizeof(markerType));
+		if(ptr == NULL)
 		{
-			if(size <= 8)
-			{
-				data = pool8.Alloc();
-				realSize = 8;
-			}else{
-				data = pool16.Alloc();
-				realSize = 16;
-			}
-		}else{
-			if(size <= 32)
-			{
-				data = pool32.Alloc();
-				realSize = 32;
-			}else{
-				data = pool64.Alloc();
-				realSize = 64;
-			}
+			nullcThrowError("Allocation failed.");
+			return NULL;
 		}
-	}else{
-		if(size <= 256)
-		{
-			if(size <= 128)
-			{
-				data = pool128.Alloc();
-				realSize = 128;
-			}else{
-				data = pool256.Alloc();
-				realSize = 256;
-			}
-		}else{
-			if(size <= 512)
-			{
-				data = pool512.Alloc();
-				realSize = 512;
-			}else{
-				void *ptr = NULLC::alignedAlloc(size - sizeof(markerType), 4 + sizeof(markerType));
-				if(ptr == NULL)
-				{
-					nullcThrowError("Allocation failed.");
-					return NULL;
-				}
 
-				Range range(ptr, (char*)ptr + size + 4);
-				bigBlocks.insert(range);
+		Range range(ptr, (char*)ptr + size + 4);
+		bigBlocks.insert(range);
 
-				realSize = *(int*)ptr = size;
-				data = (char*)ptr + 4;
-			}
-		}
+		realSize = *(int*)ptr = size;
+		data = (char*)ptr + 4;
+
+		bigBlockMemory += realSize;
 	}
 	usedMemory += realSize;
 
@@ -2449,32 +2495,18 @@ void NULLC::MarkMemory(unsigned int number)
 
 	bigBlocks.for_each(MarkBlock);
 
-	pool8.Mark(number);
-	pool16.Mark(number);
-	pool32.Mark(number);
-	pool64.Mark(number);
-	pool128.Mark(number);
-	pool256.Mark(number);
-	pool512.Mark(number);
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->Mark(number);
 }
 
 bool NULLC::IsBasePointer(void* ptr)
 {
 	// Search in range of every pool
-	if(pool8.IsBasePointer(ptr))
-		return true;
-	if(pool16.IsBasePointer(ptr))
-		return true;
-	if(pool32.IsBasePointer(ptr))
-		return true;
-	if(pool64.IsBasePointer(ptr))
-		return true;
-	if(pool128.IsBasePointer(ptr))
-		return true;
-	if(pool256.IsBasePointer(ptr))
-		return true;
-	if(pool512.IsBasePointer(ptr))
-		return true;
+	for(unsigned i = 0; i < poolCount; i++)
+	{
+		if(pools[i]->IsBasePointer(ptr))
+			return true;
+	}
 
 	// Search in global pool
 	if(BigBlockIterator it = bigBlocks.find(Range(ptr, ptr)))
@@ -2491,20 +2523,11 @@ bool NULLC::IsBasePointer(void* ptr)
 void* NULLC::GetBasePointer(void* ptr)
 {
 	// Search in range of every pool
-	if(void *base = pool8.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool16.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool32.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool64.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool128.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool256.GetBasePointer(ptr))
-		return base;
-	if(void *base = pool512.GetBasePointer(ptr))
-		return base;
+	for(unsigned i = 0; i < poolCount; i++)
+	{
+		if(void *base = pools[i]->GetBasePointer(ptr))
+			return base;
+	}
 
 	// Search in global pool
 	if(BigBlockIterator it = bigBlocks.find(Range(ptr, ptr)))
@@ -2530,6 +2553,7 @@ void NULLC::CollectBlock(Range& curr)
 			NULLC::FinalizeObject(marker, (char*)block + 4);
 		}else{
 			usedMemory -= *(unsigned int*)block;
+			bigBlockMemory -= *(unsigned int*)block;
 			NULLC::alignedDealloc(block);
 
 			toErase.push_back(curr);
@@ -2572,27 +2596,12 @@ void NULLC::CollectMemory()
 //	printf("%d used memory\r\n", usedMemory);
 
 	// Objects allocated from pools are freed
-	unusedBlocks = pool8.FreeMarked();
-	usedMemory -= unusedBlocks * 8;
-//	printf("%d unused pool blocks freed (8 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool16.FreeMarked();
-	usedMemory -= unusedBlocks * 16;
-//	printf("%d unused pool blocks freed (16 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool32.FreeMarked();
-	usedMemory -= unusedBlocks * 32;
-//	printf("%d unused pool blocks freed (32 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool64.FreeMarked();
-	usedMemory -= unusedBlocks * 64;
-//	printf("%d unused pool blocks freed (64 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool128.FreeMarked();
-	usedMemory -= unusedBlocks * 128;
-//	printf("%d unused pool blocks freed (128 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool256.FreeMarked();
-	usedMemory -= unusedBlocks * 256;
-//	printf("%d unused pool blocks freed (256 bytes)\r\n", unusedBlocks);
-	unusedBlocks = pool512.FreeMarked();
-	usedMemory -= unusedBlocks * 512;
-//	printf("%d unused pool blocks freed (512 bytes)\r\n", unusedBlocks);
+	for(unsigned i = 0; i < poolCount; i++)
+	{
+		unusedBlocks = pools[i]->FreeMarked();
+		usedMemory -= unusedBlocks * pools[i]->blockSize;
+//		printf("%d unused pool blocks freed (%d bytes)\r\n", unusedBlocks, pools[i]->blockSize);
+	}
 
 	GC_DEBUG_PRINT("%d used memory\r\n", usedMemory);
 
@@ -2615,6 +2624,64 @@ double NULLC::CollectTime()
 	return collectTime;
 }
 
+unsigned int NULLC::ReservedMemory()
+{
+	unsigned int reserved = bigBlockMemory;
+
+	for(unsigned i = 0; i < poolCount; i++)
+		reserved += pools[i]->pageCount * pools[i]->blocksInPage * pools[i]->blockSize;
+
+	return reserved;
+}
+
+double NULLC::HeapFragmentation()
+{
+	unsigned int reserved = ReservedMemory();
+
+	if(!reserved)
+		return 0.0;
+
+	return double(reserved - usedMemory) / reserved;
+}
+
+int NULLC::SizeClassCount()
+{
+	return int(poolCount);
+}
+
+int NULLC::SizeClassSize(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->blockSize);
+}
+
+int NULLC::SizeClassUsedMemory(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->usedCount * pools[index]->blockSize);
+}
+
+int NULLC::SizeClassReservedMemory(int index)
+{
+	if(unsigned(index) >= poolCount)
+	{
+		nullcThrowError("ERROR: size class index %d is out of range", index);
+		return 0;
+	}
+
+	return int(pools[index]->pageCount * pools[index]->blocksInPage * pools[index]->blockSize);
+}
+
 void NULLC::FinalizeBlock(Range& curr)
 {
 	void *block = curr.start;
@@ -2627,13 +2694,9 @@ void NULLC::FinalizeBlock(Range& curr)
 void NULLC::FinalizeMemory()
 {
 	MarkMemory(0);
-	pool8.FreeMarked();
-	pool16.FreeMarked();
-	pool32.FreeMarked();
-	pool64.FreeMarked();
-	pool128.FreeMarked();
-	pool256.FreeMarked();
-	pool512.FreeMarked();
+
+	for(unsigned i = 0; i < poolCount; i++)
+		pools[i]->FreeMarked();
 
 	bigBlocks.for_each(FinalizeBlock);
 
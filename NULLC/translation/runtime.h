@@ -369,6 +369,14 @@ namespace NULLC
 	double		MarkTime();
 	double		CollectTime();
 
+	unsigned int	ReservedMemory();
+	double		HeapFragmentation();
+
+	int			SizeClassCount();
+	int			SizeClassSize(int index);
+	int			SizeClassUsedMemory(int index);
+	int			SizeClassReservedMemory(int index);
+
 	void		FinalizeMemory();
 }
 
@@ -20,3 +20,71 @@ double NamespaceGC__CollectTime_double_ref__(NamespaceGC * __context)
 {
 	return NULLC::CollectTime();
 }
+
+int NamespaceGC__ReservedMemory_int_ref__(NamespaceGC * __context)
+{
+	return NULLC::ReservedMemory();
+}
+double NamespaceGC__HeapFragmentation_double_ref__(NamespaceGC * __context)
+{
+	return NULLC::HeapFragmentation();
+}
+
+int NamespaceGC__SizeClassCount_int_ref__(NamespaceGC * __context)
+{
+	return NULLC::SizeClassCount();
+}
+int NamespaceGC__SizeClassSize_int_ref_int_(int index, NamespaceGC * __context)
+{
+	return NULLC::SizeClassSize(index);
+}
+int NamespaceGC__SizeClassUsedMemory_int_ref_int_(int index, NamespaceGC * __context)
+{
+	return NULLC::SizeClassUsedMemory(index);
+}
+int NamespaceGC__SizeClassReservedMemory_int_ref_int_(int index, NamespaceGC * __context)
+{
+	return NULLC::SizeClassReservedMemory(index);
+}
+
+// Translated code has no allocation site information, so the heap profile is always empty
+void NamespaceGC__SetHeapProfiling_void_ref_bool_(bool enabled, NamespaceGC * __context)
+{
+}
+NULLCArray<char> NamespaceGC__HeapProfileBySite_char___ref__(NamespaceGC * __context)
+{
+	NULLCArray<char> ret;
+	ret.ptr = (char*)"";
+	ret.size = 1;
+	return ret;
+}
+NULLCArray<char> NamespaceGC__HeapProfileByType_char___ref__(NamespaceGC * __context)
+{
+	NULLCArray<char> ret;
+	ret.ptr = (char*)"";
+	ret.size = 1;
+	return ret;
+}
+
+// Translated code runs finalizers inside the collection, so the queue is always empty
+void NamespaceGC__SetDeferredFinalization_void_ref_bool_(bool enabled, NamespaceGC * __context)
+{
+}
+int NamespaceGC__PendingFinalizers_int_ref__(NamespaceGC * __context)
+{
+	return 0;
+}
+int NamespaceGC__RunFinalizers_int_ref_int_(int maxCount, NamespaceGC * __context)
+{
+	return 0;
+}
+
+// Translated runtime keeps its own collection heuristics
+void NamespaceGC__SetCollectionPolicy_void_ref_int_double_double_double_(int initialThreshold, double growthFactor, double targetUtilization, double maxPauseTime, NamespaceGC * __context)
+{
+}
+bool NamespaceGC__CollectIfCheap_bool_ref__(NamespaceGC * __context)
+{
+	NULLC::CollectMemory();
+	return true;
+}
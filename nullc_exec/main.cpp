@@ -35,6 +35,17 @@
 
 typedef nullres (*externalInit)(nullres (*)(const char*, const char*), nullres (*)(const char*, void (*)(), const char*, int));
 
+bool IsModulePackCompatible(const char *data, unsigned size)
+{
+	if(size < NULLC_MODULE_PACK_HEADER_SIZE || memcmp(data, NULLC_MODULE_PACK_MAGIC, sizeof(NULLC_MODULE_PACK_MAGIC)) != 0)
+		return false;
+
+	unsigned version = 0;
+	memcpy(&version, data + sizeof(NULLC_MODULE_PACK_MAGIC), sizeof(version));
+
+	return version == NULLC_BYTECODE_VERSION;
+}
+
 int main(int argc, char** argv)
 {
 	if(argc == 1)
@@ -79,14 +90,13 @@ int main(int argc, char** argv)
 	#define X64_LIB "nullclib_x64.ncm"
 #endif
 
-	FILE *modulePack = fopen(sizeof(void*) == sizeof(int) ? "nullclib.ncm" : X64_LIB, "rb");
+	const char *modulePackName = sizeof(void*) == sizeof(int) ? "nullclib.ncm" : X64_LIB;
+
+	FILE *modulePack = fopen(modulePackName, "rb");
 	if(!modulePack)
 	{
 		if(verbose)
-		{
-			printf("WARNING: Failed to open precompiled module file ");
-			printf(sizeof(void*) == sizeof(int) ? "nullclib.ncm\r\n" : X64_LIB"\r\n");
-		}
+			printf("WARNING: Failed to open precompiled module file %s\r\n", modulePackName);
 	}
 	else
 	{
@@ -97,7 +107,15 @@ int main(int argc, char** argv)
 		fread(fileContent, 1, fileSize, modulePack);
 		fclose(modulePack);
 
-		char *filePos = fileContent;
+		if(!IsModulePackCompatible(fileContent, fileSize))
+		{
+			if(verbose)
+				printf("WARNING: Precompiled module file %s was built for a different bytecode version\r\n", modulePackName);
+
+			fileSize = 0;
+		}
+
+		char *filePos = fileContent + NULLC_MODULE_PACK_HEADER_SIZE;
 		while((unsigned int)(filePos - fileContent) < fileSize)
 		{
 			char *moduleName = filePos;
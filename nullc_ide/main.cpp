@@ -468,6 +468,17 @@ unsigned IDEDebugBreakEx(void *context, unsigned instruction)
 
 #include <io.h>
 
+bool IsModulePackCompatible(const char *data, unsigned size)
+{
+	if(size < NULLC_MODULE_PACK_HEADER_SIZE || memcmp(data, NULLC_MODULE_PACK_MAGIC, sizeof(NULLC_MODULE_PACK_MAGIC)) != 0)
+		return false;
+
+	unsigned version = 0;
+	memcpy(&version, data + sizeof(NULLC_MODULE_PACK_MAGIC), sizeof(version));
+
+	return version == NULLC_BYTECODE_VERSION;
+}
+
 int APIENTRY WinMain(HINSTANCE	hInstance,
 					HINSTANCE	hPrevInstance,
 					LPTSTR		lpCmdLine,
@@ -526,7 +537,13 @@ int APIENTRY WinMain(HINSTANCE	hInstance,
 		fread(fileContent, 1, fileSize, modulePack);
 		fclose(modulePack);
 
-		char *filePos = fileContent;
+		if(!IsModulePackCompatible(fileContent, fileSize))
+		{
+			strcat(initErrorBuf, "WARNING: Precompiled module file was built for a different bytecode version\r\n");
+			fileSize = 0;
+		}
+
+		char *filePos = fileContent + NULLC_MODULE_PACK_HEADER_SIZE;
 		while((unsigned int)(filePos - fileContent) < fileSize)
 		{
 			char *moduleName = filePos;
@@ -54,6 +54,24 @@ bool SearchAndAddSourceFile(char*& buf, const char* name)
 	return false;
 }
 
+void WriteModulePackHeader(FILE *file)
+{
+	char header[NULLC_MODULE_PACK_HEADER_SIZE] = { 0 };
+
+	memcpy(header, NULLC_MODULE_PACK_MAGIC, sizeof(NULLC_MODULE_PACK_MAGIC));
+
+	unsigned version = NULLC_BYTECODE_VERSION;
+	memcpy(header + sizeof(NULLC_MODULE_PACK_MAGIC), &version, sizeof(version));
+
+	fwrite(header, 1, sizeof(header), file);
+}
+
+void WriteModule(FILE *file, const char *moduleName, const unsigned *bytecode)
+{
+	fwrite(moduleName, 1, strlen(moduleName) + 1, file);
+	fwrite(bytecode, 1, *bytecode, file);
+}
+
 int main(int argc, char** argv)
 {
 	nullcInit();
@@ -62,14 +80,16 @@ int main(int argc, char** argv)
 	if(argc == 1)
 	{
 		printf("usage: nullcl [-o output.ncm] file.nc [-m module.name] [file2.nc [-m module.name] ...]\n");
-		printf("usage: nullcl -c output.cpp file.nc\n");
-		printf("usage: nullcl -x output.exe file.nc\n");
+		printf("usage: nullcl [-vectorize] -c output.cpp file.nc\n");
+		printf("usage: nullcl [-vectorize] -x output.exe file.nc\n");
+		printf("usage: nullcl [-vectorize] -n output.so file.nc module.name\n");
 		return 1;
 	}
 
 	int argIndex = 1;
 	FILE *mergeFile = NULL;
 	bool verbose = false;
+	bool vectorize = false;
 
 	if(strcmp("-v", argv[argIndex]) == 0)
 	{
@@ -78,6 +98,21 @@ int main(int argc, char** argv)
 		verbose = true;
 	}
 
+	if(argIndex < argc && strcmp("-vectorize", argv[argIndex]) == 0)
+	{
+		argIndex++;
+
+		vectorize = true;
+
+		nullcSetEnableVectorFriendlyTranslation(true);
+	}
+
+	if(argIndex == argc)
+	{
+		printf("No input file specified\n");
+		return 1;
+	}
+
 	if(strcmp("-o", argv[argIndex]) == 0)
 	{
 		argIndex++;
@@ -94,9 +129,11 @@ int main(int argc, char** argv)
 			nullcTerminate();
 			return 1;
 		}
+		WriteModulePackHeader(mergeFile);
 		argIndex++;
-	}else if(strcmp("-c", argv[argIndex]) == 0 || strcmp("-x", argv[argIndex]) == 0){
-		bool link = strcmp("-x", argv[argIndex]) == 0;
+	}else if(strcmp("-c", argv[argIndex]) == 0 || strcmp("-x", argv[argIndex]) == 0 || strcmp("-n", argv[argIndex]) == 0){
+		bool native = strcmp("-n", argv[argIndex]) == 0;
+		bool link = strcmp("-x", argv[argIndex]) == 0 || native;
 		argIndex++;
 		if(argIndex == argc)
 		{
@@ -114,6 +151,21 @@ int main(int argc, char** argv)
 		}
 
 		const char *fileName = argv[argIndex++];
+
+		const char *moduleName = NULL;
+
+		if(native)
+		{
+			if(argIndex == argc)
+			{
+				printf("Module name not found\n");
+				nullcTerminate();
+				return 1;
+			}
+
+			moduleName = argv[argIndex++];
+		}
+
 		FILE *ncFile = fopen(fileName, "rb");
 		if(!ncFile)
 		{
@@ -137,7 +189,7 @@ int main(int argc, char** argv)
 			return 1;
 		}
 
-		if(!nullcTranslateToC(link ? "__temp.cpp" : outputName, "main", AddDependency))
+		if(native ? !nullcTranslateToNativeModule("__temp.cpp", moduleName, AddDependency) : !nullcTranslateToC(link ? "__temp.cpp" : outputName, "main", AddDependency))
 		{
 			printf("Compilation of %s failed with error:\n%s\n", fileName, nullcGetLastError());
 			delete[] fileContent;
@@ -150,7 +202,7 @@ int main(int argc, char** argv)
 			char cmdLine[4096];
 
 			char *pos = cmdLine;
-			strcpy(pos, "gcc -g -o ");
+			strcpy(pos, native ? "gcc -g -shared -fPIC -o " : "gcc -g -o ");
 			pos += strlen(pos);
 
 			strcpy(pos, outputName);
@@ -168,7 +220,7 @@ int main(int argc, char** argv)
 			strcpy(pos, " -I../NULLC/translation");
 			pos += strlen(pos);
 
-			strcpy(pos, " -O2");
+			strcpy(pos, vectorize ? " -O3" : " -O2");
 			pos += strlen(pos);
 
 			if(!SearchAndAddSourceFile(pos, "runtime.cpp"))
@@ -306,12 +358,11 @@ int main(int argc, char** argv)
 				delete[] bytecode;
 				break;
 			}
-			fwrite(moduleName, 1, strlen(moduleName) + 1, nmcFile);
-			fwrite(bytecode, 1, *bytecode, nmcFile);
+			WriteModulePackHeader(nmcFile);
+			WriteModule(nmcFile, moduleName, bytecode);
 			fclose(nmcFile);
 		}else{
-			fwrite(moduleName, 1, strlen(moduleName) + 1, mergeFile);
-			fwrite(bytecode, 1, *bytecode, mergeFile);
+			WriteModule(mergeFile, moduleName, bytecode);
 		}
 
 		delete[] bytecode;
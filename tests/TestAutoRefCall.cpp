@@ -268,3 +268,21 @@ Test2 t;\r\n\
 auto ref x = t;\r\n\
 return t.f(4, 2); ";
 TEST_RESULT("Order of 'auto ref' table setup on implicit import", testAutorefInitOrder, "2");
+
+const char	*testAutorefInlineLookup =
+"class Foo{ int foo(int x){ return x + 1; } }\r\n\
+class Bar{ int foo(int x){ return x * 10; } }\r\n\
+class Baz{}\r\n\
+int call(auto ref x, int y){ return x.foo(y); }\r\n\
+int callLocal(int y){ Bar b; auto ref x = b; return x.foo(y); }\r\n\
+int tryCall(auto ref x, int y){ auto f = x.foo; return f == nullptr ? -1 : f(y); }\r\n\
+Foo a; Bar b; Baz c;\r\n\
+return call(a, 1) + call(b, 2) + callLocal(3) + tryCall(a, 4) + tryCall(b, 5) + tryCall(c, 6) * 1000;";
+TEST_RESULT("Inline virtual function lookup on loaded and constructed 'auto ref' values", testAutorefInlineLookup, "-893");
+
+const char	*testAutorefInlineLookupMissing =
+"class Foo{ int foo(){ return 1; } }\r\n\
+int call(auto ref x){ return x.foo(); }\r\n\
+auto ref x;\r\n\
+return call(x);";
+TEST_RUNTIME_FAIL("Inline virtual function lookup falls back to the runtime for a missing implementation [failure handling]", testAutorefInlineLookupMissing, "ERROR: type 'void' doesn't implement method 'void::foo' of type 'int ref()'");
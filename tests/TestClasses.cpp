@@ -1419,3 +1419,27 @@ const char	*testClassConstantVisibility =
 Test t;\r\n\
 return t.s();";
 TEST_RESULT("Class constant visibility", testClassConstantVisibility, "3");
+
+const char	*testClassScalarReplacement =
+"class Pair{ int a; double b; long c; int ref p; }\r\n\
+int x = 7;\r\n\
+int f(int k)\r\n\
+{\r\n\
+	Pair s;\r\n\
+	s.a = k;\r\n\
+	if(k > 2)\r\n\
+	{\r\n\
+		s.b = 2.5;\r\n\
+		s.p = &x;\r\n\
+	}\r\n\
+	else\r\n\
+	{\r\n\
+		s.c = 3;\r\n\
+	}\r\n\
+	for(int i = 0; i < k; i++)\r\n\
+		s.c += i;\r\n\
+	Pair t = s;\r\n\
+	return int(s.a + s.b * 2 + s.c) + (s.p ? *s.p : 0) + t.a;\r\n\
+}\r\n\
+return f(1) * 100 + f(4);";
+TEST_RESULT("Class local split into members", testClassScalarReplacement, "526");
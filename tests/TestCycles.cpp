@@ -264,3 +264,40 @@ default:\r\n\
 }\r\n\
 return i;";
 TEST_RESULT("Switch test (fallthrough to default)", testSwitchFallthrough2, "2");
+
+const char	*testLoopUnrolling = 
+"int g()\r\n\
+{\r\n\
+	int[4] a;\r\n\
+	for(int i = 0; i < 4; i++)\r\n\
+		a[i] = i * 3;\r\n\
+	int s = 0;\r\n\
+	for(int i = 3; i >= 0; i--)\r\n\
+		s = s * 2 + a[i];\r\n\
+	return s;\r\n\
+}\r\n\
+int h(int[4] ref a)\r\n\
+{\r\n\
+	int s = 0;\r\n\
+	for(int i = 0; i != 4; i += 2)\r\n\
+		s += a[i];\r\n\
+	return s;\r\n\
+}\r\n\
+int[4] b = {1, 2, 3, 4};\r\n\
+return g() * 100 + h(&b);";
+TEST_RESULT("Loops with a constant trip count", testLoopUnrolling, "10204");
+
+const char	*testLoopUnrollingStructMembers = 
+"class Pair{ int a; int[] first; double b; auto ref second; }\r\n\
+int f()\r\n\
+{\r\n\
+	Pair[3] pairs;\r\n\
+	for(int i = 0; i < 3; i++)\r\n\
+	{\r\n\
+		pairs[i].first = new int[i + 1];\r\n\
+		pairs[i].second = new int(i * 10);\r\n\
+	}\r\n\
+	return pairs[2].first.size + int(pairs[1].second);\r\n\
+}\r\n\
+return f();";
+TEST_RESULT("Loops with a constant trip count storing into struct array members", testLoopUnrollingStructMembers, "13");
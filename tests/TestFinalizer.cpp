@@ -227,3 +227,50 @@ for(int i = 0; i < 10; i++) new int(7);\r\n\
 \r\n\
 return *global;";
 TEST_RESULT_SIMPLE("Finalizer object ressurection test 4 (large array)", testFinalizerRessurection4, "13");
+
+const char	*testFinalizerDeferred =
+"import std.gc;\r\n\
+\r\n\
+int finalized = 0, valid = 0;\r\n\
+\r\n\
+class Foo\r\n\
+{\r\n\
+	int ref value;\r\n\
+}\r\n\
+\r\n\
+void Foo:finalize()\r\n\
+{\r\n\
+	finalized++;\r\n\
+	if(*value == 5)\r\n\
+		valid++;\r\n\
+}\r\n\
+\r\n\
+void test()\r\n\
+{\r\n\
+	for(int i = 0; i < 10; i++)\r\n\
+	{\r\n\
+		Foo ref a = new Foo;\r\n\
+		a.value = new int(5);\r\n\
+	}\r\n\
+}\r\n\
+\r\n\
+GC.SetDeferredFinalization(true);\r\n\
+\r\n\
+test();\r\n\
+\r\n\
+GC.CollectMemory();\r\n\
+int pending = GC.PendingFinalizers();\r\n\
+\r\n\
+// queued objects and their members have to survive other collections\r\n\
+GC.CollectMemory();\r\n\
+for(int i = 0; i < 1000; i++) new int(7);\r\n\
+GC.CollectMemory();\r\n\
+\r\n\
+int before = finalized;\r\n\
+int first = GC.RunFinalizers(4);\r\n\
+int rest = GC.RunFinalizers(-1);\r\n\
+\r\n\
+GC.SetDeferredFinalization(false);\r\n\
+\r\n\
+return before * 10000 + pending * 1000 + first * 100 + rest * 10 + (valid == 10 && GC.PendingFinalizers() == 0);";
+TEST_RESULT_SIMPLE("Deferred finalization is drained by the host [skip_c]", testFinalizerDeferred, "10461");
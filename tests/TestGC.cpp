@@ -44,7 +44,7 @@ arr1[1].e = new A;\r\n\
 arr1[1].f = new A;\r\n\
 GC.CollectMemory();\r\n\
 return GC.UsedMemory() - start;";
-TEST_RESULT_SIMPLE("Garbage collection correctness.", testGarbageCollectionCorrectness, sizeof(void*) == 8 ? "544" : "272");
+TEST_RESULT_SIMPLE("Garbage collection correctness.", testGarbageCollectionCorrectness, sizeof(void*) == 8 ? "416" : "272");
 
 const char	*testGarbageCollectionCorrectness2 =
 "import std.gc;\r\n\
@@ -91,7 +91,7 @@ arr1[1].e = new A;\r\n\
 arr1[1].f = new A;})();\r\n\
 GC.CollectMemory();\r\n\
 return GC.UsedMemory() - start;";
-TEST_RESULT_SIMPLE("Garbage collection correctness 3.", testGarbageCollectionCorrectness3, sizeof(void*) == 8 ? "544" : "272");
+TEST_RESULT_SIMPLE("Garbage collection correctness 3.", testGarbageCollectionCorrectness3, sizeof(void*) == 8 ? "416" : "272");
 
 const char	*testStackFrameSizeX64 =
 "void test()\r\n\
@@ -523,7 +523,7 @@ auto foo(int x)\r\n\
 foo(5)() + k();\r\n\
 GC.CollectMemory();\r\n\
 return GC.UsedMemory() - start;";
-TEST_RESULT_SIMPLE("Unused upvalues GC test 2 [skip_c]", testUnusedUpvaluesGC2, sizeof(void*) == 8 ? "128" : "64");
+TEST_RESULT_SIMPLE("Unused upvalues GC test 2 [skip_c]", testUnusedUpvaluesGC2, sizeof(void*) == 8 ? "96" : "64");
 
 const char	*testDoubleMemoryRemovalGC2 =
 "import std.gc;\r\n\
@@ -706,3 +706,196 @@ assert(*a == 5);\r\n\
 assert(m == 6);\r\n\
 return 1;";
 TEST_RESULT_SIMPLE("GC execution when callstack is full of NULLC->C transitions", testGCWhenTransitions, "1");
+
+const char	*testGCInteriorPointerSizeClass =
+"import std.gc;\r\n\
+class A\r\n\
+{\r\n\
+	int a, b, c;\r\n\
+	A ref d, e, f;\r\n\
+}\r\n\
+int ref x;\r\n\
+int ref y;\r\n\
+(auto(){ A ref a = new A; a.c = 7; x = &a.c; int[] arr = new int[700]; arr[600] = 9; y = &arr[600]; new A; })();\r\n\
+GC.CollectMemory();\r\n\
+for(int i = 0; i < 100; i++)\r\n\
+{\r\n\
+	A ref t = new A;\r\n\
+	t.c = 1;\r\n\
+	int[] t2 = new int[700];\r\n\
+	t2[600] = 1;\r\n\
+}\r\n\
+return *x + *y;";
+TEST_RESULT("GC interior pointers into non-power-of-two size classes", testGCInteriorPointerSizeClass, "16");
+
+const char	*testGCSizeClassStats =
+"import std.gc;\r\n\
+int FindClass(int size)\r\n\
+{\r\n\
+	for(int i = 0; i < GC.SizeClassCount(); i++)\r\n\
+		if(GC.SizeClassSize(i) == size)\r\n\
+			return i;\r\n\
+	return -1;\r\n\
+}\r\n\
+int cls = FindClass(4096);\r\n\
+int before = GC.SizeClassUsedMemory(cls);\r\n\
+int[] arr = new int[1000];\r\n\
+int used = GC.SizeClassUsedMemory(cls) - before;\r\n\
+int total = 0;\r\n\
+for(int i = 0; i < GC.SizeClassCount(); i++)\r\n\
+{\r\n\
+	assert(GC.SizeClassUsedMemory(i) <= GC.SizeClassReservedMemory(i));\r\n\
+	total += GC.SizeClassUsedMemory(i);\r\n\
+}\r\n\
+assert(total <= GC.UsedMemory());\r\n\
+assert(GC.ReservedMemory() >= GC.UsedMemory());\r\n\
+double f = GC.HeapFragmentation();\r\n\
+assert(f >= 0.0 && f < 1.0);\r\n\
+return used;";
+TEST_RESULT("GC size class statistics", testGCSizeClassStats, "4096");
+
+const char	*testGCBumpAllocationChurn =
+"import std.gc;\r\n\
+class Node{ int value; Node ref next; int[4] pad; }\r\n\
+class Tracked{ int value; }\r\n\
+void Tracked:finalize(){ value = 1; }\r\n\
+Node ref list;\r\n\
+for(int i = 0; i < 200000; i++)\r\n\
+{\r\n\
+	Node ref n = new Node;\r\n\
+	assert(n.value == 0 && n.next == nullptr && n.pad[3] == 0);\r\n\
+	n.value = i;\r\n\
+	n.pad[3] = i;\r\n\
+	if(i % 100 == 0)\r\n\
+	{\r\n\
+		n.next = list;\r\n\
+		list = n;\r\n\
+	}\r\n\
+	if(i % 1000 == 0)\r\n\
+		new Tracked;\r\n\
+}\r\n\
+GC.CollectMemory();\r\n\
+int sum = 0;\r\n\
+for(Node ref curr = list; curr; curr = curr.next)\r\n\
+{\r\n\
+	assert(curr.value == curr.pad[3]);\r\n\
+	sum += curr.value / 100;\r\n\
+}\r\n\
+return sum;";
+TEST_RESULT("GC bump allocation with collections and finalizable objects", testGCBumpAllocationChurn, "1999000");
+
+const char	*testGCInteriorPointersAcrossPages =
+"import std.gc;\r\n\
+int ref[] refs = new int ref[4000];\r\n\
+for(int i = 0; i < 4000; i++)\r\n\
+{\r\n\
+	int[] arr = new int[200 + i % 50];\r\n\
+	arr[150] = i;\r\n\
+	refs[i] = &arr[150];\r\n\
+	new int[200];\r\n\
+}\r\n\
+GC.CollectMemory();\r\n\
+for(int i = 0; i < 4000; i++)\r\n\
+	new int[200];\r\n\
+int sum = 0;\r\n\
+for(int i = 0; i < 4000; i++)\r\n\
+	sum += *refs[i] == i;\r\n\
+return sum;";
+TEST_RESULT("GC interior pointers into objects spread over many pool pages", testGCInteriorPointersAcrossPages, "4000");
+
+const char	*testGCHeapProfiling =
+"import std.gc;\r\n\
+class Point{ int x, y; }\r\n\
+Point ref keep;\r\n\
+Point ref MakePoint(){ return new Point; }\r\n\
+bool Contains(char[] str, char[] pattern)\r\n\
+{\r\n\
+	for(int i = 0; i + pattern.size <= str.size; i++)\r\n\
+	{\r\n\
+		bool match = true;\r\n\
+		for(int k = 0; k < pattern.size - 1 && match; k++)\r\n\
+			match = str[i + k] == pattern[k];\r\n\
+		if(match)\r\n\
+			return true;\r\n\
+	}\r\n\
+	return false;\r\n\
+}\r\n\
+GC.SetHeapProfiling(true);\r\n\
+for(int i = 0; i < 1000; i++)\r\n\
+{\r\n\
+	Point ref p = MakePoint();\r\n\
+	if(i == 500)\r\n\
+		keep = p;\r\n\
+}\r\n\
+GC.CollectMemory();\r\n\
+char[] bySite = GC.HeapProfileBySite();\r\n\
+char[] byType = GC.HeapProfileByType();\r\n\
+GC.SetHeapProfiling(false);\r\n\
+assert(Contains(bySite, \"MakePoint()\"));\r\n\
+assert(Contains(bySite, \"16000       1000\"));\r\n\
+assert(Contains(byType, \"Point\"));\r\n\
+return keep != nullptr;";
+TEST_RESULT("GC heap profiling by allocation site and type [skip_c]", testGCHeapProfiling, "1");
+
+const char	*testGCFrameRootSlots =
+"import std.gc;\r\n\
+class Base extendable{ int x; }\r\n\
+class Derived : Base{ int[] data; }\r\n\
+class Pair{ int a; int[] first; double b; auto ref second; }\r\n\
+int Check()\r\n\
+{\r\n\
+	Pair[3] pairs;\r\n\
+	int ref[32] many;\r\n\
+	Base ref base = new Derived;\r\n\
+	auto[] anything = new int[4];\r\n\
+	int ref value = new int(3);\r\n\
+	int Capture(){ return *value; }\r\n\
+	auto f = Capture;\r\n\
+	for(int i = 0; i < 3; i++)\r\n\
+	{\r\n\
+		pairs[i].first = new int[2];\r\n\
+		pairs[i].first[1] = i;\r\n\
+		pairs[i].second = new int(i * 10);\r\n\
+	}\r\n\
+	for(int i = 0; i < 32; i++)\r\n\
+		many[i] = new int(i);\r\n\
+	Derived ref d = Derived ref(base);\r\n\
+	d.data = new int[2];\r\n\
+	d.data[0] = 7;\r\n\
+	d = nullptr;\r\n\
+	int[] anythingInt = anything;\r\n\
+	anythingInt[2] = 5;\r\n\
+	anythingInt = nullptr;\r\n\
+	GC.CollectMemory();\r\n\
+	for(int i = 0; i < 1000; i++)\r\n\
+		new int[2];\r\n\
+	int sum = 0;\r\n\
+	for(int i = 0; i < 3; i++)\r\n\
+		sum += pairs[i].first[1] + int(pairs[i].second);\r\n\
+	for(int i = 0; i < 32; i++)\r\n\
+		sum += *many[i];\r\n\
+	int[] anythingCheck = anything;\r\n\
+	return sum + Derived ref(base).data[0] + anythingCheck[2] + f();\r\n\
+}\r\n\
+return Check();";
+TEST_RESULT("GC roots in flattened local variables of a stack frame", testGCFrameRootSlots, "544");
+
+const char	*testGCCollectionPolicy =
+"import std.gc;\r\n\
+GC.SetCollectionPolicy(64 * 1024, 1.5, 0.5, 0);\r\n\
+GC.CollectMemory();\r\n\
+int idle = GC.CollectIfCheap() ? 1 : 0;\r\n\
+for(int i = 0; i < 100; i++)\r\n\
+	new int[100];\r\n\
+int before = GC.UsedMemory();\r\n\
+int collected = GC.CollectIfCheap() ? 1 : 0;\r\n\
+int after = GC.UsedMemory();\r\n\
+GC.SetCollectionPolicy(1024 * 1024, 2.0, 2.0 / 3.0, 0);\r\n\
+return idle * 100 + collected * 10 + (after < before);";
+TEST_RESULT("GC collection policy and collection hint [skip_c]", testGCCollectionPolicy, "11");
+
+const char	*testGCCollectionPolicyInvalid =
+"import std.gc;\r\n\
+GC.SetCollectionPolicy(64 * 1024, 0.5, 0.5, 0);\r\n\
+return 1;";
+TEST_RUNTIME_FAIL("GC collection policy with a shrinking threshold [failure handling]", testGCCollectionPolicyInvalid, "ERROR: collection threshold growth factor must be at least 1");
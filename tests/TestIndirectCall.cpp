@@ -125,3 +125,16 @@ int omg:call(int x){ return (*this)(x); }\r\n\
 auto ref x = duplicate(foo);\r\n\
 return x.call(5);";
 TEST_RESULT("Function type member function that calls itself", testFunctionTypeMemberSelfcall, "-5");
+
+const char	*testIndirectCallKnownTarget =
+"int foo(int x){ return -x; }\r\n\
+int bar(int y)\r\n\
+{\r\n\
+	int z = 3;\r\n\
+	int local(int x){ return x * z; }\r\n\
+	auto a = foo;\r\n\
+	auto b = local;\r\n\
+	return a(y) + b(y);\r\n\
+}\r\n\
+return bar(5);";
+TEST_RESULT("Indirect function call with a known target", testIndirectCallKnownTarget, "10");
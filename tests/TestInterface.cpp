@@ -3,10 +3,105 @@
 #include "TestBase.h"
 
 #include "../NULLC/nullc_debug.h"
+#include "../NULLC/nullc_internal.h"
 #include "../NULLC/Array.h"
 
+#include <stdlib.h>
+
+#if defined(__linux)
+#include <unistd.h>
+#endif
+
 bool	initialized;
 
+unsigned GetFunctionInlineCount()
+{
+	CompilerContext *context = nullcGetCompilerContext();
+
+	return context && context->vmModule ? context->vmModule->functionInlines : 0;
+}
+
+unsigned GetScalarReplacementCount()
+{
+	CompilerContext *context = nullcGetCompilerContext();
+
+	return context && context->vmModule ? context->vmModule->scalarReplacements : 0;
+}
+
+unsigned GetIndirectCallCount(const char *functionName)
+{
+	CompilerContext *context = nullcGetCompilerContext();
+
+	if(!context || !context->vmModule)
+		return ~0u;
+
+	unsigned count = 0;
+
+	for(VmFunction *function = context->vmModule->functions.head; function; function = function->next)
+	{
+		if(!function->function || function->function->name->name != InplaceStr(functionName))
+			continue;
+
+		for(VmBlock *block = function->firstBlock; block; block = block->nextSibling)
+		{
+			for(VmInstruction *inst = block->firstInstruction; inst; inst = inst->nextSibling)
+			{
+				if(inst->cmd == VM_INST_CALL && inst->arguments[0]->type.type == VM_TYPE_FUNCTION_REF)
+					count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+char translationBuffer[64 * 1024];
+unsigned translationSize = 0;
+
+void* OpenTranslationStream(const char *name)
+{
+	(void)name;
+
+	return translationBuffer;
+}
+
+void WriteTranslationStream(void *stream, const char *data, unsigned size)
+{
+	(void)stream;
+
+	if(translationSize + size >= sizeof(translationBuffer))
+		size = sizeof(translationBuffer) - translationSize - 1;
+
+	memcpy(translationBuffer + translationSize, data, size);
+	translationSize += size;
+	translationBuffer[translationSize] = 0;
+}
+
+void CloseTranslationStream(void *stream)
+{
+	(void)stream;
+}
+
+const char* TranslateToBuffer(const char *code)
+{
+	translationSize = 0;
+	translationBuffer[0] = 0;
+
+	// Output functions are picked up by the compiler context
+	nullcSetEnableLogFiles(false, OpenTranslationStream, WriteTranslationStream, CloseTranslationStream);
+
+	nullres result = nullcCompile(code) && nullcTranslateToC("1test.cpp", "main", NULL);
+
+	nullcSetEnableLogFiles(Tests::enableLogFiles, Tests::openStreamFunc, Tests::writeStreamFunc, Tests::closeStreamFunc);
+
+	return result ? translationBuffer : "";
+}
+
+void RemoveTranslationDependency(const char *fileName)
+{
+	remove(fileName);
+}
+
 #define TEST_COMPARE(test, result)\
 	testsCount[TEST_TYPE_EXTRA]++;\
 	if((test) != result)\
@@ -592,6 +687,416 @@ void RunInterfaceTests()
 	TEST_COMPARE(nullcRunFunction("foo"), 1);
 	TEST_COMPARE(nullcGetResultInt(), 6);
 
+	char *stageBytecode = NULL;
+
+	nullcSetCompileStage(NULLC_STAGE_ANALYZE);
+	TEST_COMPARE(nullcCompile("int foo(int x){ return x + 1; } return foo(4);"), 1);
+	TEST_COMPARE(nullcGetBytecode(&stageBytecode), 0);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: module was not compiled to RegVm");
+	TEST_COMPARE(nullcCompile("return foo(4);"), 0);
+
+	nullcSetCompileStage(NULLC_STAGE_VM);
+	TEST_COMPARE(nullcCompile("int foo(int x){ return x + 1; } return foo(4);"), 1);
+	TEST_COMPARE(nullcGetBytecode(&stageBytecode), 0);
+
+	nullcSetCompileStage(NULLC_STAGE_REG_VM);
+	TEST_COMPARE(nullcBuild("int foo(int x){ return x + 1; } return foo(4);"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	TEST_COMPARE(nullcGetResultInt(), 5);
+
+	// Restore the default stage for the following tests
+#ifdef NULLC_LLVM_SUPPORT
+	nullcSetCompileStage(NULLC_STAGE_LLVM);
+#else
+	nullcSetCompileStage(NULLC_STAGE_REG_VM);
+#endif
+
+	// Calls through function references with a known target are made direct
+	TEST_COMPARE(nullcCompile("int foo(int x){ return -x; } int bar(int y){ int z = 3; int local(int x){ return x * z; } auto a = foo; auto b = local; return a(y) + b(y); } return bar(5);"), 1);
+	TEST_COMPARE(GetIndirectCallCount("bar"), 0);
+	TEST_COMPARE(nullcCompile("int foo(int x){ return -x; } int bar(int ref(int) f, int y){ return f(y); } return bar(foo, 5);"), 1);
+	TEST_COMPARE(GetIndirectCallCount("bar"), 1);
+
+	// Inline virtual function lookup leaves type ids outside of the table to the runtime function
+	for(unsigned t = 0; t < 2; t++)
+	{
+		if(!Tests::testExecutor[t])
+			continue;
+
+		nullcSetExecutor(testTarget[t]);
+
+		TEST_COMPARE(nullcBuild("class Foo{ int foo(){ return 7; } } Foo f; auto ref x = &f; int call(){ return x.foo(); } int callPtr(){ auto z = x.foo; return z == nullptr ? 1 : 2; } return 1;"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRunFunction("call"), 1);
+		TEST_COMPARE(nullcGetResultInt(), 7);
+
+		NULLCRef invalidRef = *(NULLCRef*)nullcGetGlobal("x");
+		invalidRef.typeID = 1 << 20;
+		TEST_COMPARE(nullcSetGlobal("x", &invalidRef), 1);
+
+		TEST_COMPARE(nullcRunFunction("call"), 0);
+		TEST_COMPARE(strstr(nullcGetLastError(), "ERROR: type index is out of bounds of redirection table") != NULL, true);
+		TEST_COMPARE(nullcRunFunction("callPtr"), 0);
+		TEST_COMPARE(strstr(nullcGetLastError(), "ERROR: type index is out of bounds of redirection table") != NULL, true);
+
+		invalidRef.typeID = 0x80000001u;
+		TEST_COMPARE(nullcSetGlobal("x", &invalidRef), 1);
+
+		TEST_COMPARE(nullcRunFunction("call"), 0);
+		TEST_COMPARE(strstr(nullcGetLastError(), "ERROR: type index is out of bounds of redirection table") != NULL, true);
+		TEST_COMPARE(nullcRunFunction("callPtr"), 0);
+		TEST_COMPARE(strstr(nullcGetLastError(), "ERROR: type index is out of bounds of redirection table") != NULL, true);
+	}
+
+	// Struct local split into members keeps zero padding bytes when it is copied
+	for(unsigned t = 0; t < 2; t++)
+	{
+		if(!Tests::testExecutor[t])
+			continue;
+
+		nullcSetExecutor(testTarget[t]);
+
+		const char *paddingCode = "class Pad{ int a; double b; } Pad g; int dirty(int k){ long[8] junk; for(int i = 0; i < k; i++) junk[i] = -1; return int(junk[k - 1]); } Pad make(int k){ Pad s; s.a = k; s.b = double(k) / 2; return s; } int run(){ dirty(8); g = make(3); return g.a; } return 1;";
+
+		TEST_COMPARE(nullcCompile(paddingCode), 1);
+		TEST_COMPARE(GetScalarReplacementCount(), 1);
+		TEST_COMPARE(nullcBuild(paddingCode), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRunFunction("run"), 1);
+		TEST_COMPARE(nullcGetResultInt(), 3);
+
+		struct Pad{ int a; double b; } expected;
+		memset(&expected, 0, sizeof(expected));
+		expected.a = 3;
+		expected.b = 1.5;
+
+		TEST_COMPARE(sizeof(expected), 16);
+		TEST_COMPARE(memcmp(nullcGetGlobal("g"), &expected, sizeof(expected)), 0);
+	}
+
+	nullcSetExecutor(NULLC_REG_VM);
+
+	nullcSetOptimizationLevel(3);
+
+	for(unsigned t = 0; t < 2; t++)
+	{
+		if(!Tests::testExecutor[t])
+			continue;
+
+		nullcSetExecutor(testTarget[t]);
+
+		const char *localCode = "int square(int x){ return x * x; } int sum(int a){ return square(a) + square(a + 1); } return sum(3);";
+
+		TEST_COMPARE(nullcCompile(localCode), 1);
+		TEST_COMPARE(GetFunctionInlineCount(), 2);
+		TEST_COMPARE(nullcBuild(localCode), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 25);
+
+		// Callee above the size limit is kept as a call
+		TEST_COMPARE(nullcCompile("int big(int x){ int s = 0; for(int i = 0; i < x; i++){ s += i * x; s ^= i; s += x / (i + 1); s -= i % 3; s += i * i; } return s; } int run(int a){ return big(a); } return run(10);"), 1);
+		TEST_COMPARE(GetFunctionInlineCount(), 0);
+
+		// Generic functions from an imported module are instantiated locally and can be inlined
+		TEST_COMPARE(nullcLoadModuleBySource("test.inline", "auto twice(generic x){ return x + x; }"), true);
+
+		const char *genericCode = "import test.inline; int run(int a){ return twice(a) + 1; } return run(4) + int(twice(1.5));";
+
+		TEST_COMPARE(nullcCompile(genericCode), 1);
+		TEST_COMPARE(GetFunctionInlineCount(), 1);
+		TEST_COMPARE(nullcBuild(genericCode), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 12);
+		nullcRemoveModule("test/inline.nc");
+
+		// Function that was inlined in its module can't be overridden later, other functions can
+		TEST_COMPARE(nullcLoadModuleBySource("test.inlined", "int inc(int x){ return x + 1; } int useInc(int x){ return inc(x) * 2; }"), true);
+
+		TEST_COMPARE(nullcBuild("import std.dynamic; import test.inlined; int dec(int x){ return x - 1; } override(inc, dec); return useInc(3);"), 1);
+		TEST_COMPARE(nullcRun(), 0);
+		TEST_COMPARE(strstr(nullcGetLastError(), "ERROR: function was inlined and can't be redirected") != NULL, true);
+
+		TEST_COMPARE(nullcBuild("import std.dynamic; import test.inlined; int twiceDec(int x){ return (x - 1) * 2; } override(useInc, twiceDec); return useInc(3);"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 4);
+		nullcRemoveModule("test/inlined.nc");
+	}
+
+	nullcSetOptimizationLevel(2);
+	nullcSetExecutor(NULLC_REG_VM);
+
+	TEST_COMPARE(nullcBindNativeModule("test.native", "missing_native_module.so"), false);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: failed to load native module library 'missing_native_module.so'");
+
+#if defined(__linux)
+	// Native module library is built from the C++ translation like the translation tests
+	if(Tests::doTranslation)
+	{
+		const char *nativeCode = "int counter; int bump(){ return ++counter; } int square(int x){ return x * x; } double half(double x){ return x / 2; }";
+
+		// Translation and library are placed in a temporary directory
+		char directory[] = "/tmp/nullc_native_XXXXXX";
+		TEST_COMPARE(mkdtemp(directory) != NULL, true);
+
+		char sourcePath[256];
+		NULLC::SafeSprintf(sourcePath, 256, "%s/native_test.cpp", directory);
+
+		char libraryPath[256];
+		NULLC::SafeSprintf(libraryPath, 256, "%s/native_test.so", directory);
+
+		char importPath[256];
+		NULLC::SafeSprintf(importPath, 256, "%s/native_import.cpp", directory);
+
+		char command[1024];
+		NULLC::SafeSprintf(command, 1024, "gcc -shared -fPIC -o %s %s -Itranslation -I../NULLC/translation ../NULLC/translation/runtime.cpp -lstdc++ -lm", libraryPath, sourcePath);
+
+		TEST_COMPARE(nullcCompile(nativeCode), 1);
+		TEST_COMPARE(nullcTranslateToNativeModule(sourcePath, "test.native", RemoveTranslationDependency), 1);
+
+		// Functions that use module globals are not exported
+		char translation[65536] = { 0 };
+
+		if(FILE *file = fopen(sourcePath, "rb"))
+		{
+			translation[fread(translation, 1, sizeof(translation) - 1, file)] = 0;
+
+			fclose(file);
+		}
+
+		TEST_COMPARE(strstr(translation, "\"square\", 0)") != NULL, true);
+		TEST_COMPARE(strstr(translation, "\"half\", 0)") != NULL, true);
+		TEST_COMPARE(strstr(translation, "\"bump\", 0)") != NULL, false);
+
+		TEST_COMPARE(system(command), 0);
+
+		TEST_COMPARE(nullcLoadModuleBySource("test.native", nativeCode), true);
+		TEST_COMPARE(nullcBindNativeModule("test.native", libraryPath), true);
+
+		TEST_COMPARE(nullcBuild("import test.native; bump(); bump(); return counter * 100 + square(7) + int(half(5));"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 251);
+
+		nullcRemoveModule("test/native.nc");
+
+		// Functions that call into other modules are not exported, those would use a private copy of the module state
+		TEST_COMPARE(nullcLoadModuleBySource("test.nativedep", "int state; int next(){ return ++state; }"), true);
+		TEST_COMPARE(nullcCompile("import test.nativedep; int step(){ return next(); } int twice(int x){ return x * 2; }"), 1);
+		TEST_COMPARE(nullcTranslateToNativeModule(importPath, "test.nativeimport", RemoveTranslationDependency), 1);
+
+		memset(translation, 0, sizeof(translation));
+
+		if(FILE *file = fopen(importPath, "rb"))
+		{
+			translation[fread(translation, 1, sizeof(translation) - 1, file)] = 0;
+
+			fclose(file);
+		}
+
+		TEST_COMPARE(strstr(translation, "\"twice\", 0)") != NULL, true);
+		TEST_COMPARE(strstr(translation, "\"step\", 0)") != NULL, false);
+
+		nullcRemoveModule("test/nativedep.nc");
+
+		remove(sourcePath);
+		remove(libraryPath);
+		remove(importPath);
+		rmdir(directory);
+	}
+#endif
+
+	nullcSetEnableVectorFriendlyTranslation(true);
+	TEST_COMPARE(nullcCompile("int sum(int[] arr){ int s = 0; for(int i = 0; i < arr.size; i++) s += arr[i]; return s; } return sum({1, 2, 3});"), 1);
+	TEST_COMPARE(nullcTranslateToC("1test.cpp", "main", NULL), 1);
+
+	TEST_COMPARE(strstr(TranslateToBuffer("int sum(int[] arr){ int s = 0; for(int i = 0; i < arr.size; i++) s += arr[i]; return s; } return sum({1, 2, 3});"), "__nullcVector") != NULL, true);
+	TEST_COMPARE(strstr(TranslateToBuffer("void copy(int[] a, int[] b){ for(int i = 0; i < a.size; i++) a[i] = b[i]; } int[] x = {1, 2, 3}; copy(x, x); return x[2];"), "__nullcVector") != NULL, true);
+
+	// Loop array is reachable through a reference
+	TEST_COMPARE(strstr(TranslateToBuffer("int[] y = {4, 5}; int sum(int[] arr, int[] ref r){ int s = 0; r = &arr; for(int i = 0; i < arr.size; i++){ *r = y; s += arr[i]; } return s; } return 1;"), "__nullcVector") != NULL, false);
+	TEST_COMPARE(strstr(TranslateToBuffer("int[] ref alias; int sum(int[] arr){ int s = 0; alias = &arr; for(int i = 0; i < arr.size; i++) s += arr[i]; return s; } return 1;"), "__nullcVector") != NULL, false);
+
+	// Calls and indirect stores
+	TEST_COMPARE(strstr(TranslateToBuffer("int f(int x){ return x; } int sum(int[] arr){ int s = 0; for(int i = 0; i < arr.size; i++) s += f(arr[i]); return s; } return 1;"), "__nullcVector") != NULL, false);
+	TEST_COMPARE(strstr(TranslateToBuffer("void sum(int[] arr, int ref s){ for(int i = 0; i < arr.size; i++) *s += arr[i]; } return 1;"), "__nullcVector") != NULL, false);
+	nullcSetEnableVectorFriendlyTranslation(false);
+
+	nullcSetExecutor(NULLC_REG_VM);
+
+	const char *imageCode = "class Node{ int value; Node ref next; } Node ref list; int[] arr = new int[16]; char[] str = \"image\"; int count = 0;\r\n\
+for(int i = 0; i < 4; i++){ Node ref n = new Node; n.value = i + 1; n.next = list; list = n; }\r\n\
+for(int i = 0; i < arr.size; i++) arr[i] = i * 2; int ref last = &arr[15];\r\n\
+int check(){ int s = 0; for(Node ref n = list; n; n = n.next) s += n.value; for(int i in arr) s += i; count++; return s * 1000 + *last * 10 + str.size + count; }\r\n\
+return 1;";
+
+	char *image = NULL;
+	TEST_COMPARE(nullcBuild(imageCode), 1);
+	TEST_COMPARE(nullcSaveProgramImage(&image), 0);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: global code has to be executed before the program image is saved");
+	TEST_COMPARE(nullcRun(), 1);
+	unsigned imageSize = nullcSaveProgramImage(&image);
+	TEST_COMPARE(imageSize != 0, true);
+
+	TEST_COMPARE(nullcBuild("return 2;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+
+	TEST_COMPARE(nullcLoadProgramImage(image, 8), false);
+	TEST_COMPARE(nullcLoadProgramImage(image, imageSize), true);
+	TEST_COMPARE(nullcRunFunction("check"), 1);
+	TEST_COMPARE(nullcGetResultInt(), 250307);
+	TEST_COMPARE(nullcRunFunction("check"), 1);
+	TEST_COMPARE(nullcGetResultInt(), 250308);
+
+	// Image is validated before global variables are replaced
+	unsigned lastFixupOffset = 0xffffffffu;
+	memcpy(image + imageSize - sizeof(unsigned), &lastFixupOffset, sizeof(unsigned));
+	TEST_COMPARE(nullcLoadProgramImage(image, imageSize), false);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: program image is corrupted");
+	delete[] image;
+
+	// Pointers to memory that is not owned by the program can't be saved
+	int hostValue = 5;
+	TEST_COMPARE(nullcBuild("int ref external; return 1;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	*(int**)nullcGetGlobal("external") = &hostValue;
+	TEST_COMPARE(nullcSaveProgramImage(&image), 0);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: program image can't be saved with pointers to memory that is not owned by the program");
+
+	// Finalizable objects are registered again by the allocation
+	TEST_COMPARE(nullcBuild("int z = 0; class Foo{ int a; } void Foo:finalize(){ z = a; } Foo ref x = new Foo; x.a = 7; void drop(){ x = nullptr; } return 1;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	imageSize = nullcSaveProgramImage(&image);
+	TEST_COMPARE(imageSize != 0, true);
+	TEST_COMPARE(nullcBuild("return 2;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	TEST_COMPARE(nullcLoadProgramImage(image, imageSize), true);
+	TEST_COMPARE(nullcRunFunction("drop"), 1);
+	TEST_COMPARE(nullcCollectMemoryIfCheap(), 1);
+	TEST_COMPARE(*(int*)nullcGetGlobal("z"), 7);
+	delete[] image;
+
+	// Image can only be loaded with the module binaries it was saved with
+	TEST_COMPARE(nullcLoadModuleBySource("test.imagemod", "int value(){ return 3; }"), true);
+	TEST_COMPARE(nullcBuild("import test.imagemod; int get(){ return value(); } return 1;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	imageSize = nullcSaveProgramImage(&image);
+	TEST_COMPARE(imageSize != 0, true);
+	nullcRemoveModule("test/imagemod.nc");
+	TEST_COMPARE(nullcLoadModuleBySource("test.imagemod", "int value(){ return 4; }"), true);
+	TEST_COMPARE(nullcLoadProgramImage(image, imageSize), false);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: program image module binary doesn't match the loaded module");
+	nullcRemoveModule("test/imagemod.nc");
+	TEST_COMPARE(nullcLoadModuleBySource("test.imagemod", "int value(){ return 3; }"), true);
+	TEST_COMPARE(nullcLoadProgramImage(image, imageSize), true);
+	TEST_COMPARE(nullcRunFunction("get"), 1);
+	TEST_COMPARE(nullcGetResultInt(), 3);
+	nullcRemoveModule("test/imagemod.nc");
+	delete[] image;
+
+	char *moduleBinary = NULL;
+	TEST_COMPARE(nullcCompile("int sum(int[] arr){ int s = 0; for(i in arr) s += i; return s; } int count = 4;"), 1);
+	TEST_COMPARE(nullcGetBytecode(&moduleBinary) != 0, true);
+
+	// Binaries from a different bytecode version are rejected
+	((unsigned*)moduleBinary)[1]++;
+	TEST_COMPARE(nullcLoadModuleByBinary("test.relocated", moduleBinary), false);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: module binary version mismatch");
+	TEST_COMPARE(nullcLinkCode(moduleBinary), false);
+	TEST_COMPARE(strstr(nullcGetLastError(), "doesn't match the expected version") != NULL, true);
+	((unsigned*)moduleBinary)[1]--;
+
+	// Module code is adjusted using its relocation table when it is linked
+	TEST_COMPARE(nullcLoadModuleByBinary("test.relocated", moduleBinary), true);
+	TEST_COMPARE(nullcBuild("import test.relocated; return sum({1, 2, 3}) + count;"), 1);
+	TEST_COMPARE(nullcRun(), 1);
+	TEST_COMPARE(nullcGetResultInt(), 10);
+	nullcRemoveModule("test/relocated.nc");
+	delete[] moduleBinary;
+
+	for(unsigned t = 0; t < 2; t++)
+	{
+		if(!Tests::testExecutor[t])
+			continue;
+
+		nullcSetExecutor(testTarget[t]);
+
+		char *relinkBytecode = NULL;
+
+		TEST_COMPARE(nullcLoadModuleBySource("test.relink", "int counter = 0; int next(){ return ++counter; } next();"), true);
+		TEST_COMPARE(nullcBuild("import test.relink; next(); return next();"), 1);
+		TEST_COMPARE(nullcRelinkCode("return 1;", "test/missing.nc"), false);
+		TEST_COMPARES(nullcGetLastError(), "Link Error: module 'test/missing.nc' is not linked");
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 3);
+
+		// Module global state is kept when only the main module changes
+		TEST_COMPARE(nullcCompile("import test.relink; int base = 10; return base + next();"), 1);
+		nullcGetBytecode(&relinkBytecode);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, NULL), 1);
+		delete[] relinkBytecode;
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 14);
+		TEST_COMPARE(nullcRunFunction("next"), 1);
+		TEST_COMPARE(nullcGetResultInt(), 5);
+
+		// Changed module is linked again together with the main module
+		nullcRemoveModule("test/relink.nc");
+		TEST_COMPARE(nullcCompile("int counter = 100; int next(){ return counter += 2; }"), 1);
+		nullcGetBytecode(&relinkBytecode);
+		TEST_COMPARE(nullcLoadModuleByBinary("test.relink", relinkBytecode), true);
+		delete[] relinkBytecode;
+		TEST_COMPARE(nullcCompile("import test.relink; return next();"), 1);
+		nullcGetBytecode(&relinkBytecode);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, "test/relink.nc"), 1);
+		delete[] relinkBytecode;
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 102);
+
+		// Full run resets everything
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 102);
+
+		// Previous program is restored when the new code fails to link
+		TEST_COMPARE(nullcLoadModuleBySource("test.relinkextra", "int extra(){ return 1000; }"), true);
+		TEST_COMPARE(nullcCompile("import test.relink; import test.relinkextra; return next() + extra();"), 1);
+		nullcGetBytecode(&relinkBytecode);
+		nullcRemoveModule("test/relinkextra.nc");
+		TEST_COMPARE(nullcBuild("import test.relink; return next();"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, "test/relink.nc"), false);
+		delete[] relinkBytecode;
+		TEST_COMPARE(nullcRunFunction("next"), 1);
+		TEST_COMPARE(nullcGetResultInt(), 104);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 102);
+		nullcRemoveModule("test/relink.nc");
+
+		// Kept global data can't reference types or functions of the unlinked code
+		TEST_COMPARE(nullcLoadModuleBySource("test.relinkstore", "auto ref stored; int ref() callback; void store(auto ref x){ stored = x; } void watch(int ref() f){ callback = f; }"), true);
+		TEST_COMPARE(nullcCompile("import test.relinkstore; return 2;"), 1);
+		nullcGetBytecode(&relinkBytecode);
+
+		TEST_COMPARE(nullcBuild("import test.relinkstore; class Foo{ int a; } store(new Foo); return 1;"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, NULL), false);
+		TEST_COMPARES(nullcGetLastError(), "ERROR: global data of the kept modules references types or functions of the unlinked modules");
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 1);
+
+		TEST_COMPARE(nullcBuild("import test.relinkstore; int local(){ return 5; } watch(local); return 1;"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, NULL), false);
+
+		TEST_COMPARE(nullcBuild("import test.relinkstore; store(new int(4)); return 1;"), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcRelinkCode(relinkBytecode, NULL), 1);
+		TEST_COMPARE(nullcRun(), 1);
+		TEST_COMPARE(nullcGetResultInt(), 2);
+		delete[] relinkBytecode;
+		nullcRemoveModule("test/relinkstore.nc");
+	}
+
+	nullcSetExecutor(NULLC_REG_VM);
+
 	nullcTerminate();
 	TEST_COMPARES(nullcGetLastError(), "");
 
@@ -661,6 +1166,8 @@ void RunInterfaceTests()
 
 	TEST_COMPARE(nullcBindModuleFunctionWrapper("std.test", NULL, NULL, "test", 0), false);
 	TEST_COMPARES(nullcGetLastError(), "ERROR: NULLC is not initialized");
+	TEST_COMPARE(nullcBindNativeModule("std.test", "test.so"), false);
+	TEST_COMPARES(nullcGetLastError(), "ERROR: NULLC is not initialized");
 	TEST_COMPARE(nullcLoadModuleBySource("std.test", "return 1;"), false);
 	TEST_COMPARES(nullcGetLastError(), "ERROR: NULLC is not initialized");
 	TEST_COMPARE(nullcLoadModuleByBinary("std.test", NULL), false);
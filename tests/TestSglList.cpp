@@ -223,3 +223,76 @@ x.push_back(1);\r\n\
 \r\n\
 return (2 in x) && !(10 in x);";
 TEST_RESULT("sgl.list test (in)", testSglList8, "1");
+
+const char *testSglList9 =
+"import std.list;\r\n\
+\r\n\
+list<int> x;\r\n\
+x.push_back(1);\r\n\
+x.push_back(2);\r\n\
+x.pop_back();\r\n\
+int sum = 0;\r\n\
+for(i in x)\r\n\
+	sum += i;\r\n\
+assert(sum == 1);\r\n\
+x.pop_front();\r\n\
+assert(x.empty());\r\n\
+\r\n\
+for(int k = 0; k < 1000; k++)\r\n\
+{\r\n\
+	x.push_back(k);\r\n\
+	x.push_front(-k);\r\n\
+	if(k % 3 == 0)\r\n\
+	{\r\n\
+		x.pop_front();\r\n\
+		x.pop_back();\r\n\
+	}\r\n\
+}\r\n\
+int count = 0;\r\n\
+sum = 0;\r\n\
+for(i in x)\r\n\
+{\r\n\
+	count++;\r\n\
+	sum += i;\r\n\
+}\r\n\
+assert(count == 1332);\r\n\
+\r\n\
+x.insert(x.end(), 5000);\r\n\
+assert(*x.back() == 5000);\r\n\
+x.erase(x.find(5000));\r\n\
+x.erase(x.begin());\r\n\
+x.push_back(7);\r\n\
+assert(*x.back() == 7);\r\n\
+\r\n\
+count = 0;\r\n\
+for(i in x)\r\n\
+	count++;\r\n\
+return count;";
+TEST_RESULT("sgl.list test (node reuse after pop and erase)", testSglList9, "1332");
+
+const char *testSglList10 =
+"import std.list;\r\n\
+\r\n\
+list<int> x;\r\n\
+for(int k = 0; k < 100; k++)\r\n\
+	x.push_back(k);\r\n\
+\r\n\
+for(auto it = x.begin(); it; it = it.next)\r\n\
+{\r\n\
+	if(it.elem % 2 == 0)\r\n\
+		x.erase(it);\r\n\
+}\r\n\
+int count = 0;\r\n\
+for(i in x)\r\n\
+	count++;\r\n\
+assert(count == 50);\r\n\
+\r\n\
+auto head = x.begin();\r\n\
+x.pop_front();\r\n\
+x.push_back(200);\r\n\
+x.push_front(300);\r\n\
+\r\n\
+while(!x.empty())\r\n\
+	x.pop_back();\r\n\
+return head.elem;";
+TEST_RESULT("sgl.list test (erase during iteration, popped nodes are not reused)", testSglList10, "1");
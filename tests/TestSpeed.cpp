@@ -21,6 +21,9 @@
 
 #include "../NULLC/includes/pugi.h"
 
+#include "../NULLC/Lexer.h"
+#include "../NULLC/Allocator.h"
+
 double speedTestTimeThreshold = 1000;	// how long, in ms, to run a speed test
 
 void TestDrawRect(int, int, int, int, int)
@@ -119,6 +122,40 @@ void	SpeedTestFile(const char* file)
 	delete[] blob;
 }
 
+void	SpeedTestLexer(const char* name, const char* text)
+{
+	// Lexer throughput is measured on a multi-megabyte source made from copies of the text
+	unsigned textLength = unsigned(strlen(text));
+	unsigned copies = 8 * 1024 * 1024 / textLength + 1;
+
+	char *source = new char[textLength * copies + 1];
+	for(unsigned i = 0; i < copies; i++)
+		memcpy(source + i * textLength, text, textLength);
+	source[textLength * copies] = 0;
+
+	unsigned int runs = 0;
+	unsigned int lexemes = 0;
+	double lexTime = 0.0;
+	while(lexTime < speedTestTimeThreshold)
+	{
+		ChunkedStackPool<65532> pool;
+		GrowingAllocatorRef<ChunkedStackPool<65532>, 16384> allocator(pool);
+
+		Lexer lexer(&allocator);
+
+		double time = myGetPreciseTime();
+		lexer.Lexify(source);
+		lexTime += myGetPreciseTime() - time;
+
+		lexemes = lexer.GetStreamSize();
+		runs++;
+	}
+	printf("Lexer speed test (%s) managed to run %d times in %f ms\n", name, runs, lexTime);
+	printf("Lexemes: %d Average time: %f Speed: %.3f Mb/sec\n\n", lexemes, lexTime / double(runs), textLength * copies * (1000.0 / (lexTime / double(runs))) / 1024.0 / 1024.0);
+
+	delete[] source;
+}
+
 void RunSpeedTests()
 {
 	#ifdef SPEED_TEST
@@ -297,6 +334,56 @@ return 1;";
 		printf("%s finished in %f\r\n", testTarget[t] == NULLC_X86 ? "X86" : (testTarget[t] == NULLC_LLVM ? "LLVM" : "REGVM"), myGetPreciseTime() - tStart);
 	}
 
+const char	*testListChurn =
+"import std.io;\r\n\
+import std.gc;\r\n\
+import std.list;\r\n\
+import std.event;\r\n\
+\r\n\
+list<int> queue;\r\n\
+int sum = 0;\r\n\
+double markTimeBegin = GC.MarkTime();\r\n\
+for(int i = 0; i < 1 << 21; i++)\r\n\
+{\r\n\
+	queue.push_back(i);\r\n\
+	if(i % 64 == 63)\r\n\
+	{\r\n\
+		for(int k = 0; k < 64; k++)\r\n\
+		{\r\n\
+			sum += *queue.front();\r\n\
+			queue.pop_front();\r\n\
+		}\r\n\
+	}\r\n\
+}\r\n\
+\r\n\
+event<void ref()> e;\r\n\
+int calls = 0;\r\n\
+void a(){ calls++; }\r\n\
+void b(){ calls++; }\r\n\
+for(int i = 0; i < 1 << 18; i++)\r\n\
+{\r\n\
+	e += a;\r\n\
+	e += b;\r\n\
+	e();\r\n\
+	e -= a;\r\n\
+	e -= b;\r\n\
+}\r\n\
+io.out << \"Marking time: (\" << GC.MarkTime() - markTimeBegin << \"sec)\" << io.endl;\r\n\
+return queue.empty() && calls == 1 << 19;";
+
+	printf("List push/pop churn\r\n");
+	for(int t = 0; t < TEST_TARGET_COUNT; t++)
+	{
+		if(!Tests::testExecutor[t])
+			continue;
+
+		testsCount[t]++;
+		double tStart = myGetPreciseTime();
+		if(Tests::RunCodeSimple(testListChurn, testTarget[t], "1", "List Churn Speed Test", false, ""))
+			testsPassed[t]++;
+		printf("%s finished in %f\r\n", testTarget[t] == NULLC_X86 ? "X86" : (testTarget[t] == NULLC_LLVM ? "LLVM" : "REGVM"), myGetPreciseTime() - tStart);
+	}
+
 	const char	*testCompileSpeed =
 "import img.canvas;\r\n\
 import std.io;\r\n\
@@ -774,6 +861,7 @@ double lastTime = clock();\r\n\
 return 0;";
 
 	SpeedTestText("raytrace.nc inlined", testCompileSpeed3);
+	SpeedTestLexer("raytrace.nc inlined", testCompileSpeed3);
 
 	for(int t = 0; t < TEST_TARGET_COUNT; t++)
 	{
@@ -7,3 +7,4 @@
 
 void RunSpeedTests();
 void SpeedTestText(const char* name, const char* text);
+void SpeedTestLexer(const char* name, const char* text);
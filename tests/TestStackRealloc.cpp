@@ -153,6 +153,122 @@ struct TestGCGlobalLimit : TestQueue
 };
 TestGCGlobalLimit testGCGlobalLimit;
 
+struct TestGCPolicyStats : TestQueue
+{
+	static void StatsCallback(void *context, const NULLCGCStats *stats)
+	{
+		unsigned *totals = (unsigned*)context;
+
+		totals[0]++;
+		totals[1] += stats->freedObjects;
+
+		if(stats->usedMemoryAfter > stats->usedMemoryBefore || stats->markedObjects == 0)
+			totals[2]++;
+	}
+
+	virtual void Run()
+	{
+		nullcTerminate();
+		nullcInit();
+		nullcAddImportPath(MODULE_PATH_A);
+		nullcAddImportPath(MODULE_PATH_B);
+		nullcSetFileReadHandler(Tests::fileLoadFunc, Tests::fileFreeFunc);
+		nullcSetEnableLogFiles(Tests::enableLogFiles, Tests::openStreamFunc, Tests::writeStreamFunc, Tests::closeStreamFunc);
+		nullcSetEnableTimeTrace(Tests::enableTimeTrace);
+		nullcInitGCModule();
+
+		const char	*testGCPolicyStats =
+		"int[] keep = new int[16];\r\n\
+		for(int i = 0; i < 4000; i++) new int[64];\r\n\
+		return keep.size;";
+		for(int t = 0; t < TEST_TARGET_COUNT; t++)
+		{
+			if(!Tests::testExecutor[t])
+				continue;
+
+			NULLCGCPolicy policy;
+			nullcGetGCPolicy(&policy);
+
+			policy.initialThreshold = 64 * 1024;
+			policy.growthFactor = 1.0;
+
+			unsigned totals[3] = { 0, 0, 0 };
+
+			testsCount[t]++;
+			if(nullcSetGCPolicy(&policy))
+			{
+				nullcSetGCStatsCallback(totals, StatsCallback);
+
+				if(Tests::RunCode(testGCPolicyStats, testTarget[t], "16", "GC collection policy and statistics callback [skip_c]") && totals[0] > 4 && totals[1] >= 2000 && totals[2] == 0)
+					testsPassed[t]++;
+
+				nullcSetGCStatsCallback(NULL, NULL);
+			}
+		}
+
+		NULLCGCPolicy policy = { 1024 * 1024, 2.0, 2.0 / 3.0, 0.0 };
+		nullcSetGCPolicy(&policy);
+	}
+};
+TestGCPolicyStats testGCPolicyStats;
+
+struct TestPageAllocation : TestQueue
+{
+	virtual void Run()
+	{
+		const char	*testPageAllocation =
+		"import std.gc;\r\n\
+		int[] big = new int[1024 * 1024];\r\n\
+		for(int i = 0; i < 1024 * 1024; i += 4096) big[i] += i / 4096;\r\n\
+		int[][] small = new int[][2000];\r\n\
+		for(int i = 0; i < 2000; i++){ small[i] = new int[8]; small[i][7] = i; }\r\n\
+		for(int i = 0; i < 8; i++) new int[128 * 1024];\r\n\
+		GC.CollectMemory();\r\n\
+		return big[4096 * 255] + small[1999][7] + small[1000][0];";
+
+		int modes[] = { NULLC_HUGE_PAGES_NONE, NULLC_HUGE_PAGES_TRANSPARENT, NULLC_HUGE_PAGES_EXPLICIT };
+
+		for(unsigned mode = 0; mode < sizeof(modes) / sizeof(modes[0]); mode++)
+		{
+			nullcTerminate();
+
+			bool supported = nullcSetPageAllocation(1, modes[mode]) != 0;
+
+			nullcInit();
+			nullcAddImportPath(MODULE_PATH_A);
+			nullcAddImportPath(MODULE_PATH_B);
+			nullcSetFileReadHandler(Tests::fileLoadFunc, Tests::fileFreeFunc);
+			nullcSetEnableLogFiles(Tests::enableLogFiles, Tests::openStreamFunc, Tests::writeStreamFunc, Tests::closeStreamFunc);
+			nullcSetEnableTimeTrace(Tests::enableTimeTrace);
+			nullcInitGCModule();
+
+			if(!supported)
+				continue;
+
+			for(int t = 0; t < TEST_TARGET_COUNT; t++)
+			{
+				if(!Tests::testExecutor[t])
+					continue;
+
+				testsCount[t]++;
+				if(Tests::RunCode(testPageAllocation, testTarget[t], "2254", "Heap and stacks reserved from the system [skip_c]"))
+					testsPassed[t]++;
+			}
+		}
+
+		nullcTerminate();
+		nullcSetPageAllocation(0, NULLC_HUGE_PAGES_NONE);
+		nullcInit();
+		nullcAddImportPath(MODULE_PATH_A);
+		nullcAddImportPath(MODULE_PATH_B);
+		nullcSetFileReadHandler(Tests::fileLoadFunc, Tests::fileFreeFunc);
+		nullcSetEnableLogFiles(Tests::enableLogFiles, Tests::openStreamFunc, Tests::writeStreamFunc, Tests::closeStreamFunc);
+		nullcSetEnableTimeTrace(Tests::enableTimeTrace);
+		nullcInitGCModule();
+	}
+};
+TestPageAllocation testPageAllocation;
+
 struct TestRestore : TestQueue
 {
 	virtual void Run()
@@ -513,6 +513,8 @@ namespace nullc_debugger_component
 
             rviConvertPtr,
 
+            rviNewObject,
+
             // Temporary instructions, no execution
             rviFuncAddr,
             rviTypeid,
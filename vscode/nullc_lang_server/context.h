@@ -18,6 +18,10 @@ struct Context
 		workspaceConfiguration = false;
 		textDocumentDefinitionLinkSupport = false;
 		textDocumentHierarchicalDocumentSymbolSupport = false;
+
+		analysisValid = false;
+		analysisVersion = 0;
+		analysisResult = false;
 	}
 
 	bool infoMode;
@@ -36,4 +40,10 @@ struct Context
 	std::string modulePath;
 
 	std::map<std::string, Document> documents;
+
+	// Last nullc analysis is kept alive while requests target the same document version
+	bool analysisValid;
+	std::string analysisUri;
+	unsigned analysisVersion;
+	bool analysisResult;
 };
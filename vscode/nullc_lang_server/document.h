@@ -7,4 +7,7 @@ struct Document
 	std::string uri;
 	std::string code;
 	bool temporary = false;
+
+	// Incremented on every content change
+	unsigned version = 0;
 };
@@ -894,6 +894,40 @@ bool RespondWithError(Context& ctx, rapidjson::Document &doc, const char *method
 	return true;
 }
 
+bool AnalyzeDocument(Context& ctx, Document *document)
+{
+	if(ctx.analysisValid && ctx.analysisUri == document->uri && ctx.analysisVersion == document->version)
+	{
+		if(ctx.debugMode)
+			fprintf(stderr, "DEBUG: Reusing analysis of document '%s' version %u\n", document->uri.c_str(), document->version);
+
+		return ctx.analysisResult;
+	}
+
+	ctx.analysisResult = nullcAnalyze(document->code.c_str()) != 0;
+
+	// Directly loaded documents are removed after the request
+	ctx.analysisValid = !document->temporary;
+	ctx.analysisUri = document->uri;
+	ctx.analysisVersion = document->version;
+
+	return ctx.analysisResult;
+}
+
+void ReleaseAnalysis(Context& ctx)
+{
+	if(!ctx.analysisValid)
+		nullcClean();
+}
+
+void InvalidateAnalysis(Context& ctx)
+{
+	if(ctx.analysisValid)
+		nullcClean();
+
+	ctx.analysisValid = false;
+}
+
 void RequestConfiguration(Context& ctx)
 {
 	rapidjson::Document response;
@@ -930,7 +964,7 @@ void RequestConfiguration(Context& ctx)
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 }
 
 Document* FindDocument(Context& ctx, rapidjson::Document &response, std::string documentPath)
@@ -1064,6 +1098,8 @@ bool HandleConfigurationResponse(Context& ctx, rapidjson::Value& response)
 
 			if(!modulePath.empty())
 			{
+				InvalidateAnalysis(ctx);
+
 				if(ctx.nullcInitialized)
 					nullcTerminate();
 
@@ -1290,7 +1326,7 @@ bool HandleFoldingRange(Context& ctx, rapidjson::Value& arguments, rapidjson::Do
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	if(CompilerContext *context = nullcGetCompilerContext())
 	{
@@ -1375,7 +1411,7 @@ bool HandleFoldingRange(Context& ctx, rapidjson::Value& arguments, rapidjson::Do
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -1391,7 +1427,7 @@ bool HandleHover(Context& ctx, rapidjson::Value& arguments, rapidjson::Document
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	Hover hover;
 
@@ -1459,7 +1495,7 @@ bool HandleHover(Context& ctx, rapidjson::Value& arguments, rapidjson::Document
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -1473,7 +1509,7 @@ bool HandleDocumentSymbol(Context& ctx, rapidjson::Value& arguments, rapidjson::
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	std::vector<DocumentSymbol> symbols;
 
@@ -1707,7 +1743,7 @@ bool HandleDocumentSymbol(Context& ctx, rapidjson::Value& arguments, rapidjson::
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -1744,7 +1780,7 @@ bool HandleCompletion(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	CompletionList completions;
 
@@ -2127,7 +2163,7 @@ bool HandleCompletion(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -2143,7 +2179,7 @@ bool HandleDefinition(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	std::vector<LocationLink> locations;
 
@@ -2304,7 +2340,7 @@ bool HandleDefinition(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -2322,7 +2358,7 @@ bool HandleReferences(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	std::vector<Location> locations;
 
@@ -2405,7 +2441,7 @@ bool HandleReferences(Context& ctx, rapidjson::Value& arguments, rapidjson::Docu
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -2421,7 +2457,7 @@ bool HandleDocumentHighlight(Context& ctx, rapidjson::Value& arguments, rapidjso
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	std::vector<DocumentHighlight> highlights;
 
@@ -2480,7 +2516,7 @@ bool HandleDocumentHighlight(Context& ctx, rapidjson::Value& arguments, rapidjso
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -2517,7 +2553,7 @@ bool HandleSignatureHelp(Context& ctx, rapidjson::Value& arguments, rapidjson::D
 
 	ScopedDocumentImport scopedDocumentImport(ctx, document);
 
-	nullcAnalyze(document->code.c_str());
+	AnalyzeDocument(ctx, document);
 
 	SignatureHelp signatureHelp;
 
@@ -2677,7 +2713,7 @@ bool HandleSignatureHelp(Context& ctx, rapidjson::Value& arguments, rapidjson::D
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 
 	return true;
 }
@@ -2701,7 +2737,7 @@ void UpdateDiagnostics(Context& ctx, Document &document)
 
 	ScopedDocumentImport scopedDocumentImport(ctx, &document);
 
-	if(!nullcAnalyze(document.code.c_str()))
+	if(!AnalyzeDocument(ctx, &document))
 	{
 		if(CompilerContext *context = nullcGetCompilerContext())
 		{
@@ -2793,7 +2829,7 @@ void UpdateDiagnostics(Context& ctx, Document &document)
 
 	SendResponse(ctx, response);
 
-	nullcClean();
+	ReleaseAnalysis(ctx);
 }
 
 bool HandleDidOpen(Context& ctx, rapidjson::Value& arguments)
@@ -2815,6 +2851,8 @@ bool HandleDidOpen(Context& ctx, rapidjson::Value& arguments)
 				ctx.modulePath += "Modules/";
 			}
 
+			InvalidateAnalysis(ctx);
+
 			if(ctx.nullcInitialized)
 				nullcTerminate();
 
@@ -2850,6 +2888,10 @@ bool HandleDidOpen(Context& ctx, rapidjson::Value& arguments)
 
 	document.uri = uri;
 	document.code = arguments["textDocument"]["text"].GetString();
+	document.version++;
+
+	// Other documents might import this one
+	InvalidateAnalysis(ctx);
 
 	UpdateDiagnostics(ctx, document);
 
@@ -2941,6 +2983,11 @@ bool HandleDidChange(Context& ctx, rapidjson::Value& arguments)
 		}
 	}
 
+	document.version++;
+
+	// Other documents might import this one
+	InvalidateAnalysis(ctx);
+
 	UpdateDiagnostics(ctx, document);
 
 	return true;